@@ -10,7 +10,7 @@
 #include "timers_utils.h"
 #include "error.h"
 
-class BusyWaitTimer : public Timer{
+class BusyWaitTimer final : public Timer{
 
 private:
 
@@ -0,0 +1,48 @@
+#ifndef SRC_UTILS_CRC32C_H
+#define SRC_UTILS_CRC32C_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Namespace : crc32c
+ * -------------------------------
+ * CRC32C (Castagnoli) checksum, computed with the SSE4.2/ARMv8 crc32
+ * instructions if the running CPU supports them, else with a slicing-by-8
+ * table. both give identical results.
+ */
+namespace crc32c{
+
+	/**
+	 * Function : extend
+	 * -------------------------------
+	 * continue the checksum crc (result of previous compute/extend, or 0 for
+	 * an empty input) over size bytes of data.
+	 * @return the new checksum.
+	 */
+	uint32_t extend(uint32_t crc, const void* data, size_t size);
+
+	/**
+	 * Function : compute
+	 * -------------------------------
+	 * @return the checksum of size bytes of data.
+	 */
+	uint32_t compute(const void* data, size_t size);
+
+	/**
+	 * Function : extend_portable
+	 * -------------------------------
+	 * same as extend(3) but always uses the table implementation.
+	 */
+	uint32_t extend_portable(uint32_t crc, const void* data, size_t size);
+
+	/**
+	 * Function : is_hardware_accelerated
+	 * -------------------------------
+	 * @return true if extend(3) uses the CPU crc32 instructions.
+	 */
+	bool is_hardware_accelerated();
+
+}
+
+#endif
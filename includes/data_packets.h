@@ -9,6 +9,12 @@
 #include <list>
 #include <atomic>
 
+#include "thread_placement.h"
+#include "thread_usage.h"
+#include "perf_counters.h"
+
+class LinkScheduler;
+
 /**
  * Struct : DataPacket
  * -------------------------------
@@ -28,6 +34,12 @@ struct DataPacket{
 
 	//offset of the data
 	uint_fast32_t data_offset = 0;
+
+	//called once by the sender when it is done with the data (the data was
+	//sent, or copied/pinned and completed for zero copy), or when the data
+	//is dropped, NULL if the data is owned by the user.
+	void (*release_fn)(void*) = NULL;
+	void* release_ctx = NULL;
 };
 
 /**
@@ -55,6 +67,10 @@ struct DataPacketsList{
 			printf("Memory error while allocating DataPacket.");
 			exit(1);
 		}
+		//default packets, no release function
+		for(uint_fast32_t i=0; i<num_packets; i++) {
+			packets[i] = DataPacket();
+		}
 	}
 	//destructor
 	~DataPacketsList() {
@@ -96,6 +112,25 @@ struct DataPacketsList{
 		memcpy(packets, obj.packets, obj.num_packets * sizeof(DataPacket));
 		return *this;
 	}
+	//call the release functions of the packets, each one is called once
+	void release_packets() {
+		for(uint_fast32_t i=0; i<num_packets; i++) {
+			if(NULL != packets[i].release_fn) {
+				void (*release_fn)(void*) = packets[i].release_fn;
+				packets[i].release_fn = NULL;
+				release_fn(packets[i].release_ctx);
+			}
+		}
+	}
+	//exchange the packets with another list without allocating
+	void swap(DataPacketsList &obj) {
+		DataPacket* other_packets = obj.packets;
+		uint_fast32_t other_num_packets = obj.num_packets;
+		obj.packets = packets;
+		obj.num_packets = num_packets;
+		packets = other_packets;
+		num_packets = other_num_packets;
+	}
 
 };
 
@@ -119,27 +154,76 @@ struct SenderWorkerData{
 	std::atomic<bool> is_error = {false};
 
 	//the sock_fd for the client which the sender will try to send data to.
+	//the worker closes it holding sock_mutex, so the main thread can query
+	//the socket holding it without the fd being closed or reused meanwhile
 	std::atomic<int> sock_fd = {-1};
+	pthread_mutex_t sock_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 	//send a termination signal to the thread
 	//only main thread set this variable
 	std::atomic<bool> terminate_thread = {false};
 	
-	//this flag set by the thread after it's initilization
-	//we can't get or send any data to the thread untill this flag
-	//becomes true
-	std::atomic<bool> thread_initialized = {false};
-
 	//the thread will response in this variable declaring it's termination
-	//only worker thread will set this variable
-	//can be cleared by the main thread when read
+	//the main thread clears it before creating the worker thread
 	std::atomic<bool> is_terminated_thread = {true};
 
+	//eventfd written by the main thread to wake the worker from its blocking
+	//waits (a client, the zero copy completions) when it must terminate
+	int wake_fd = -1;
+
 	//to specify what error happen in the worker thread
 	//only worker thread will set this variable
 	//can be cleared by the main thread when read
 	std::atomic<uint_fast8_t> error_code = {0};
 
+	//send a FrameHeader with the crc32c before each list
+	//only main thread set this variable before creating the worker thread
+	bool frame_crc = false;
+
+	//size of the socket send buffer and TCP_NOTSENT_LOWAT (0 to keep the default)
+	//only main thread set these variables before creating the worker thread
+	int send_buffer_size = 0;
+	int notsent_lowat = 0;
+
+	//stream profile used to size the send buffer of each client, 0 to use
+	//send_buffer_size
+	//only main thread set these variables before creating the worker thread
+	uint_fast32_t auto_frame_bytes = 0;
+	uint_fast16_t auto_frequency = 0;
+
+	//cores, priority and NUMA node of the worker thread
+	//only main thread set this variable before creating the worker thread
+	ThreadPlacement placement;
+
+	//cpu time, context switches and page faults of the frames
+	//sampled by the worker thread, enabled by the main thread before
+	//creating the worker thread
+	ThreadUsage usage;
+
+	//hardware and software counters of the frames, opened by the worker
+	//thread if perf_counters is true
+	//only main thread set perf_counters before creating the worker thread
+	bool perf_counters = false;
+	PerfCounters perf;
+
+	//the listening socket kept open for the worker to accept the clients, -1
+	//if the client is accepted by the main thread and never replaced
+	//only main thread set this variable while the worker thread not running
+	int server_sock_fd = -1;
+
+	//replace the lost client by a new one instead of ending the worker
+	//only main thread set this variable while the worker thread not running
+	bool reconnect = false;
+
+	//the worker has no client and waits for one
+	//only worker thread will set this variable
+	std::atomic<bool> is_reconnecting = {false};
+
+	//the link shared with other senders and the flow id of this sender in it
+	//only main thread set these variables while the worker thread not running
+	LinkScheduler* link = NULL;
+	int link_flow = -1;
+
 	//mutex to synchronize the access to the list.
 	//condition variable to signal the worker thread when new packets
 	//need to be delivered.
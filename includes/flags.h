@@ -5,6 +5,30 @@
 #define CPU_CORE_AFFINITY	(0)
 #define TCP_SENDER_SEND_BUFFER	(1024*1024*2)
 #define TCP_SENDER_RECV_BUFFER	(512*1024)
+//limits of the automatically sized send buffer
+#define TCP_SENDER_MIN_SEND_BUFFER	(64*1024)
+#define TCP_SENDER_MAX_SEND_BUFFER	(1024*1024*8)
+//longest wait of the TCP worker between two failed accepts of a client
+#define TCP_SENDER_ACCEPT_BACKOFF_MS	(100)
+//size of the pipe of TCPSenderSplice and the time it waits at the end for
+//the peer to acknowledge the pages still used by the socket
+#define TCP_SENDER_SPLICE_PIPE_SIZE	(1024*1024)
+#define TCP_SENDER_SPLICE_LINGER_MS	(1000)
+//frames kept in the ring of ShmSender, its consumers and the packets of a frame
+#define SHM_SENDER_SLOTS	(4)
+#define SHM_RING_MAX_CONSUMERS	(16)
+#define SHM_RING_MAX_PACKETS	(64)
+//consumers of UnixSender and the packets of a frame it passes
+#define UNIX_SENDER_MAX_CONSUMERS	(16)
+#define UNIX_FRAME_MAX_PACKETS	(64)
+//max bytes a sender writes before the shared link goes to another stream
+#define LINK_SCHEDULER_CHUNK_SIZE	(64*1024)
+//bits of the LinkScheduler flow ids holding the slot, up to 2^16 flows
+#define LINK_SCHEDULER_SLOT_BITS	(16)
+//size of the huge pages used for the frame buffers
+#define HUGE_PAGE_SIZE	(1024*1024*2)
+//events kept by each thread for the trace
+#define TRACE_EVENTS_PER_THREAD	(1024*64)
 
 
 #endif
\ No newline at end of file
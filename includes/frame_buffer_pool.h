@@ -0,0 +1,163 @@
+#ifndef SRC_UTILS_FRAME_BUFFER_POOL_H
+#define SRC_UTILS_FRAME_BUFFER_POOL_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "data_packets.h"
+#include "error.h"
+#include "huge_page_memory.h"
+#include "mutex_raii.h"
+
+class FrameBufferPool;
+
+/**
+ * Struct : FrameBuffer
+ * -------------------------------
+ * This struct will hold a single buffer of a FrameBufferPool, the buffer
+ * goes back to its pool when its last reference is released.
+ * the user gets the buffer with one reference from acquire(1), fills it and
+ * turns the reference into a packet using make_packet(2), the sender releases
+ * the packet when it is done with the data.
+ */
+struct FrameBuffer{
+
+	//the memory of the buffer
+	void* data;
+
+	//size of the memory in bytes
+	uint_fast32_t capacity;
+
+	//number of the holders of the buffer
+	std::atomic<uint_fast32_t> refs;
+
+	//the pool owning the buffer
+	FrameBufferPool* pool;
+
+	/**
+	 * Method : retain
+	 * -------------------------------
+	 * add a reference, to send the same buffer in another packet.
+	 */
+	void retain();
+
+	/**
+	 * Method : release
+	 * -------------------------------
+	 * drop a reference, the buffer goes back to the pool with the last one.
+	 */
+	void release();
+
+	/**
+	 * Method : make_packet
+	 * -------------------------------
+	 * move one reference of the caller into a memory packet of the buffer,
+	 * the reference is released when the packet is sent or dropped.
+	 * @param size is the number of bytes to send.
+	 * @param offset is the first byte to send.
+	 * @return the packet.
+	 */
+	DataPacket make_packet(uint_fast32_t size, uint_fast32_t offset = 0);
+};
+
+/**
+ * Class : FrameBufferPool
+ * -------------------------------
+ * This class will own a fixed number of equal frame buffers allocated once
+ * in a single page aligned block, so the memory of the frames is bounded.
+ * the block can be on locked huge pages, so the frames never fault and the
+ * zero copy sender pins one page for each 2MB instead of 512 pages.
+ * the released buffers are reused last in first out, so the next frame is
+ * written to the buffer most likely still in the cache.
+ */
+class FrameBufferPool{
+
+private:
+
+	Error error_handler_;
+
+	//the memory block of all the buffers
+	void* memory_;
+
+	//the block when the buffers are on huge pages
+	HugePageBlock huge_block_;
+
+	//all the buffers of the pool
+	std::vector<FrameBuffer> buffers_;
+
+	//the free buffers, the back is the last released
+	std::vector<FrameBuffer*> free_;
+
+	//mutex protecting the free buffers, condition to wake the waiting acquire
+	pthread_mutex_t pool_mutex_;
+	pthread_cond_t pool_cond_;
+
+	//release function of the packets made by the buffers
+	static void release_packet(void* buffer);
+
+	//put a buffer without references back to the free buffers
+	void give_back(FrameBuffer* buffer);
+
+	//free the memory block
+	void free_memory();
+
+	friend struct FrameBuffer;
+
+public:
+
+	FrameBufferPool();
+
+	/**
+	 * Method : initialize
+	 * -------------------------------
+	 * allocate the buffers, all the buffers must be back in the pool.
+	 * @param buffer_size is the size of each buffer in bytes.
+	 * @param num_buffers is the number of buffers.
+	 * @param huge_pages is true to allocate the buffers on huge pages which
+	 * are faulted in and locked now.
+	 * @return true if allocated, false otherwise.
+	 * when false is returned the error_handler_ will be set accordingly.
+	 */
+	bool initialize(uint_fast32_t buffer_size, uint_fast32_t num_buffers, bool huge_pages = false);
+
+	/**
+	 * Method : acquire
+	 * -------------------------------
+	 * take a free buffer with one reference.
+	 * @param block is true to wait until a buffer is released.
+	 * @return the buffer, NULL if no buffer is free and block is false.
+	 */
+	FrameBuffer* acquire(bool block = false);
+
+	/**
+	 * Method : available
+	 * -------------------------------
+	 * @return the number of the free buffers.
+	 */
+	uint_fast32_t available();
+
+	/**
+	 * Method : get_error
+	 * -------------------------------
+	 * @return the error string if an error occurs, empty string will
+	 * be returned if no error existed.
+	 */
+	std::string get_error();
+
+	/**
+	 * Method : is_error
+	 * -------------------------------
+	 * Check if an error existed.
+	 * @return true if an error occurs, false otherwise.
+	 */
+	bool is_error();
+
+	~FrameBufferPool();
+
+};
+
+#endif
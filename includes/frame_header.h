@@ -0,0 +1,66 @@
+#ifndef SRC_UTILS_FRAME_HEADER_H
+#define SRC_UTILS_FRAME_HEADER_H
+
+#include <stdint.h>
+
+#include "data_packets.h"
+#include "crc32c.h"
+
+//"RTDT" when read as little endian bytes
+#define FRAME_HEADER_MAGIC	(0x54445452u)
+//the crc field is valid
+#define FRAME_HEADER_FLAG_CRC	(1u << 0)
+
+/**
+ * Struct : FrameHeader
+ * -------------------------------
+ * This struct is sent by the senders before each frame when the frame
+ * integrity is enabled, all the fields are in the sender byte order.
+ * the frame is all the packets of one DataPacketsList back to back.
+ */
+struct FrameHeader{
+
+	//always FRAME_HEADER_MAGIC
+	uint32_t magic;
+
+	//FRAME_HEADER_FLAG_*
+	uint32_t flags;
+
+	//number of the frame since the sender initialized
+	uint32_t sequence_number;
+
+	//number of bytes following the header
+	uint32_t frame_size;
+
+	//crc32c of the frame bytes, valid only if FRAME_HEADER_FLAG_CRC is set
+	uint32_t crc;
+};
+
+static_assert(sizeof(FrameHeader) == 20, "FrameHeader must not be padded");
+
+namespace frame_header{
+
+	/**
+	 * Function : build
+	 * -------------------------------
+	 * fill the header for the given list, the crc is computed over the memory
+	 * packets while they will be sent right after, so the data is left hot in
+	 * the cache for the send. frames with file descriptor packets are sent
+	 * without crc.
+	 */
+	void build(const DataPacketsList& list, uint32_t sequence_number, FrameHeader* header);
+
+	/**
+	 * Function : verify
+	 * -------------------------------
+	 * used by the receivers to check a received frame.
+	 * @param header is the header received before the frame.
+	 * @param frame_data is the header->frame_size bytes received after it.
+	 * @return false if the header is not valid or the crc mismatch, true
+	 * otherwise (including frames sent without crc).
+	 */
+	bool verify(const FrameHeader* header, const void* frame_data);
+
+}
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef SRC_SYSTEM_FRAME_QUEUE_H
+#define SRC_SYSTEM_FRAME_QUEUE_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include <vector>
+
+#include "data_packets.h"
+#include "mutex_raii.h"
+
+/**
+ * Class : FrameQueue
+ * -------------------------------
+ * This class will hold the frames prepared ahead of their ticks, a producer
+ * thread fills them and the real time thread takes one each tick.
+ * the queue is bounded, the producer blocks while it is full, the real time
+ * thread never waits for a frame and gets it without any allocation, the
+ * lock is priority inheriting so the producer holding it isn't preempted
+ * by the threads below the real time one.
+ */
+class FrameQueue{
+
+private:
+
+	//the slots of the ring, a slot keeps its packets array when emptied
+	std::vector<DataPacketsList> frames_;
+	//the user asked to stop the system while producing the frame of the slot
+	std::vector<bool> stops_;
+
+	//index of the oldest frame and number of the ready frames
+	uint_fast16_t head_;
+	uint_fast16_t count_;
+
+	//the producer is in between begin_push(0) and end_push(1)
+	bool pushing_;
+
+	//no more frames are accepted
+	bool closed_;
+
+	//mutex protecting the ring, condition to wake the producer when a slot
+	//is freed and the waiters for a full queue when a frame is pushed
+	pthread_mutex_t queue_mutex_;
+	pthread_cond_t queue_cond_;
+
+public:
+
+	FrameQueue();
+
+	/**
+	 * Method : initialize
+	 * -------------------------------
+	 * empty the queue and open it for depth frames.
+	 * @return true if depth is not zero, false otherwise.
+	 */
+	bool initialize(uint_fast16_t depth);
+
+	/**
+	 * Method : begin_push
+	 * -------------------------------
+	 * block until there is a free slot (producer side).
+	 * @return the slot to fill, or NULL if the queue got closed.
+	 */
+	DataPacketsList* begin_push();
+
+	/**
+	 * Method : end_push
+	 * -------------------------------
+	 * make the slot returned by begin_push(0) ready.
+	 * @param stop is true if the user stopped the system with this frame.
+	 */
+	void end_push(bool stop);
+
+	/**
+	 * Method : pop
+	 * -------------------------------
+	 * take the oldest frame without blocking (real time side), the packets of
+	 * the frame are swapped into list and the old packets of list are reused
+	 * by the producer.
+	 * @param stop is set to true if the user stopped the system with this frame.
+	 * @return true if a frame was ready, false otherwise.
+	 */
+	bool pop(DataPacketsList* list, bool* stop);
+
+	/**
+	 * Method : wait_full
+	 * -------------------------------
+	 * block until all the slots are ready, the last frame stopped the
+	 * system or the queue got closed.
+	 */
+	void wait_full();
+
+	/**
+	 * Method : close
+	 * -------------------------------
+	 * stop accepting frames and wake the blocked producer.
+	 */
+	void close();
+
+	~FrameQueue();
+
+};
+
+#endif
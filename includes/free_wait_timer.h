@@ -8,7 +8,7 @@
 #include "timers_utils.h"
 #include "error.h"
 
-class FreeWaitTimer : public Timer{
+class FreeWaitTimer final : public Timer{
 
 private:
 
@@ -0,0 +1,52 @@
+#ifndef SRC_UTILS_HUGE_PAGE_MEMORY_H
+#define SRC_UTILS_HUGE_PAGE_MEMORY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "flags.h"
+
+/**
+ * Struct : HugePageBlock
+ * -------------------------------
+ * This struct will hold a memory block allocated by huge_page_memory.
+ */
+struct HugePageBlock{
+
+	//the kind of the pages backing the block
+	enum PAGE_KIND {HUGETLB_PAGES, TRANSPARENT_HUGE_PAGES, NORMAL_PAGES};
+
+	//start of the block, NULL if not allocated
+	void* memory = NULL;
+
+	//size of the block, a multiple of HUGE_PAGE_SIZE
+	size_t size = 0;
+
+	PAGE_KIND kind = NORMAL_PAGES;
+};
+
+namespace huge_page_memory{
+
+	/**
+	 * Function : allocate
+	 * -------------------------------
+	 * allocate a block backed by huge pages, the reserved huge pages are used
+	 * if available, transparent huge pages otherwise, the whole block is
+	 * faulted in and locked in memory before returning, so the real time path
+	 * never takes a page fault on it and the zero copy sends pin few pages.
+	 * @param size is the needed size, rounded up to HUGE_PAGE_SIZE.
+	 * @param block is set to the allocated block.
+	 * @return true if allocated and locked, false otherwise.
+	 */
+	bool allocate(size_t size, HugePageBlock* block);
+
+	/**
+	 * Function : deallocate
+	 * -------------------------------
+	 * unlock and free the block, nothing is done if it is not allocated.
+	 */
+	void deallocate(HugePageBlock* block);
+
+}
+
+#endif
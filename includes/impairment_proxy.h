@@ -0,0 +1,173 @@
+#ifndef SRC_UTILS_IMPAIRMENT_PROXY_H
+#define SRC_UTILS_IMPAIRMENT_PROXY_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include <atomic>
+#include <string>
+
+#include "error.h"
+#include "mutex_raii.h"
+
+/**
+ * Struct : ImpairmentSettings
+ * -------------------------------
+ * The degradation applied by an ImpairmentProxy to the forwarded stream,
+ * all zero forwards the stream as fast as possible.
+ */
+struct ImpairmentSettings{
+
+	//bytes per second forwarded to the client, 0 for no limit
+	uint_fast64_t bandwidth_bytes;
+
+	//delay added to every byte
+	uint_fast32_t delay_us;
+
+	//random extra delay up to jitter_us, the stream stays in order so a
+	//late byte delays the next ones too
+	uint_fast32_t jitter_us;
+
+	//nothing is read or forwarded during the last stall_ms of each
+	//stall_period_ms, 0 for no stalls, stall_ms >= stall_period_ms stalls
+	//the link until the settings change
+	uint_fast32_t stall_period_ms;
+	uint_fast32_t stall_ms;
+};
+
+/**
+ * Class : ImpairmentProxy
+ * -------------------------------
+ * This class will forward the stream of a sender to a client on the loopback
+ * through a bottleneck with a bandwidth cap, delay, jitter and stalls, so the
+ * skip mode, the tolerance and the disconnect detection can be tested without
+ * a real network or tc(8).
+ * the client connects to the listen port and the proxy connects to the
+ * sender at the target port, then it reads the sender only while less than
+ * the queue limit is held, so the sender sees the back pressure of the slow
+ * link. the settings can be changed while the stream runs.
+ * one client at a time is served, when a client leaves the connection to the
+ * sender is closed and the next client gets a new one.
+ */
+class ImpairmentProxy{
+
+private:
+
+	Error error_handler_;
+
+	//ports of the proxy and of the sender
+	uint_fast16_t listen_port_;
+	uint_fast16_t target_port_;
+
+	//listening socket, eventfd waking the proxy thread to end it
+	int server_sock_fd_;
+	int wake_fd_;
+
+	pthread_t proxy_thread_;
+	bool running_;
+
+	//current settings, protected by the mutex
+	ImpairmentSettings settings_;
+	pthread_mutex_t settings_mutex_;
+
+	//max bytes read from the sender and not forwarded yet
+	uint_fast32_t queue_limit_;
+
+	//statistics
+	std::atomic<uint_fast64_t> forwarded_bytes_;
+	std::atomic<uint_fast32_t> connections_;
+
+	static void* proxy_function(void* proxy);
+
+	//connect to the sender, it may not listen yet
+	int connect_target();
+
+	//forward the stream until one side closes or the proxy ends
+	void forward(int client_fd, int target_fd);
+
+	//close the sockets and the eventfd
+	void close_sockets();
+
+public:
+
+	/**
+	 * Method : Constructor
+	 * -------------------------------
+	 * @param listen_port is the port the client connects to.
+	 * @param target_port is the port of the sender on the loopback.
+	 */
+	ImpairmentProxy(uint_fast16_t listen_port, uint_fast16_t target_port);
+
+	/**
+	 * Method : set_impairment
+	 * -------------------------------
+	 * change the degradation, it applies to the data read from now on.
+	 */
+	void set_impairment(const ImpairmentSettings& settings);
+
+	/**
+	 * Method : get_impairment
+	 * -------------------------------
+	 * @return the current degradation.
+	 */
+	ImpairmentSettings get_impairment();
+
+	/**
+	 * Method : set_queue_limit
+	 * -------------------------------
+	 * set the bytes held by the proxy (the buffer of the bottleneck), must be
+	 * called before initialize(0), by default 1MB.
+	 */
+	void set_queue_limit(uint_fast32_t queue_limit);
+
+	/**
+	 * Method : initialize
+	 * -------------------------------
+	 * listen on the listen port and start forwarding in the background.
+	 * @return true if the proxy started, false otherwise.
+	 * when false is returned the error_handler_ will be set accordingly.
+	 */
+	bool initialize();
+
+	/**
+	 * Method : end_proxy
+	 * -------------------------------
+	 * stop forwarding and close all the connections.
+	 */
+	void end_proxy();
+
+	/**
+	 * Method : get_forwarded_bytes
+	 * -------------------------------
+	 * @return the bytes forwarded to the clients since initialize(0).
+	 */
+	uint_fast64_t get_forwarded_bytes();
+
+	/**
+	 * Method : get_connections
+	 * -------------------------------
+	 * @return the number of clients connected to the sender since initialize(0).
+	 */
+	uint_fast32_t get_connections();
+
+	/**
+	 * Method : get_error
+	 * -------------------------------
+	 * @return the error string if an error occurs, empty string will
+	 * be returned if no error existed.
+	 */
+	std::string get_error();
+
+	/**
+	 * Method : is_error
+	 * -------------------------------
+	 * Check if an error existed.
+	 * @return true if an error occurs, false otherwise.
+	 */
+	bool is_error();
+
+	~ImpairmentProxy();
+
+};
+
+#endif
@@ -0,0 +1,155 @@
+#ifndef SRC_SENDERS_LINK_SCHEDULER_H
+#define SRC_SENDERS_LINK_SCHEDULER_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include <deque>
+#include <vector>
+
+#include "flags.h"
+#include "mutex_raii.h"
+
+/**
+ * Class : LinkScheduler
+ * -------------------------------
+ * This class will arbitrate between the senders (flows) writing to the same
+ * link, so only one of them writes a chunk at a time and the chunks are
+ * interleaved by deficit round robin.
+ * each flow has a weight, in each round it can write up to weight chunks,
+ * and a per tick byte budget, the flows which wrote more than their budget in
+ * the current frame are served only when no flow within its budget has data,
+ * so a large frame can't starve a small latency critical stream.
+ * the senders call begin_frame(1) for each frame, acquire(2)/release(2) around
+ * each chunk and end_frame(1) when the frame is written.
+ */
+class LinkScheduler{
+
+private:
+
+	//the state of a single flow
+	struct Flow{
+		//bytes the flow should write in one tick, 0 for no limit
+		uint_fast32_t tick_budget;
+		//bytes added to the deficit in each round
+		uint_fast64_t quantum;
+		//bytes the flow can still write in this round
+		uint_fast64_t deficit;
+		//bytes written in the current frame
+		uint_fast64_t used;
+		//bytes asked for in the next acquire(2)
+		uint_fast32_t request;
+		//in the round robin ring, has a frame in progress
+		bool in_ring;
+		//got its quantum in the current visit
+		bool has_quantum;
+		//removed by remove_flow(1)
+		bool removed;
+		//times the slot was reused, part of the flow id
+		uint_fast16_t generation;
+		//acquire(2) calls waiting for the link, the slot isn't reused
+		//while a removed flow still has some
+		uint_fast32_t waiters;
+	};
+
+	//max bytes written in one chunk
+	uint_fast32_t chunk_size_;
+
+	//all the flows, the slots of the removed flows are reused, the flow id
+	//is the slot in the low LINK_SCHEDULER_SLOT_BITS and the generation of
+	//the slot above them, so the id of a removed flow stays invalid
+	std::vector<Flow> flows_;
+
+	//the ids of the flows with a frame in progress, the front is served next
+	std::deque<int> ring_;
+
+	//the id of the flow allowed to write now, -1 if none
+	int owner_;
+
+	//mutex protecting the state, condition to wake the waiting flows
+	pthread_mutex_t link_mutex_;
+	pthread_cond_t link_cond_;
+
+	//give the link to the next flow if it is free, called with the lock held
+	void advance();
+
+	//take the flow out of the ring, called with the lock held
+	void leave_ring(int flow_id);
+
+	//true if the flow is valid and not removed, called with the lock held
+	bool is_flow(int flow_id);
+
+	//the slot of the flow id, called with the lock held
+	Flow& get_flow(int flow_id);
+
+public:
+
+	/**
+	 * Method : constructor
+	 * -------------------------------
+	 * @param chunk_size is the max bytes a flow writes before the link can be
+	 * given to another flow.
+	 */
+	LinkScheduler(uint_fast32_t chunk_size = LINK_SCHEDULER_CHUNK_SIZE);
+
+	/**
+	 * Method : add_flow
+	 * -------------------------------
+	 * @param tick_budget is the bytes the flow should write each tick, 0 for no limit.
+	 * @param weight is the number of chunks the flow can write in each round (>= 1).
+	 * @return the flow id, or -1 if the weight is not valid or there are
+	 * too many flows.
+	 */
+	int add_flow(uint_fast32_t tick_budget, uint_fast16_t weight);
+
+	/**
+	 * Method : remove_flow
+	 * -------------------------------
+	 * remove the flow, a pending acquire(2) of it returns false, the id
+	 * isn't valid anymore and isn't given to another flow.
+	 */
+	void remove_flow(int flow_id);
+
+	/**
+	 * Method : get_chunk_size
+	 * -------------------------------
+	 * @return the max bytes to be written after a single acquire(2).
+	 */
+	uint_fast32_t get_chunk_size();
+
+	/**
+	 * Method : begin_frame
+	 * -------------------------------
+	 * start a new frame of the flow, its budget is renewed.
+	 */
+	void begin_frame(int flow_id);
+
+	/**
+	 * Method : acquire
+	 * -------------------------------
+	 * block until the flow can write bytes (<= get_chunk_size(0)) to the link.
+	 * @return true if the flow can write, false if the flow got removed.
+	 */
+	bool acquire(int flow_id, uint_fast32_t bytes);
+
+	/**
+	 * Method : release
+	 * -------------------------------
+	 * report the bytes written after acquire(2), the link is kept for the flow
+	 * while it still has deficit for another chunk.
+	 */
+	void release(int flow_id, uint_fast32_t written_bytes);
+
+	/**
+	 * Method : end_frame
+	 * -------------------------------
+	 * the flow has nothing more to write in this frame, it gives up the link.
+	 * can be called several times.
+	 */
+	void end_frame(int flow_id);
+
+	~LinkScheduler();
+
+};
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef SRC_SENDERS_MOCK_SENDER_H
+#define SRC_SENDERS_MOCK_SENDER_H
+
+#include <string>
+#include <stdint.h>
+
+#include <functional>
+
+#include "sender.h"
+#include "error.h"
+
+//completion time of a frame which is never sent
+#define MOCK_SENDER_NEVER (uint_fast64_t(-1))
+
+/**
+ * Class : MockSender
+ * -------------------------------
+ * This sender will send nothing, each frame is done after the time given by
+ * a completion function on the clock of timers_utils, so a system can be
+ * run on a SimulatedClock with programmed send times: late frames, a slow
+ * link, or a client which stops reading.
+ * the packets are released when the frame is done or the sender ends.
+ */
+class MockSender final : public Sender{
+
+public:
+
+	//gets the number of the frame (from 0) and its bytes, returns the time
+	//to send it in nanoseconds or MOCK_SENDER_NEVER
+	typedef std::function<uint_fast64_t(uint_fast32_t frame_number, uint_fast64_t frame_bytes)> CompletionFn;
+
+private:
+
+	Error error_handler_;
+
+	bool initialized_;
+
+	CompletionFn completion_fn_;
+
+	//the frame being sent, NULL if none
+	DataPacketsList* packets_list_;
+	uint_fast64_t frame_bytes_;
+	uint_fast64_t send_start_ns_;
+	uint_fast64_t send_time_ns_;
+
+	//the delivery rate of the last done frame
+	uint_fast64_t delivery_rate_;
+
+	bool is_reconnecting_;
+
+	//statistics
+	uint_fast32_t sent_frames_;
+	uint_fast32_t done_frames_;
+
+public:
+
+	/**
+	 * Method : Constructor
+	 * -------------------------------
+	 * by default every frame is done at once.
+	 */
+	MockSender();
+
+	/**
+	 * Method : set_completion_fn
+	 * -------------------------------
+	 * set the time each next frame takes to be sent.
+	 */
+	void set_completion_fn(CompletionFn completion_fn);
+
+	/**
+	 * Method : set_reconnecting
+	 * -------------------------------
+	 * report the client as lost and waited for (or back), the system doesn't
+	 * count the skipped frames meanwhile.
+	 */
+	void set_reconnecting(bool is_reconnecting);
+
+	/**
+	 * Method : get_sent_frames
+	 * -------------------------------
+	 * @return the frames given to send(1) since initialize(0).
+	 */
+	uint_fast32_t get_sent_frames();
+
+	/**
+	 * Method : get_done_frames
+	 * -------------------------------
+	 * @return the frames completed since initialize(0).
+	 */
+	uint_fast32_t get_done_frames();
+
+	bool initialize() override;
+
+	bool send(DataPacketsList* list) override;
+
+	bool is_send_done() override;
+
+	/**
+	 * Method : get_link_state
+	 * -------------------------------
+	 * the frame being sent is unsent in proportion of its remaining time, the
+	 * delivery rate is the one of the last done frame.
+	 */
+	bool get_link_state(SenderLinkState* state) override;
+
+	bool is_reconnecting() override;
+
+	bool end_sender() override;
+
+	std::string get_error() override;
+
+	bool is_error() override;
+
+	~MockSender();
+
+};
+
+#endif
@@ -0,0 +1,174 @@
+#ifndef SRC_UTILS_PERF_COUNTERS_H
+#define SRC_UTILS_PERF_COUNTERS_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include <atomic>
+#include <string>
+
+#include "error.h"
+
+//the counters, the hardware ones first
+enum PERF_COUNTER_ID {PERF_CYCLES, PERF_INSTRUCTIONS, PERF_CACHE_REFERENCES, PERF_CACHE_MISSES,
+					  PERF_BRANCH_MISSES, PERF_TASK_CLOCK, PERF_PAGE_FAULTS, PERF_CONTEXT_SWITCHES,
+					  PERF_COUNTERS};
+
+/**
+ * Struct : PerfCounterStats
+ * -------------------------------
+ * This struct will hold the counters summed over the counted intervals (the
+ * ticks of a system, the frames of a sender worker).
+ */
+struct PerfCounterStats{
+
+	//the counter was opened, its value is valid
+	bool opened[PERF_COUNTERS] = {};
+
+	//the counters include the time in the kernel (the send calls)
+	bool kernel_included = false;
+
+	//number of counted intervals and the bytes handed to or sent in them
+	uint_fast64_t intervals = 0;
+	uint_fast64_t bytes = 0;
+
+	//value of each counter, task clock in nanoseconds, scaled up if the
+	//kernel multiplexed the counters
+	uint_fast64_t values[PERF_COUNTERS] = {};
+};
+
+namespace perf_counters{
+
+	/**
+	 * Function : name
+	 * -------------------------------
+	 * @return the name of the counter ("instructions", "cache_misses"...).
+	 */
+	const char* name(PERF_COUNTER_ID id);
+}
+
+/**
+ * Class : PerfCounters
+ * -------------------------------
+ * This class will count the hardware and software perf events (cycles,
+ * instructions, cache misses...) of a thread between begin(0) and end(1),
+ * the counters are opened by open(0) on the counted thread before its real
+ * time loop, they are read with one read(2) per group of counters at
+ * begin(0) and end(1).
+ * a counter the kernel or the machine doesn't provide (a VM without a PMU,
+ * perf_event_paranoid) is not opened and the others are still counted, if
+ * none is opened begin(0) and end(1) do nothing.
+ * begin(0) and end(1) called by another thread than the one which opened the
+ * counters are ignored, the stats can be read by any thread.
+ */
+class PerfCounters{
+
+private:
+
+	Error error_handler_;
+
+	//the hardware and the software groups, the first counter opened in a
+	//group is its leader, -1 if the group is not opened
+	enum {HARDWARE_GROUP, SOFTWARE_GROUP, GROUPS};
+	int group_fd_[GROUPS];
+	int fds_[PERF_COUNTERS];
+
+	//the counters of each group in the order of the read values
+	PERF_COUNTER_ID group_counters_[GROUPS][PERF_COUNTERS];
+	uint_fast32_t group_size_[GROUPS];
+
+	//the thread which opened the counters
+	pthread_t owner_;
+	std::atomic<bool> is_open_;
+
+	bool kernel_included_;
+	bool opened_[PERF_COUNTERS];
+
+	//values read by begin(0), valid if started_
+	bool started_;
+	uint_fast64_t start_values_[PERF_COUNTERS];
+	uint_fast64_t start_enabled_[GROUPS];
+	uint_fast64_t start_running_[GROUPS];
+
+	std::atomic<uint_fast64_t> intervals_;
+	std::atomic<uint_fast64_t> bytes_;
+	std::atomic<uint_fast64_t> values_[PERF_COUNTERS];
+
+	//read the counters of the groups
+	bool read_groups(uint_fast64_t* values, uint_fast64_t* enabled, uint_fast64_t* running);
+
+public:
+
+	PerfCounters();
+
+	/**
+	 * Method : open
+	 * -------------------------------
+	 * open the counters of the calling thread, the counters opened before
+	 * are closed. the kernel time is counted if allowed.
+	 * @return true if at least one counter is opened, false otherwise.
+	 * when false is returned the error_handler_ will be set accordingly.
+	 */
+	bool open();
+
+	/**
+	 * Method : close
+	 * -------------------------------
+	 * close the counters, the stats are kept.
+	 */
+	void close();
+
+	/**
+	 * Method : is_open
+	 * -------------------------------
+	 * @return true if at least one counter is opened.
+	 */
+	bool is_open();
+
+	/**
+	 * Method : begin
+	 * -------------------------------
+	 * read the counters at the start of an interval.
+	 */
+	void begin();
+
+	/**
+	 * Method : end
+	 * -------------------------------
+	 * read the counters at the end of the interval and add it to the stats.
+	 * @param bytes is the data handled in the interval, to get the counts
+	 * per byte.
+	 */
+	void end(uint_fast64_t bytes);
+
+	/**
+	 * Method : discard
+	 * -------------------------------
+	 * drop the interval started by begin(0), it's not added to the stats.
+	 */
+	void discard();
+
+	/**
+	 * Method : get_stats
+	 * -------------------------------
+	 * copy the stats, the counters are read one by one while the thread may
+	 * still add an interval.
+	 */
+	void get_stats(PerfCounterStats* stats);
+
+	/**
+	 * Method : reset
+	 * -------------------------------
+	 * clear the stats.
+	 */
+	void reset();
+
+	std::string get_error();
+
+	bool is_error();
+
+	~PerfCounters();
+
+};
+
+#endif
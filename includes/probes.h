@@ -0,0 +1,41 @@
+#ifndef SRC_UTILS_PROBES_H
+#define SRC_UTILS_PROBES_H
+
+/**
+ * Macros : USDT probes
+ * -------------------------------
+ * static tracepoints of the provider "rtdt" on the real time and sender hot
+ * paths, a disabled probe is a single nop in the code and a note in the
+ * binary, a tracer (bpftrace, perf, SystemTap) enables them on a running
+ * process, for example:
+ *     bpftrace -e 'usdt:./app:rtdt:skip__decision { @[arg1] = count(); }'
+ * the probes need sys/sdt.h (systemtap-sdt-dev) at build time, without it
+ * or with NO_USDT_PROBES defined they compile to nothing and their
+ * arguments are not evaluated.
+ *
+ * Probes (arguments):
+ *     tick__start          (sequence number)
+ *     tick__overrun        (sequence number) the timer tick passed before the sleep
+ *     skip__decision       (sequence number, reason) 0 late send, 1 predicted late, 2 producer late
+ *     send__handoff        (sequence number, packets)
+ *     packet__send__start  (packet index, bytes)
+ *     packet__send__done   (packet index, bytes sent)
+ *     zerocopy__completion (completed sends, sends still waited for)
+ */
+
+#if !defined(NO_USDT_PROBES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define USDT_PROBES_ENABLED 1
+#endif
+#endif
+
+#ifdef USDT_PROBES_ENABLED
+#define RTDT_PROBE1(name, a1) DTRACE_PROBE1(rtdt, name, a1)
+#define RTDT_PROBE2(name, a1, a2) DTRACE_PROBE2(rtdt, name, a1, a2)
+#else
+#define RTDT_PROBE1(name, a1) do {} while(0)
+#define RTDT_PROBE2(name, a1, a2) do {} while(0)
+#endif
+
+#endif
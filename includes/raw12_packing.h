@@ -0,0 +1,142 @@
+#ifndef SRC_UTILS_RAW12_PACKING_H
+#define SRC_UTILS_RAW12_PACKING_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <string>
+
+#include "error.h"
+#include "data_packets.h"
+
+/**
+ * Namespace : raw12
+ * -------------------------------
+ * Kernels to convert raw sensor data between 16-bit containers (one pixel
+ * in the low 12 bits of each uint16_t) and packed 12-bit data, where every
+ * two pixels P0, P1 occupy 3 bytes:
+ * byte0 = P0[11:4], byte1 = P0[3:0] << 4 | P1[11:8], byte2 = P1[7:0].
+ * this is the raw12 layout used by the Axiom cameras and it saves 25% of
+ * the bytes on the wire.
+ * the best kernel for the running CPU is chosen at the first call, the
+ * output of every kernel is identical.
+ */
+namespace raw12{
+
+	enum RAW12_KERNEL {RAW12_KERNEL_SCALAR, RAW12_KERNEL_SSSE3, RAW12_KERNEL_AVX2, RAW12_KERNEL_NEON};
+
+	/**
+	 * Macro : RAW12_PACKED_SIZE
+	 * -------------------------------
+	 * number of bytes needed to hold N packed pixels, an odd last pixel
+	 * takes 2 bytes with the low nibble of the second byte zeroed.
+	 */
+	#define RAW12_PACKED_SIZE(N) ((uint_fast64_t(N) * 3 + 1) / 2)
+
+	/**
+	 * Function : pack
+	 * -------------------------------
+	 * pack num_pixels pixels from src into dst, dst must have at least
+	 * RAW12_PACKED_SIZE(num_pixels) bytes. the upper 4 bits of each source
+	 * pixel are ignored.
+	 */
+	void pack(const uint16_t* src, uint8_t* dst, uint_fast64_t num_pixels);
+
+	/**
+	 * Function : unpack
+	 * -------------------------------
+	 * unpack num_pixels pixels from src into dst, src must have at least
+	 * RAW12_PACKED_SIZE(num_pixels) bytes.
+	 */
+	void unpack(const uint8_t* src, uint16_t* dst, uint_fast64_t num_pixels);
+
+	/**
+	 * Function : is_kernel_supported
+	 * -------------------------------
+	 * @return true if the kernel is compiled in and the running CPU supports it.
+	 */
+	bool is_kernel_supported(RAW12_KERNEL kernel);
+
+	/**
+	 * Function : set_kernel
+	 * -------------------------------
+	 * force pack(3)/unpack(3) to use the given kernel, used by the tests to
+	 * compare the kernels against each other.
+	 * @return false if the kernel is not supported, the current kernel is kept.
+	 */
+	bool set_kernel(RAW12_KERNEL kernel);
+
+	/**
+	 * Function : get_kernel
+	 * -------------------------------
+	 * @return the kernel currently used by pack(3)/unpack(3).
+	 */
+	RAW12_KERNEL get_kernel();
+
+	/**
+	 * Function : get_kernel_name
+	 * -------------------------------
+	 * @return printable name of the kernel.
+	 */
+	const char* get_kernel_name(RAW12_KERNEL kernel);
+
+}
+
+/**
+ * Class : Raw12Packer
+ * -------------------------------
+ * Pipeline stage to be called from the user provided function, it takes the
+ * list of 16-bit container packets and returns a list of the same shape that
+ * points to the packed copy of them inside a buffer owned by this object.
+ * the packed buffer is rewritten on each call, so the stage MUST NOT be
+ * called for data that will be skipped (RealTimeInfo::is_skipped_data()),
+ * since the last packed frame may be still under transmission.
+ */
+class Raw12Packer{
+
+private:
+
+	//buffer which holds the packed data
+	uint8_t* buffer_;
+
+	//size of the buffer in bytes
+	uint_fast64_t buffer_size_;
+
+	//error handler class
+	Error error_handler_;
+
+public:
+
+	Raw12Packer();
+
+	/**
+	 * Method : initialize
+	 * -------------------------------
+	 * reserve the buffer for frames of up to max_pixels pixels in total.
+	 * @return true if the buffer reserved, false otherwise and the error is set.
+	 */
+	bool initialize(uint_fast64_t max_pixels);
+
+	/**
+	 * Method : pack
+	 * -------------------------------
+	 * pack each DATA_PTR_MEMORY_LOCATION packet in the list, data_size and
+	 * data_offset of the input are in bytes of the 16-bit container and MUST
+	 * be even.
+	 * @param in is the list with the 16-bit container packets.
+	 * @param out is the list to be filled, it must have the same number of
+	 * packets, only their data_ptr, data_size and data_offset are set, the
+	 * release functions of both lists stay with the caller.
+	 * @return true if packed, false otherwise and the error is set.
+	 */
+	bool pack(const DataPacketsList& in, DataPacketsList& out);
+
+	std::string get_error();
+
+	bool is_error();
+
+	~Raw12Packer();
+
+};
+
+#endif
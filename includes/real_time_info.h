@@ -0,0 +1,76 @@
+#ifndef SRC_SYSTEM_REAL_TIME_INFO_H
+#define SRC_SYSTEM_REAL_TIME_INFO_H
+
+#include <stdint.h>
+
+/**
+ * Class : RealTimeInfo
+ * -------------------------------
+ * This class will represent the data shared between the system and the user
+ * provided function.
+ * this class will contain several data that might be interesting to the
+ * user. as well as the option to stop the system.
+ */
+
+class RealTimeInfo{
+	private:
+		uint_fast32_t sequence_number_;
+		bool skip_next_data_;
+		uint_fast16_t delayed_ms_;
+		bool system_stopped_;
+		bool predicted_skip_;
+
+	public:
+
+		/**
+		 * Method : Constructor
+		 * -------------------------------
+		 * set the class data.
+		 */		
+		RealTimeInfo(uint_fast32_t sequence_number, bool skip_next_data, uint_fast16_t delayed_ms, bool system_stopped, bool predicted_skip = false);
+
+		/**
+		 * Method : get_sequence_number
+		 * -------------------------------
+		 * return the number of the current call to the user function.
+		 */
+		uint_fast32_t get_sequence_number();
+		/**
+		 * Method : get_delayed_time_ms
+		 * -------------------------------
+		 * return the number of milliseconds which used to complete the last
+		 * send from this time slot.
+		 * this option only used if the ms_tolerance was used when initializing
+		 * the system.
+		 */
+		uint_fast32_t get_delayed_time_ms();
+		/**
+		 * Method : is_skipped_data
+		 * -------------------------------
+		 * return true if this data will be ignored due to the flag skip_mode been
+		 * set to true when initializing the system.
+		 */
+		bool is_skipped_data();
+		/**
+		 * Method : is_predicted_skip
+		 * -------------------------------
+		 * return true if this data will be ignored because the link can't
+		 * deliver it in time while the last data was sent, the user may reduce
+		 * the size of the next data.
+		 */
+		bool is_predicted_skip();
+		/**
+		 * Method : stop_system
+		 * -------------------------------
+		 * the user will call this function only if the user want to stop the system.
+		 */
+		void stop_system();
+		/**
+		 * Method : is_system_stopped
+		 * -------------------------------
+		 * return true if the user decided to stop the system.
+		 */
+		bool is_system_stopped();
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,980 @@
+#ifndef SRC_SYSTEM_REAL_TIME_SYSTEM_T_H
+#define SRC_SYSTEM_REAL_TIME_SYSTEM_T_H
+
+#include <sched.h>
+#include <sys/mman.h>
+
+#include <string>
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <atomic>
+
+#include "flags.h"
+#include "error.h"
+#include "data_packets.h"
+#include "sender.h"
+#include "timers_utils.h"
+#include "thread_placement.h"
+#include "thread_usage.h"
+#include "perf_counters.h"
+#include "trace_events.h"
+#include "probes.h"
+#include "real_time_info.h"
+#include "frame_queue.h"
+
+namespace real_time_system_t{
+
+	//the callbacks which can be empty, other functors are always valid
+	template <class Callback>
+	bool is_empty_callback(const Callback&) {
+		return false;
+	}
+	template <class R, class... Args>
+	bool is_empty_callback(R (* const& callback)(Args...)) {
+		return callback == NULL;
+	}
+	template <class R, class... Args>
+	bool is_empty_callback(const std::function<R(Args...)>& callback) {
+		return !callback;
+	}
+}
+
+/**
+ * Class : RealTimeSystemT
+ * -------------------------------
+ * This class will run the system by connecting the timer, sender and the
+ * user application all together, the same as RealTimeSystem but with the
+ * types known at compile time.
+ * TimerPolicy and SenderPolicy are a timer and a sender class (or any class
+ * with the same methods), the tick path calls them directly instead of
+ * through the Timer and Sender virtual functions when they (or these
+ * methods, as in TCPSender) are final.
+ * Callback is anything callable as DataPacketsList(RealTimeInfo*), a lambda
+ * or a functor can keep its own state so the user data don't need to be
+ * global, it is called inline each tick.
+ *
+ *	auto fn = [&frame](RealTimeInfo* info) { ... return list; };
+ *	RealTimeSystemT<BusyWaitTimer, TCPSender, decltype(fn)> system(fn);
+ *
+ * RealTimeSystem is this class over Timer, Sender and std::function.
+ */
+template <class TimerPolicy, class SenderPolicy, class Callback>
+class RealTimeSystemT{
+
+private:
+	//timer to provide accurate sleep & wake
+	TimerPolicy* timer_;
+	//sender to transmit the data
+	SenderPolicy* sender_;
+	//the user application function to provide the data to be sent
+	Callback user_app_func_;
+	//error handler class
+	Error error_handler_;
+	//system frequency
+	uint_fast16_t frequency_;
+	//allow skip mode
+	bool allow_skip_mode_;
+	//is the object initialized
+	bool initialized_;
+	//time tolerance of the system
+	uint_fast16_t ms_tolerance_;
+	//allow skipping based on the link state
+	bool predictive_skip_;
+	//number of bytes handed to the sender in the last send
+	uint_fast64_t last_frame_bytes_;
+	//predict from the sender link state if the next data can't be delivered
+	//within its time slot
+	bool predict_late_frame();
+	//cores, priority and NUMA node of the system thread
+	ThreadPlacement placement_;
+	//the data handed to the sender in the last tick, it must stay alive
+	//while it is sent
+	DataPacketsList user_packets_list_;
+	//number of the current tick
+	uint_fast32_t sequence_number_;
+	//number of consecutive skipped ticks
+	uint_fast32_t skipped_count_;
+	//number of frames prepared ahead by the producer thread, 0 to call the
+	//user function in the tick
+	uint_fast16_t lookahead_;
+	//cores, priority and NUMA node of the producer thread, the cores other
+	//than the real time one by default
+	ThreadPlacement producer_placement_;
+	bool producer_placement_set_;
+	//the frames prepared by the producer thread
+	FrameQueue frame_queue_;
+	//the producer thread and is it running
+	pthread_t producer_thread_;
+	bool producer_running_;
+	//tolerance used by the last send, reported to the producer
+	std::atomic<uint_fast32_t> last_delayed_ms_;
+	//the loop of the producer thread
+	static void* producer_function(void* system);
+	//cpu time, context switches and page faults of the ticks
+	ThreadUsage usage_;
+	//hardware and software counters of the ticks, opened by initialize(0)
+	//if perf_counters_ is true
+	bool perf_counters_;
+	PerfCounters perf_;
+	//result of a single tick
+	enum TICK_RESULT {TICK_SENT, TICK_SKIPPED, TICK_STOPPED, TICK_FAILED};
+	//check the provided objects, the timer is checked only if with_timer is true
+	bool check_components(bool with_timer);
+	//initialize the sender, and the timer only if with_timer is true
+	bool initialize_components(bool with_timer);
+	//reset the state kept between the ticks and start the producer thread
+	//if lookahead is used
+	bool start_ticks();
+	//stop the producer thread if it was started
+	void end_ticks();
+	//the run(0) loop between start_ticks(0) and end_ticks(0)
+	bool run_ticks();
+	//handle a single tick after the sender used used_tolerated_time (in 0.5ms
+	//units) of the tolerance. in case of TICK_STOPPED or TICK_FAILED the sender
+	//is ended and in case of TICK_FAILED the error is set.
+	TICK_RESULT process_tick(uint_fast32_t used_tolerated_time);
+	//the scheduler drives the ticks of several systems
+	friend class StreamScheduler;
+public:
+
+
+	/**
+	 * Method : constructor
+	 * -------------------------------
+	 * the user function must be set by set_user_data_fn(1) before initialize(0).
+	 */
+	RealTimeSystemT();
+
+	/**
+	 * Method : constructor
+	 * -------------------------------
+	 * @param user_app_func is the function which will return the DataPacketsList
+	 * to be sent, needed for the callbacks which can't be assigned (lambdas).
+	 */
+	explicit RealTimeSystemT(Callback user_app_func);
+
+
+	/**
+	 * Method : set_timer
+	 * -------------------------------
+	 * The method will set the timer object with which the system will sleep.
+	 * @param timer is the pointer to constructed timer object.
+	 * @return true if successful, false otherwise.
+	 */
+	bool set_timer(TimerPolicy* timer);
+
+	/**
+	 * Method : set_sender
+	 * -------------------------------
+	 * The method will set the sender object with which the system will send the data.
+	 * @param sender is the pointer to constructed sender object.
+	 * @return true if successful, false otherwise.
+	 */
+	bool set_sender(SenderPolicy* sender);
+
+	/**
+	 * Method : set_user_data_fn
+	 * -------------------------------
+	 * The method will set the user provided function which will provide data
+	 * to be sent.
+	 * @param user_app_func is the function which will return the
+	 * DataPacketsList to be sent.
+	 * @return true if successful, false otherwise.
+	 */
+	bool set_user_data_fn(Callback user_app_func);
+
+
+	/**
+	 * Method : set_frequency
+	 * -------------------------------
+	 * The method will set the system frequency to the given one.
+	 * @param frequency is the frequency with which the system will run.
+	 * @return true if the frequency is supported by the timer.
+	 * false otherwise.
+	 * NOTE that, the checking for frequency validation may be deferred
+	 * to initialize(0) method.
+	 */
+	bool set_frequency(uint_fast16_t frequency);
+
+
+	/**
+	 * Method : set_system_ms_tolerance
+	 * -------------------------------
+	 * The method will set the tolerated ms for each time slice.
+	 * @param ms_tolerance is the amount of time in milliseconds where the system can give
+	 * to the sender to complete the current packet only if the sender couldn't complete
+	 * sending the data. Note that the data must be available during that extra time.
+	 * the system might decide to ignore/change this value.
+	 * so the ms_tolerance consider the upper limit only.
+	 * by default ms_tolerance in the system = 0.
+	 */
+	void set_ms_tolerance(uint_fast16_t ms_tolerance);
+
+	/**
+	 * Method : skip_mode
+	 * -------------------------------
+	 * The method will set the ability to skip the next data packet only if the
+	 * current data packet not sent yet.
+	 * @param skip_mode is a flag to determine what should happen if the sender couldn't
+	 * send the packet, if the skip_mode=true, then if the current packet not sent yet, the
+	 * next packet will be skipped, if it is false, then the transmission will be stopped if
+	 * single packet couldn't be delivered.
+	 */
+	void skip_mode(bool allow_skip_mode);
+
+	/**
+	 * Method : predictive_skip
+	 * -------------------------------
+	 * The method will set the ability to skip the next data packet before
+	 * handing it to the sender if the link state (unsent bytes, delivery rate,
+	 * congestion window and rtt) shows it can't be delivered within its time
+	 * slot, so the tolerance time is kept for the sending jitter.
+	 * @param predictive_skip is used only if skip_mode(1) is enabled and the
+	 * sender can provide its link state, disabled by default.
+	 */
+	void predictive_skip(bool predictive_skip);
+
+	/**
+	 * Method : set_placement
+	 * -------------------------------
+	 * The method will set where the system thread (the thread calling initialize(0)
+	 * and run(0)) runs, by default it runs on CPU_CORE_AFFINITY with priority 99.
+	 * the placement is applied in initialize(0), the numa_node makes the
+	 * allocations of this thread prefer that node.
+	 * use the senders placement methods to move their workers to other cores.
+	 * @param placement is the cores, SCHED_FIFO priority and NUMA node to use.
+	 * @return true if the placement is valid, false otherwise.
+	 */
+	bool set_placement(const ThreadPlacement& placement);
+
+	/**
+	 * Method : set_lookahead
+	 * -------------------------------
+	 * The method will make a producer thread call the user function up to
+	 * depth ticks ahead, the frames wait in a bounded queue and each tick
+	 * only takes the next one, so the time of the user function is not taken
+	 * from the time slot of the sender.
+	 * the data of a frame must stay available for depth + 1 ticks plus the
+	 * tolerance. the user function gets the tolerance used by the last send
+	 * known when it was called, is_skipped_data() is always false since the
+	 * skip is decided at the tick, the skipped frames are dropped. if the
+	 * producer is behind, the tick is skipped in skip mode and the system
+	 * stops otherwise.
+	 * @param depth is the number of frames prepared ahead, 0 (default) to
+	 * call the user function in the tick.
+	 */
+	void set_lookahead(uint_fast16_t depth);
+
+	/**
+	 * Method : set_producer_placement
+	 * -------------------------------
+	 * The method will set where the producer thread of set_lookahead(1) runs,
+	 * by default it runs with priority 97 on the cores other than the ones of
+	 * set_placement(1), on the same core only if the machine has no other, a
+	 * busy wait timer on the same core leaves no time for it.
+	 * @return true if the placement is valid, false otherwise.
+	 */
+	bool set_producer_placement(const ThreadPlacement& placement);
+
+	/**
+	 * Method : set_usage_accounting
+	 * -------------------------------
+	 * The method will sample the cpu time, context switches and page faults
+	 * of the thread running each tick (the system thread or a StreamScheduler
+	 * thread) from its wake up to the next sleep, a tick with a preemption or
+	 * a page fault is flagged in the stats and in the trace events, to be
+	 * matched with the skipped frames.
+	 * it's off by default, when on each tick costs two getrusage(2) calls.
+	 */
+	void set_usage_accounting(bool enabled);
+
+	/**
+	 * Method : get_usage_stats
+	 * -------------------------------
+	 * The method will give the usage of the ticks accounted since run(0), it
+	 * can be called from another thread while running.
+	 */
+	void get_usage_stats(ThreadUsageStats* stats);
+
+	/**
+	 * Method : set_perf_counters
+	 * -------------------------------
+	 * The method will make initialize(0) open the perf counters (cycles,
+	 * instructions, cache misses, task clock...) of the calling thread, they
+	 * are read around each tick run by run(0) on that thread with the bytes
+	 * handed to the sender, the counters the machine doesn't provide are
+	 * left out and the system runs the same if none is available.
+	 * it's off by default, when on each tick costs up to four read(2) calls.
+	 */
+	void set_perf_counters(bool enabled);
+
+	/**
+	 * Method : get_perf_stats
+	 * -------------------------------
+	 * The method will give the counters of the ticks since run(0), it can be
+	 * called from another thread while running.
+	 */
+	void get_perf_stats(PerfCounterStats* stats);
+
+	/**
+	 * Method : initialize
+	 * -------------------------------
+	 * The method will initialize the timer and sender.
+	 * this method must be called before run(0) and after setting all the needed
+	 * data in the object.
+	 * if everything goes fine the function should return true.
+	 * if error occur, the function will return false.
+	 */
+	bool initialize();
+
+	/**
+	 * Method : send_before_run
+	 * -------------------------------
+	 * The method will be used if the protocol require sending a message first
+	 * before the sequence of data starting to transmit, the user will provide a
+	 * list of packet and a time limit for the sending.
+	 * This function is optional, but if you will call it, you must call it after
+	 * calling initialize(0).
+	 * time_limit_ms is the milliseconds available to execute this order.
+	 * you should give good estimate to the actual transmuting + safe margin.
+	 * if the transmission done successfully true will be returned and the user
+	 * can run the system and start sending the data sequences.
+	 * if the sending didn't done successfully, the system will shutdown the sender and
+	 * the user must re initialize(0) the real_time_system again which in turn will
+	 * re initialize each component again.
+	 */
+	bool send_before_run(DataPacketsList list_of_data, uint_fast32_t time_limit_ms);
+
+	/**
+	 * Method : run
+	 * -------------------------------
+	 * The method will start the system in the exact time of calling.
+	 * if everything goes fine the function should never return unless the user
+	 * used stop_system().
+	 * if error occur at first or while transmitting the data the function will return
+	 * false and the error will be set to be pulled by is_error & get_error
+	 */
+	bool run();
+
+	/**
+	 * Method : get_error
+	 * -------------------------------
+	 * @return the error string if an error occurs and the error will be removed
+	 * after this call, if no error occurs, it return empty string ("").
+	 */
+	std::string get_error();
+
+	/**
+	 * Method : is_error
+	 * -------------------------------
+	 * Check if an error existed.
+	 * @return true if an error occurs, false otherwise.
+	 */
+	bool is_error();
+
+	~RealTimeSystemT();
+
+};
+
+template <class TimerPolicy, class SenderPolicy, class Callback>
+RealTimeSystemT<TimerPolicy, SenderPolicy, Callback>::RealTimeSystemT()
+ : user_app_func_(), error_handler_("RealTimeSystem"), placement_(CPU_CORE_AFFINITY, 99), user_packets_list_(0),
+   producer_placement_(CPU_CORE_AFFINITY, 97) {
+	timer_ = NULL;
+	sender_ = NULL;
+	allow_skip_mode_ = false;
+	initialized_ = false;
+	ms_tolerance_ = false;
+	predictive_skip_ = false;
+	last_frame_bytes_ = 0;
+	frequency_ = 0;
+	sequence_number_ = -1;
+	skipped_count_ = 0;
+	lookahead_ = 0;
+	producer_placement_set_ = false;
+	producer_running_ = false;
+	last_delayed_ms_ = 0;
+	perf_counters_ = false;
+}
+
+template <class TimerPolicy, class SenderPolicy, class Callback>
+RealTimeSystemT<TimerPolicy, SenderPolicy, Callback>::RealTimeSystemT(Callback user_app_func)
+ : user_app_func_(user_app_func), error_handler_("RealTimeSystem"), placement_(CPU_CORE_AFFINITY, 99), user_packets_list_(0),
+   producer_placement_(CPU_CORE_AFFINITY, 97) {
+	timer_ = NULL;
+	sender_ = NULL;
+	allow_skip_mode_ = false;
+	initialized_ = false;
+	ms_tolerance_ = false;
+	predictive_skip_ = false;
+	last_frame_bytes_ = 0;
+	frequency_ = 0;
+	sequence_number_ = -1;
+	skipped_count_ = 0;
+	lookahead_ = 0;
+	producer_placement_set_ = false;
+	producer_running_ = false;
+	last_delayed_ms_ = 0;
+	perf_counters_ = false;
+}
+
+template <class TimerPolicy, class SenderPolicy, class Callback>
+bool RealTimeSystemT<TimerPolicy, SenderPolicy, Callback>::set_timer(TimerPolicy* timer) {
+	initialized_ = false;
+	if(timer == NULL) {
+		error_handler_.set_error("Null Timer provided");
+		return false;
+	}
+	timer_ = timer;
+	return true;
+}
+
+template <class TimerPolicy, class SenderPolicy, class Callback>
+bool RealTimeSystemT<TimerPolicy, SenderPolicy, Callback>::set_sender(SenderPolicy* sender) {
+	initialized_ = false;
+	if(sender == NULL) {
+		error_handler_.set_error("Null Sender provided");
+		return false;
+	}
+	sender_ = sender;
+	return true;
+}
+
+template <class TimerPolicy, class SenderPolicy, class Callback>
+bool RealTimeSystemT<TimerPolicy, SenderPolicy, Callback>::set_user_data_fn(Callback user_app_func) {
+	initialized_ = false;
+	if(real_time_system_t::is_empty_callback(user_app_func)) {
+		error_handler_.set_error("Null Function provided");
+		return false;
+	}
+	user_app_func_ = user_app_func;
+	return true;
+}
+
+template <class TimerPolicy, class SenderPolicy, class Callback>
+bool RealTimeSystemT<TimerPolicy, SenderPolicy, Callback>::set_frequency(uint_fast16_t frequency) {
+	initialized_ = false;
+	frequency_ = frequency;
+	return true;
+}
+
+template <class TimerPolicy, class SenderPolicy, class Callback>
+void RealTimeSystemT<TimerPolicy, SenderPolicy, Callback>::set_ms_tolerance(uint_fast16_t ms_tolerance) {
+	initialized_ = false;
+	//set tolerance
+	ms_tolerance_ = ms_tolerance;
+}
+
+template <class TimerPolicy, class SenderPolicy, class Callback>
+void RealTimeSystemT<TimerPolicy, SenderPolicy, Callback>::skip_mode(bool allow_skip_mode) {
+	initialized_ = false;
+	//set skip mode
+	allow_skip_mode_ = allow_skip_mode;
+}
+
+template <class TimerPolicy, class SenderPolicy, class Callback>
+void RealTimeSystemT<TimerPolicy, SenderPolicy, Callback>::predictive_skip(bool predictive_skip) {
+	initialized_ = false;
+	//set predictive skip
+	predictive_skip_ = predictive_skip;
+}
+
+template <class TimerPolicy, class SenderPolicy, class Callback>
+bool RealTimeSystemT<TimerPolicy, SenderPolicy, Callback>::set_placement(const ThreadPlacement& placement) {
+	initialized_ = false;
+	if(!thread_placement::is_valid(placement)) {
+		error_handler_.set_error("Invalid placement, no cores or priority out of range");
+		return false;
+	}
+	placement_ = placement;
+	return true;
+}
+
+template <class TimerPolicy, class SenderPolicy, class Callback>
+void RealTimeSystemT<TimerPolicy, SenderPolicy, Callback>::set_lookahead(uint_fast16_t depth) {
+	initialized_ = false;
+	lookahead_ = depth;
+}
+
+template <class TimerPolicy, class SenderPolicy, class Callback>
+bool RealTimeSystemT<TimerPolicy, SenderPolicy, Callback>::set_producer_placement(const ThreadPlacement& placement) {
+	initialized_ = false;
+	if(!thread_placement::is_valid(placement)) {
+		error_handler_.set_error("Invalid placement, no cores or priority out of range");
+		return false;
+	}
+	producer_placement_ = placement;
+	producer_placement_set_ = true;
+	return true;
+}
+
+template <class TimerPolicy, class SenderPolicy, class Callback>
+void RealTimeSystemT<TimerPolicy, SenderPolicy, Callback>::set_usage_accounting(bool enabled) {
+	usage_.set_enabled(enabled);
+}
+
+template <class TimerPolicy, class SenderPolicy, class Callback>
+void RealTimeSystemT<TimerPolicy, SenderPolicy, Callback>::get_usage_stats(ThreadUsageStats* stats) {
+	usage_.get_stats(stats);
+}
+
+template <class TimerPolicy, class SenderPolicy, class Callback>
+void RealTimeSystemT<TimerPolicy, SenderPolicy, Callback>::set_perf_counters(bool enabled) {
+	initialized_ = false;
+	perf_counters_ = enabled;
+}
+
+template <class TimerPolicy, class SenderPolicy, class Callback>
+void RealTimeSystemT<TimerPolicy, SenderPolicy, Callback>::get_perf_stats(PerfCounterStats* stats) {
+	perf_.get_stats(stats);
+}
+
+template <class TimerPolicy, class SenderPolicy, class Callback>
+bool RealTimeSystemT<TimerPolicy, SenderPolicy, Callback>::initialize() {
+
+	//checks for not given data
+	if(!check_components(true)) {
+		return false;
+	}
+
+	//try to convert the process to real time one.
+	if(!thread_placement::make_real_time(placement_, &error_handler_)) {
+		return false;
+	}
+
+	//open the counters out of the real time loop, the system runs without
+	//them if the machine has none
+	if(perf_counters_) {
+		perf_.open();
+	} else {
+		perf_.close();
+	}
+
+	return initialize_components(true);
+}
+
+template <class TimerPolicy, class SenderPolicy, class Callback>
+bool RealTimeSystemT<TimerPolicy, SenderPolicy, Callback>::check_components(bool with_timer) {
+
+	//checks for not given data
+	if(real_time_system_t::is_empty_callback(user_app_func_)) {
+		error_handler_.set_error("Null user Function provided");
+		return false;
+	}
+	if(with_timer && timer_ == NULL) {
+		error_handler_.set_error("Null Timer provided");
+		return false;
+	}
+	if(sender_ == NULL) {
+		error_handler_.set_error("Null Sender provided");
+		return false;
+	}
+	if(frequency_ == 0) {
+		error_handler_.set_error("Not provided frequency");
+		return false;
+	}
+	return true;
+}
+
+template <class TimerPolicy, class SenderPolicy, class Callback>
+bool RealTimeSystemT<TimerPolicy, SenderPolicy, Callback>::initialize_components(bool with_timer) {
+
+	if(with_timer) {
+		//try to initialize the objects
+		if(!timer_->initialize()) {
+			error_handler_.set_error(timer_->get_error());
+			return false;
+		}
+		//try to set the timer frequency
+		if(!timer_->set_frequency(frequency_)) {
+			error_handler_.set_error(timer_->get_error());
+			return false;
+		}
+	}
+	//try to initialize the sender object
+	if(!sender_->initialize()) {
+		error_handler_.set_error(sender_->get_error());
+		return false;
+	}
+
+	//adjust tolerance
+	ms_tolerance_ = std::min(ms_tolerance_, uint_fast16_t((1000/frequency_) - 5));
+	//nothing sent yet
+	last_frame_bytes_ = 0;
+	//set everything is good
+	initialized_ = true;
+	return true;
+}
+
+template <class TimerPolicy, class SenderPolicy, class Callback>
+bool RealTimeSystemT<TimerPolicy, SenderPolicy, Callback>::send_before_run(DataPacketsList list_of_data, uint_fast32_t time_limit_ms) {
+
+	//check initialization
+	if(!initialized_) {
+		error_handler_.set_error("System not initialized yet");
+		return false;
+	}
+
+	//provide the data to the sender
+	sender_->send(&(list_of_data));
+
+	//log(n) sleeping
+	while(time_limit_ms) {
+
+		//calculate the sleep time
+		uint_fast32_t sleeping_time = time_limit_ms/2 + 1;
+		time_limit_ms -= sleeping_time;
+
+		//sleep for the given time
+		timers_utils::milliseconds_sleep(sleeping_time);
+
+		//check the sender
+		if(sender_->is_send_done()) {
+			break;
+		}
+
+	}
+
+	//if sending done successfully
+	if(sender_->is_send_done()) {
+		return true;
+	}
+
+	//if not then shutdown the sender
+	sender_->end_sender();
+	error_handler_.set_error("Sender couldn't send the data in the given time limit");
+	initialized_ = false;
+	return false;
+}
+
+template <class TimerPolicy, class SenderPolicy, class Callback>
+bool RealTimeSystemT<TimerPolicy, SenderPolicy, Callback>::run() {
+
+	//check initialization
+	if(!initialized_) {
+		error_handler_.set_error("System not initialized yet.");
+		return false;
+	}
+	//set the initialization flag to false again.
+	initialized_ = false;
+
+	//reset the ticks and prepare the first frames
+	if(!start_ticks()) {
+		sender_->end_sender();
+		return false;
+	}
+
+	bool result = run_ticks();
+	end_ticks();
+	return result;
+}
+
+template <class TimerPolicy, class SenderPolicy, class Callback>
+bool RealTimeSystemT<TimerPolicy, SenderPolicy, Callback>::run_ticks() {
+
+	trace_events::set_thread_name("RealTimeSystem");
+
+	//start the timer
+	if(!timer_->start_timer()) {
+		error_handler_.set_error(timer_->get_error());
+		return false;
+	}
+
+	while(1) {
+		trace_events::begin("tick", sequence_number_ + 1);
+		RTDT_PROBE1(tick__start, sequence_number_ + 1);
+		usage_.begin();
+		perf_.begin();
+		//if the sender not done yet, then let it consume as much as
+		//wanted from the extra time.
+		uint_fast32_t used_tolerated_time = 0;
+		if(!sender_->is_send_done()) {
+			trace_events::begin("tolerance wait");
+			for(; used_tolerated_time < uint_fast32_t(ms_tolerance_*2); used_tolerated_time++) {
+				if(sender_->is_send_done()) {
+					break;
+				}
+				timers_utils::microseconds_sleep(500);
+			}
+			trace_events::end("tolerance wait");
+		}
+
+		//handle the tick
+		TICK_RESULT result = process_tick(used_tolerated_time);
+		usage_.end(sequence_number_);
+		if(perf_.is_open()) {
+			uint_fast64_t frame_bytes = 0;
+			for(uint_fast32_t i=0; result == TICK_SENT && i<user_packets_list_.num_packets; i++) {
+				frame_bytes += user_packets_list_.packets[i].data_size;
+			}
+			perf_.end(frame_bytes);
+		}
+		trace_events::end("tick");
+		if(result == TICK_STOPPED) {
+			return true;
+		}
+		if(result == TICK_FAILED) {
+			return false;
+		}
+
+		//and sleep until the next timer tick
+		trace_events::begin("timer sleep");
+		bool woke = timer_->sleep_to_next_tick();
+		trace_events::end("timer sleep");
+		if(!woke) {
+			RTDT_PROBE1(tick__overrun, sequence_number_);
+			error_handler_.set_error("Failed to return from the sender object in the needed time - this bug related to the sender object not to the size of the payload");
+			sender_->end_sender();
+			return false;
+		}
+	}
+
+}
+
+template <class TimerPolicy, class SenderPolicy, class Callback>
+bool RealTimeSystemT<TimerPolicy, SenderPolicy, Callback>::start_ticks() {
+	sequence_number_ = -1;
+	skipped_count_ = 0;
+	last_delayed_ms_ = 0;
+	usage_.reset();
+	perf_.reset();
+	if(lookahead_ == 0) {
+		return true;
+	}
+
+	//the queue slots are allocated before the real time loop
+	frame_queue_.initialize(lookahead_);
+	if(!producer_placement_set_) {
+		producer_placement_ = thread_placement::other_cores(placement_, 97);
+	}
+
+	//create the producer thread
+	struct sched_param param;
+	pthread_attr_t attr;
+	if(pthread_attr_init(&attr) ||
+	   pthread_attr_setschedpolicy(&attr, SCHED_FIFO)) {
+		error_handler_.set_error("init pthread attributes failed");
+		return false;
+	}
+	param.sched_priority = producer_placement_.priority;
+	if(pthread_attr_setschedparam(&attr, &param) ||
+	   pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED)) {
+		error_handler_.set_error("pthread setschedparam failed");
+		pthread_attr_destroy(&attr);
+		return false;
+	}
+	int th_st = pthread_create(&producer_thread_, &attr, producer_function, (void*) this);
+	pthread_attr_destroy(&attr);
+	if(th_st) {
+		error_handler_.set_error("pthread_create() return code: " + std::to_string(th_st));
+		return false;
+	}
+	producer_running_ = true;
+
+	//start with all the frames prepared
+	frame_queue_.wait_full();
+	return true;
+}
+
+template <class TimerPolicy, class SenderPolicy, class Callback>
+void RealTimeSystemT<TimerPolicy, SenderPolicy, Callback>::end_ticks() {
+	if(!producer_running_) {
+		return;
+	}
+	frame_queue_.close();
+	pthread_join(producer_thread_, NULL);
+	producer_running_ = false;
+	//give the prepared frames which will never be sent back to their owner
+	DataPacketsList dropped_packets_list(0);
+	bool stop = false;
+	while(frame_queue_.pop(&dropped_packets_list, &stop)) {
+		dropped_packets_list.release_packets();
+	}
+}
+
+template <class TimerPolicy, class SenderPolicy, class Callback>
+void* RealTimeSystemT<TimerPolicy, SenderPolicy, Callback>::producer_function(void* system) {
+	RealTimeSystemT* self = (RealTimeSystemT*) system;
+	//the frames are still produced if the placement fails, only slower
+	thread_placement::set_affinity(self->producer_placement_);
+	thread_placement::set_memory_node(self->producer_placement_);
+	trace_events::set_thread_name("frame producer");
+	for(uint_fast32_t sequence_number = 0; ; sequence_number++) {
+		DataPacketsList* frame = self->frame_queue_.begin_push();
+		if(frame == NULL) {
+			break;
+		}
+		RealTimeInfo user_info(sequence_number, false, self->last_delayed_ms_, false);
+		trace_events::begin("user fn", sequence_number);
+		*frame = self->user_app_func_(&user_info);
+		trace_events::end("user fn");
+		self->frame_queue_.end_push(user_info.is_system_stopped());
+		//nothing more is needed after the last frame
+		if(user_info.is_system_stopped()) {
+			break;
+		}
+	}
+	return NULL;
+}
+
+template <class TimerPolicy, class SenderPolicy, class Callback>
+typename RealTimeSystemT<TimerPolicy, SenderPolicy, Callback>::TICK_RESULT
+RealTimeSystemT<TimerPolicy, SenderPolicy, Callback>::process_tick(uint_fast32_t used_tolerated_time) {
+
+	//increase the sequence number
+	sequence_number_++;
+
+	//check skip counter
+	//this check here to detect if the client disconnected.
+	if(skipped_count_ == uint_fast32_t(frequency_*3)) {
+		error_handler_.set_error("The client disconnected.");
+		sender_->end_sender();
+		return TICK_FAILED;
+	}
+
+	//if after the extra time is not done yet, then check the skip_mode and act.
+	if(!sender_->is_send_done() && !allow_skip_mode_) {
+		error_handler_.set_error("Failed to send the data in the required time");
+		sender_->end_sender();
+		return TICK_FAILED;
+	}
+
+	//if after the extra time is not done yet, or the link can't deliver the
+	//next data in its time slot, then check the skip_mode and act.
+	bool late_send = !sender_->is_send_done();
+	if(allow_skip_mode_ && (late_send || predict_late_frame())) {
+		DataPacketsList ignored_packets_list(0);
+		bool stop = false;
+		if(lookahead_ != 0) {
+			//drop the prepared frame
+			frame_queue_.pop(&ignored_packets_list, &stop);
+		} else {
+			//construct the info class
+			RealTimeInfo user_info(sequence_number_, true, used_tolerated_time/2, false, !late_send);
+			//call the user function then ignore the packets
+			trace_events::begin("user fn", sequence_number_);
+			ignored_packets_list = user_app_func_(&user_info);
+			trace_events::end("user fn");
+			stop = user_info.is_system_stopped();
+		}
+		//give the dropped data back to its owner
+		ignored_packets_list.release_packets();
+		trace_events::instant(late_send ? "skipped frame (late send)" : "skipped frame (predicted)", sequence_number_);
+		RTDT_PROBE2(skip__decision, sequence_number_, late_send ? 0 : 1);
+		//check if the user wants to end the system
+		if(stop) {
+			sender_->end_sender();
+			return TICK_STOPPED;
+		}
+		//increment skip counter, unless the sender already knows the client
+		//is lost and waits for a new one
+		if(!sender_->is_reconnecting()) {
+			skipped_count_++;
+		}
+		return TICK_SKIPPED;
+	}
+	if(lookahead_ != 0) {
+		//take the prepared frame
+		bool stop = false;
+		if(!frame_queue_.pop(&user_packets_list_, &stop)) {
+			if(!allow_skip_mode_) {
+				error_handler_.set_error("The user function didn't prepare the data in the required time");
+				sender_->end_sender();
+				return TICK_FAILED;
+			}
+			//not counted for the disconnect detection, the link is fine
+			trace_events::instant("skipped frame (producer late)", sequence_number_);
+			RTDT_PROBE2(skip__decision, sequence_number_, 2);
+			return TICK_SKIPPED;
+		}
+		last_delayed_ms_ = used_tolerated_time;
+		//check if the user wants to end the system
+		if(stop) {
+			user_packets_list_.release_packets();
+			sender_->end_sender();
+			return TICK_STOPPED;
+		}
+	} else {
+		//construct the info class
+		RealTimeInfo user_info(sequence_number_, false, used_tolerated_time, false);
+		//call the user function to get the packets
+		trace_events::begin("user fn", sequence_number_);
+		user_packets_list_ = user_app_func_(&user_info);
+		trace_events::end("user fn");
+		//check if the user wants to end the system
+		if(user_info.is_system_stopped()) {
+			user_packets_list_.release_packets();
+			sender_->end_sender();
+			return TICK_STOPPED;
+		}
+	}
+	//empty skip counter
+	skipped_count_ = 0;
+	//keep the size for the next prediction
+	if(predictive_skip_) {
+		last_frame_bytes_ = 0;
+		for(uint_fast32_t i=0; i<user_packets_list_.num_packets; i++) {
+			last_frame_bytes_ += user_packets_list_.packets[i].data_size;
+		}
+	}
+	//then send the user data
+	trace_events::begin("send handoff", sequence_number_);
+	RTDT_PROBE2(send__handoff, sequence_number_, user_packets_list_.num_packets);
+	bool handed_off = sender_->send(&(user_packets_list_));
+	trace_events::end("send handoff");
+	if(!handed_off) {
+		//the sender didn't take the data
+		user_packets_list_.release_packets();
+		error_handler_.set_error(sender_->get_error());
+		sender_->end_sender();
+		return TICK_FAILED;
+	}
+	return TICK_SENT;
+}
+
+template <class TimerPolicy, class SenderPolicy, class Callback>
+std::string RealTimeSystemT<TimerPolicy, SenderPolicy, Callback>::get_error() {
+	std::string error = error_handler_.get_error();
+	error_handler_.clear_error();
+	return error;
+}
+
+template <class TimerPolicy, class SenderPolicy, class Callback>
+bool RealTimeSystemT<TimerPolicy, SenderPolicy, Callback>::is_error() {
+	return error_handler_.is_error();
+}
+
+template <class TimerPolicy, class SenderPolicy, class Callback>
+bool RealTimeSystemT<TimerPolicy, SenderPolicy, Callback>::predict_late_frame() {
+	SenderLinkState state;
+	if(!predictive_skip_ || !sender_->get_link_state(&state)) {
+		return false;
+	}
+	//the link keeps up with the data
+	if(state.unsent_bytes == 0) {
+		return false;
+	}
+	//take the optimistic rate between the measured delivery rate and cwnd/rtt,
+	//an application limited rate tells nothing about the link.
+	uint_fast64_t rate = 0;
+	if(!state.delivery_rate_app_limited) {
+		rate = state.delivery_rate;
+	}
+	if(state.rtt_us != 0) {
+		rate = std::max(rate, uint_fast64_t(state.cwnd_bytes) * SEC_TO_US(1) / state.rtt_us);
+	}
+	if(rate == 0) {
+		return false;
+	}
+	//time to drain the queue and send a frame as big as the last one
+	uint_fast64_t predicted_ns = (state.unsent_bytes + last_frame_bytes_) * SEC_TO_NS(1) / rate;
+	return predicted_ns > SEC_TO_NS(1) / frequency_;
+}
+
+template <class TimerPolicy, class SenderPolicy, class Callback>
+RealTimeSystemT<TimerPolicy, SenderPolicy, Callback>::~RealTimeSystemT() {
+	end_ticks();
+}
+
+#endif
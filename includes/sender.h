@@ -6,6 +6,34 @@
 
 #include "data_packets.h"
 
+/**
+ * Struct : SenderLinkState
+ * -------------------------------
+ * This struct will hold the live state of the link the sender writes to,
+ * used by the system to predict if the next data can be sent in time.
+ * fields the sender can't know are left 0.
+ */
+struct SenderLinkState{
+
+	//bytes in the send queue not acknowledged yet (sent and not sent)
+	uint_fast32_t queued_bytes = 0;
+
+	//bytes in the send queue not sent yet
+	uint_fast32_t unsent_bytes = 0;
+
+	//smoothed round trip time in microseconds
+	uint_fast32_t rtt_us = 0;
+
+	//congestion window in bytes
+	uint_fast32_t cwnd_bytes = 0;
+
+	//recent delivery rate in bytes per second
+	uint_fast64_t delivery_rate = 0;
+
+	//the delivery rate was limited by the application not by the link
+	bool delivery_rate_app_limited = false;
+};
+
 /**
  * Pure Abstract Class : Sender
  * -------------------------------
@@ -51,6 +79,27 @@ public:
 	 */
 	virtual bool is_send_done() = 0;
 
+	/**
+	 * Method : get_link_state
+	 * -------------------------------
+	 * The method should fill the live state of the link, it MUST be cheap
+	 * enough to be called once per tick.
+	 * @param state is the struct to be filled.
+	 * @return true if the state is filled, false if the sender can't provide
+	 * it (not initialized or not supported), no error is reported.
+	 */
+	virtual bool get_link_state(SenderLinkState* state) = 0;
+
+	/**
+	 * Method : is_reconnecting
+	 * -------------------------------
+	 * The method check if the sender lost its client and waits for a new one,
+	 * the system keeps ticking in skip mode and doesn't count the skipped
+	 * ticks as a disconnected client meanwhile.
+	 * @return true if waiting for a new client, false otherwise.
+	 */
+	virtual bool is_reconnecting() = 0;
+
 	/**
 	 * Method : end_sender
 	 * -------------------------------
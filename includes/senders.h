@@ -1,3 +1,10 @@
 #include "sender.h"
+#include "link_scheduler.h"
 #include "tcp_sender.h"
-#include "tcp_sender_zc.h"
\ No newline at end of file
+#include "tcp_sender_zc.h"
+#include "tcp_sender_splice.h"
+#include "shm_sender.h"
+#include "shm_consumer.h"
+#include "unix_sender.h"
+#include "unix_consumer.h"
+#include "mock_sender.h"
\ No newline at end of file
@@ -0,0 +1,127 @@
+#ifndef SRC_UTILS_SHM_CONSUMER_H
+#define SRC_UTILS_SHM_CONSUMER_H
+
+#include <stdint.h>
+
+#include <string>
+
+#include "error.h"
+#include "shm_ring.h"
+
+/**
+ * Struct : ShmFrame
+ * -------------------------------
+ * This struct will hold a frame read from the ring of a ShmSender, the data
+ * points into the shared memory and is valid until the sender overwrites
+ * the slot, done_frame(1) tells if that happened while it was read.
+ */
+struct ShmFrame{
+
+	//number of the frame since the sender initialized, from 1
+	uint64_t sequence = 0;
+
+	//CLOCK_MONOTONIC time the frame was published
+	uint64_t timestamp_ns = 0;
+
+	//the packets back to back
+	const char* data = NULL;
+	uint32_t size = 0;
+
+	//the size of each packet
+	uint32_t num_packets = 0;
+	const uint32_t* packet_sizes = NULL;
+};
+
+/**
+ * Class : ShmConsumer
+ * -------------------------------
+ * This class will read the frames of a ShmSender from another process (or
+ * the same one) without copying them: open(1) maps the ring and takes a
+ * read cursor, wait_frame(2) gives the next frame in place and done_frame(1)
+ * moves the cursor after it.
+ * the sender never waits for the consumers, a consumer which falls more
+ * than the ring behind skips to the oldest frame still kept and the skipped
+ * frames are counted as lost.
+ * no syscall is made while frames are ready, the consumer sleeps on a futex
+ * of the ring otherwise.
+ */
+class ShmConsumer{
+
+private:
+
+	Error error_handler_;
+
+	int fd_;
+	ShmRingHeader* header_;
+
+	//the layout checked at open(1), the one of the shared header may change
+	ShmRingLayout layout_;
+
+	//the cursor of this consumer in the ring
+	ShmConsumerCursor* cursor_;
+
+public:
+
+	ShmConsumer();
+
+	/**
+	 * Method : open
+	 * -------------------------------
+	 * map the ring of a sender and take a free cursor, the first frame read
+	 * is the next one published.
+	 * @param path is ShmSender::get_consumer_path(0) of the sender.
+	 * @return true if the ring is mapped, false otherwise.
+	 * when false is returned the error_handler_ will be set accordingly.
+	 */
+	bool open(const std::string& path);
+
+	/**
+	 * Method : close
+	 * -------------------------------
+	 * give back the cursor and unmap the ring.
+	 */
+	void close();
+
+	/**
+	 * Method : wait_frame
+	 * -------------------------------
+	 * get the next frame, waiting for it to be published.
+	 * @param frame is filled with the frame.
+	 * @param timeout_ms is the longest wait in milliseconds, -1 for none.
+	 * @return true if a frame is given, false if the timeout expired, the
+	 * sender ended (is_closed(0)) or the consumer is not opened (error).
+	 */
+	bool wait_frame(ShmFrame* frame, int timeout_ms);
+
+	/**
+	 * Method : done_frame
+	 * -------------------------------
+	 * move the cursor after the frame read by wait_frame(2).
+	 * @return true if the frame was intact while read, false if the sender
+	 * overwrote it meanwhile, it's counted as lost.
+	 */
+	bool done_frame(const ShmFrame& frame);
+
+	/**
+	 * Method : is_closed
+	 * -------------------------------
+	 * @return true if the sender ended and every frame was read.
+	 */
+	bool is_closed();
+
+	/**
+	 * Method : get_lost_frames
+	 * -------------------------------
+	 * @return the frames overwritten before this consumer read them.
+	 */
+	uint64_t get_lost_frames();
+
+	std::string get_error();
+
+	bool is_error();
+
+	~ShmConsumer();
+
+};
+
+#endif
@@ -0,0 +1,167 @@
+#ifndef SRC_UTILS_SHM_RING_H
+#define SRC_UTILS_SHM_RING_H
+
+#include <stdint.h>
+
+#include <atomic>
+
+#include "flags.h"
+
+//"RTDS" when read as little endian bytes
+#define SHM_RING_MAGIC	(0x53445452u)
+#define SHM_RING_VERSION	(1u)
+
+//the counters are shared between processes, they must not use a lock
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2, "the ring needs lock free atomics");
+
+/**
+ * Struct : ShmConsumerCursor
+ * -------------------------------
+ * This struct will hold the read position of one consumer of the ring, on
+ * its own cache line so the consumers don't slow each other.
+ */
+struct alignas(64) ShmConsumerCursor{
+
+	//the process of the consumer, 0 if the cursor is free
+	std::atomic<uint32_t> pid;
+
+	//the sequence of the next frame the consumer reads
+	std::atomic<uint64_t> next_frame;
+
+	//frames overwritten before the consumer read them
+	std::atomic<uint64_t> lost_frames;
+
+	//the consumer waits on the futex of the ring, the sender wakes the
+	//consumers only if one waits
+	std::atomic<uint32_t> waiting;
+};
+
+/**
+ * Struct : ShmRingHeader
+ * -------------------------------
+ * This struct will be at the start of the shared memory of a ShmSender,
+ * followed by the slots, slot n holds the frames of sequence n + 1 modulo
+ * the number of slots (the first frame is 1, 0 is no frame).
+ * the sender never waits for the consumers, a slow consumer loses the
+ * frames overwritten before it read them.
+ * the consumers only write their own cursor, the sender and the consumers
+ * never compute an address from the layout fields of the shared header,
+ * each keeps its own checked ShmRingLayout.
+ */
+struct ShmRingHeader{
+
+	//SHM_RING_MAGIC, SHM_RING_VERSION
+	uint32_t magic;
+	uint32_t version;
+
+	//number of slots, the bytes a slot holds and the distance between them,
+	//for the consumers to rebuild the layout
+	uint32_t slots;
+	uint32_t slot_capacity;
+	uint64_t slot_stride;
+
+	//offset of the first slot from the header
+	uint64_t slots_offset;
+
+	//the sequence of the last published frame, 0 if none
+	alignas(64) std::atomic<uint64_t> last_frame;
+
+	//the futex the consumers wait on, changed with each published frame
+	std::atomic<uint32_t> futex;
+
+	//the sender ended, no frame will follow the last one
+	std::atomic<uint32_t> closed;
+
+	ShmConsumerCursor cursors[SHM_RING_MAX_CONSUMERS];
+};
+
+/**
+ * Struct : ShmSlotHeader
+ * -------------------------------
+ * This struct will be at the start of each slot, followed by the frame
+ * bytes, the packets back to back.
+ * the sequence is 0 while the sender writes the slot, a reader checks it
+ * is unchanged after reading the frame.
+ */
+struct ShmSlotHeader{
+
+	//the frame in the slot, 0 while it's written
+	std::atomic<uint64_t> sequence;
+
+	//CLOCK_MONOTONIC time the frame was published
+	uint64_t timestamp_ns;
+
+	//bytes of the frame and its packets
+	uint32_t frame_size;
+	uint32_t num_packets;
+	uint32_t packet_sizes[SHM_RING_MAX_PACKETS];
+};
+
+/**
+ * Struct : ShmRingLayout
+ * -------------------------------
+ * This struct will hold where the slots of a ring are, kept out of the
+ * shared memory by the sender and by each consumer.
+ */
+struct ShmRingLayout{
+
+	//number of slots, the bytes a slot holds and the distance between them
+	uint32_t slots = 0;
+	uint32_t slot_capacity = 0;
+	uint64_t slot_stride = 0;
+
+	//offset of the first slot from the header and the bytes of the ring
+	uint64_t slots_offset = 0;
+	uint64_t size = 0;
+};
+
+namespace shm_ring{
+
+	/**
+	 * Function : layout
+	 * -------------------------------
+	 * @return the layout of a ring of slots (at least one) of slot_capacity
+	 * bytes.
+	 */
+	ShmRingLayout layout(uint32_t slots, uint32_t slot_capacity);
+
+	/**
+	 * Function : slot
+	 * -------------------------------
+	 * @return the header of the slot of the frame sequence (from 1).
+	 */
+	ShmSlotHeader* slot(ShmRingHeader* header, const ShmRingLayout& layout, uint64_t sequence);
+
+	/**
+	 * Function : slot_data
+	 * -------------------------------
+	 * @return the frame bytes of the slot.
+	 */
+	char* slot_data(ShmSlotHeader* slot);
+
+	/**
+	 * Function : publish
+	 * -------------------------------
+	 * make the frame written in its slot the last one and wake the waiting
+	 * consumers, a single syscall only if a consumer waits.
+	 */
+	void publish(ShmRingHeader* header, uint64_t sequence);
+
+	/**
+	 * Function : close
+	 * -------------------------------
+	 * mark the ring ended and wake the waiting consumers.
+	 */
+	void close(ShmRingHeader* header);
+
+	/**
+	 * Function : wait
+	 * -------------------------------
+	 * wait until a frame after last_frame is published, the ring is closed or
+	 * the timeout in milliseconds (-1 for none) expires, the consumer is
+	 * marked waiting in its cursor meanwhile.
+	 */
+	void wait(ShmRingHeader* header, ShmConsumerCursor* cursor, uint64_t last_frame, int timeout_ms);
+}
+
+#endif
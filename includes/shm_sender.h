@@ -0,0 +1,193 @@
+#ifndef SRC_SENDERS_SHM_SENDER_H
+#define SRC_SENDERS_SHM_SENDER_H
+
+#include <string>
+#include <stdint.h>
+#include <limits.h>
+#include <pthread.h>
+
+#include "flags.h"
+#include "sender.h"
+#include "error.h"
+#include "data_packets.h"
+#include "shm_ring.h"
+#include "mutex_raii.h"
+#include "atomic_val_raii.h"
+#include "timers_utils.h"
+#include "trace_events.h"
+
+/**
+ * Struct : ShmWorkerData
+ * -------------------------------
+ * This struct will be given to the worker thread of a ShmSender, the data
+ * shared with the sender and the ring it writes to.
+ */
+struct ShmWorkerData{
+	SenderWorkerData* shared_data = NULL;
+	ShmRingHeader* ring = NULL;
+
+	//the layout the ring was created with, the one of the shared header is
+	//writable by the consumers
+	ShmRingLayout layout;
+};
+
+/**
+ * Class : ShmSender
+ * -------------------------------
+ * This class will publish the frames to the consumers of the same host (a
+ * recorder, a preview encoder) through a ring of frames in a memfd, instead
+ * of the TCP loopback: the worker copies each frame once into the next slot
+ * of the ring and wakes the waiting consumers, which read it in place with
+ * a ShmConsumer, each one from its own cursor.
+ * the sender never waits for the consumers, a frame is done once it's in
+ * the ring and the slowest consumers lose the overwritten frames. frames
+ * are published with no consumer attached, the sender never reconnects.
+ * the consumers open the ring at get_consumer_path(0), the memfd is sealed
+ * so its size can't change under them.
+ */
+class ShmSender final : public Sender{
+
+private:
+
+	//the frames the ring holds and the bytes of each
+	uint_fast32_t slots_;
+	uint_fast32_t slot_capacity_;
+
+	//the memfd of the ring and its mapping
+	int ring_fd_;
+	ShmRingHeader* ring_;
+
+	//the slots of the ring are only addressed from this copy
+	ShmRingLayout ring_layout_;
+
+	//The thread where the frames are copied to the ring
+	pthread_t worker_thread_;
+
+	//The data which is shared between this class and it's worker thread
+	SenderWorkerData shared_data_;
+	ShmWorkerData worker_data_;
+
+	//error handler class
+	Error error_handler_;
+
+	//initialized?
+	bool initialized_;
+
+	//cores, priority and NUMA node of the worker thread
+	ThreadPlacement worker_placement_;
+
+	//the worker accounts the usage of each frame
+	bool usage_accounting_;
+	//the worker counts the perf events of each frame
+	bool perf_counters_;
+
+	//the worker thread was created and not joined yet
+	bool worker_running_;
+
+	//bytes of the frame given to the worker
+	uint_fast64_t frame_bytes_;
+
+	//create the sealed memfd of the ring and map it
+	//returns true if every thing runs correctly, false otherwise
+	//when false is returned the error_handler_ will be set accordingly.
+	bool create_ring();
+
+public:
+
+	/**
+	 * Method : Constructor
+	 * -------------------------------
+	 * @param slot_capacity is the largest frame in bytes.
+	 * @param slots is the number of frames kept for the slow consumers.
+	 */
+	ShmSender(uint_fast32_t slot_capacity, uint_fast32_t slots = SHM_SENDER_SLOTS);
+
+	/**
+	 * Method : get_consumer_path
+	 * -------------------------------
+	 * @return the path the consumers open the ring with, empty if the sender
+	 * is not initialized.
+	 */
+	std::string get_consumer_path();
+
+	/**
+	 * Method : get_consumers
+	 * -------------------------------
+	 * @return the number of attached consumers.
+	 */
+	uint_fast32_t get_consumers();
+
+	/**
+	 * Method : set_worker_placement
+	 * -------------------------------
+	 * set where the worker thread runs, by default it runs on CPU_CORE_AFFINITY
+	 * with priority 98, the numa_node makes its allocations prefer that node.
+	 * must be called before initialize(0).
+	 * @return true if the placement is valid, false otherwise.
+	 */
+	bool set_worker_placement(const ThreadPlacement& placement);
+
+	/**
+	 * Method : set_usage_accounting
+	 * -------------------------------
+	 * sample the cpu time, context switches and page faults of the worker
+	 * thread around each frame.
+	 * must be called before initialize(0), disabled by default.
+	 */
+	void set_usage_accounting(bool enabled);
+
+	/**
+	 * Method : get_worker_usage_stats
+	 * -------------------------------
+	 * give the usage of the frames published since initialize(0).
+	 */
+	void get_worker_usage_stats(ThreadUsageStats* stats);
+
+	/**
+	 * Method : set_perf_counters
+	 * -------------------------------
+	 * count the perf events of the worker thread around each frame.
+	 * must be called before initialize(0), disabled by default.
+	 */
+	void set_perf_counters(bool enabled);
+
+	/**
+	 * Method : get_worker_perf_stats
+	 * -------------------------------
+	 * give the counters of the frames published since initialize(0).
+	 */
+	void get_worker_perf_stats(PerfCounterStats* stats);
+
+	bool initialize() override;
+
+	/**
+	 * Method : send
+	 * -------------------------------
+	 * a frame larger than the slots or with more than SHM_RING_MAX_PACKETS
+	 * packets is refused.
+	 */
+	bool send(DataPacketsList* list) override;
+
+	bool is_send_done() override;
+
+	/**
+	 * Method : get_link_state
+	 * -------------------------------
+	 * the queued bytes are the frames the slowest consumer didn't read yet,
+	 * the unsent bytes the frame being copied.
+	 */
+	bool get_link_state(SenderLinkState* state) override;
+
+	bool is_reconnecting() override;
+
+	bool end_sender() override;
+
+	std::string get_error() override;
+
+	bool is_error() override;
+
+	~ShmSender();
+
+};
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef SRC_TIMERS_SIMULATED_CLOCK_H
+#define SRC_TIMERS_SIMULATED_CLOCK_H
+
+#include <stdint.h>
+
+#include <atomic>
+
+#include "timers_utils.h"
+
+/**
+ * Class : SimulatedClock
+ * -------------------------------
+ * This clock will only move when it's slept on or advanced, so a system set
+ * with timers_utils::set_clock(1) runs hours of ticks in seconds: each sleep
+ * of the timer or of the tolerance returns at once with the clock moved by
+ * the sleep time.
+ * each read moves the clock by the read cost too, so the busy waits of
+ * BusyWaitTimer and WorstCaseTimer end, a FreeWaitTimer sleeps once per tick
+ * and is the fastest to simulate.
+ * the work of the user function or of a sender is simulated by calling
+ * advance(1) or by a MockSender.
+ */
+class SimulatedClock final : public timers_utils::Clock{
+
+private:
+
+	//current time in nanoseconds
+	std::atomic<uint_fast64_t> now_ns_;
+
+	//time taken by each read
+	uint_fast64_t read_cost_ns_;
+
+public:
+
+	/**
+	 * Method : Constructor
+	 * -------------------------------
+	 * @param start_ns is the first time of the clock.
+	 */
+	SimulatedClock(uint_fast64_t start_ns = SEC_TO_NS(1));
+
+	/**
+	 * Method : set_read_cost
+	 * -------------------------------
+	 * set the time each get_time(1) moves the clock, by default 1us.
+	 */
+	void set_read_cost(uint_fast64_t read_cost_ns);
+
+	/**
+	 * Method : advance
+	 * -------------------------------
+	 * move the clock forward.
+	 */
+	void advance(uint_fast64_t time_ns);
+
+	/**
+	 * Method : now
+	 * -------------------------------
+	 * @return the current time in nanoseconds, the clock doesn't move.
+	 */
+	uint_fast64_t now();
+
+	void get_time(timespec* time) override;
+
+	void sleep(uint_fast64_t sleep_time_ns) override;
+
+	~SimulatedClock();
+
+};
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef SRC_UTILS_SOCKET_UTILS_H
+#define SRC_UTILS_SOCKET_UTILS_H
+
+#include <stdint.h>
+
+#include "flags.h"
+#include "sender.h"
+
+namespace socket_utils{
+
+	/**
+	 * Function : get_tcp_link_state
+	 * -------------------------------
+	 * fill the state from SIOCOUTQ/SIOCOUTQNSD and TCP_INFO of the given
+	 * connected TCP socket.
+	 * @return true if filled, false if the socket can't be queried.
+	 */
+	bool get_tcp_link_state(int sock_fd, SenderLinkState* state);
+
+	/**
+	 * Function : tcp_send_buffer_size
+	 * -------------------------------
+	 * size the send buffer for a stream of frame_bytes at frequency over a
+	 * link with rtt_us round trip time, it holds the bandwidth-delay product
+	 * plus two frames (one queued and one being sent), clamped between
+	 * TCP_SENDER_MIN_SEND_BUFFER and TCP_SENDER_MAX_SEND_BUFFER.
+	 */
+	int tcp_send_buffer_size(uint_fast32_t frame_bytes, uint_fast16_t frequency, uint_fast32_t rtt_us);
+
+	/**
+	 * Function : accept_client
+	 * -------------------------------
+	 * wait up to timeout_ms for a client on the listening socket and accept it.
+	 * @param wake_fd is a descriptor ending the wait when readable, -1 for none.
+	 * @param timeout_ms is 0 to only take an already waiting client, -1 to
+	 * wait without a limit.
+	 * @param client_fd is set to the accepted socket.
+	 * @return true if a client is accepted, false otherwise.
+	 */
+	bool accept_client(int server_sock_fd, int wake_fd, int timeout_ms, int* client_fd);
+
+}
+
+#endif
@@ -0,0 +1,215 @@
+#ifndef SRC_SYSTEM_STREAM_RECORDING_H
+#define SRC_SYSTEM_STREAM_RECORDING_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "data_packets.h"
+#include "real_time_info.h"
+#include "error.h"
+
+/**
+ * The recording file holds a header then one record per frame given by the
+ * user function, all in the native byte order:
+ *     header : "RTDTREC1", flags (uint32, 1 if the payloads are kept),
+ *              frequency (uint32)
+ *     frame  : sequence number (uint32), skipped (uint32), packets (uint32),
+ *              the size of each packet (uint32 each), then the payload of
+ *              each packet if kept.
+ */
+
+#define STREAM_RECORDING_MAGIC	"RTDTREC1"
+#define STREAM_RECORDING_PAYLOADS	(1)
+
+/**
+ * Class : StreamRecorder
+ * -------------------------------
+ * This class will write the frames made by a user function to a recording
+ * file, the shape of each DataPacketsList (packets and their sizes) and
+ * optionally their payloads, file descriptor packets are read with pread(2).
+ * the user function is wrapped:
+ *     recorder.open("stream.rec", frequency, true);
+ *     system.set_user_data_fn([&](RealTimeInfo* info) {
+ *         DataPacketsList list = user_fn(info);
+ *         recorder.record(info, list);
+ *         return list;
+ *     });
+ * writing the payloads delays the user function, record on a system with
+ * enough tolerance or lookahead.
+ */
+class StreamRecorder{
+
+private:
+
+	Error error_handler_;
+
+	FILE* file_;
+
+	bool payloads_;
+
+	//buffer for the payload of the file descriptor packets
+	std::vector<char> fd_buffer_;
+
+	uint_fast32_t frames_;
+
+	//write the packet payload to the file
+	bool write_payload(const DataPacket& packet);
+
+public:
+
+	StreamRecorder();
+
+	/**
+	 * Method : open
+	 * -------------------------------
+	 * create the recording file.
+	 * @param frequency is the frequency of the system, the replay cadence.
+	 * @param payloads is true to keep the payloads, false for the sizes only.
+	 * @return true if the file is created, false otherwise.
+	 * when false is returned the error_handler_ will be set accordingly.
+	 */
+	bool open(const char* path, uint_fast16_t frequency, bool payloads);
+
+	/**
+	 * Method : record
+	 * -------------------------------
+	 * add the frame made by the user function for info.
+	 * @return true if written, false otherwise.
+	 * when false is returned the error_handler_ will be set accordingly.
+	 */
+	bool record(RealTimeInfo* info, const DataPacketsList& list);
+
+	/**
+	 * Method : close
+	 * -------------------------------
+	 * flush and close the file.
+	 * @return true if all the frames are written, false otherwise.
+	 */
+	bool close();
+
+	/**
+	 * Method : get_frames
+	 * -------------------------------
+	 * @return the number of recorded frames.
+	 */
+	uint_fast32_t get_frames();
+
+	std::string get_error();
+
+	bool is_error();
+
+	~StreamRecorder();
+
+};
+
+/**
+ * Class : StreamReplayer
+ * -------------------------------
+ * This class will load a recording file and give its frames back as a user
+ * function, frame n at the tick n, with the same packets and sizes and the
+ * recorded payloads (or a fixed pattern when only the sizes were kept).
+ * the whole recording is held in memory, so the replay doesn't read the
+ * disk. the system is stopped after the last frame unless looping.
+ *     replayer.load("stream.rec");
+ *     system.set_frequency(replayer.get_frequency());
+ *     system.set_user_data_fn([&](RealTimeInfo* info) {
+ *         return replayer.next_frame(info);
+ *     });
+ */
+class StreamReplayer{
+
+private:
+
+	Error error_handler_;
+
+	struct RecordedFrame{
+		uint_fast32_t sequence_number;
+		bool skipped;
+		//first packet in sizes_ and first byte in payloads_
+		size_t first_packet;
+		uint_fast32_t num_packets;
+		size_t first_byte;
+	};
+
+	std::vector<RecordedFrame> frames_;
+	std::vector<uint_fast32_t> sizes_;
+	std::vector<char> payloads_;
+
+	//the payload of all the packets when only the sizes were kept
+	std::vector<char> pattern_;
+
+	uint_fast16_t frequency_;
+	bool has_payloads_;
+	bool loop_;
+
+public:
+
+	StreamReplayer();
+
+	/**
+	 * Method : load
+	 * -------------------------------
+	 * read a recording file.
+	 * @return true if read, false if the file can't be read or is not a
+	 * complete recording.
+	 * when false is returned the error_handler_ will be set accordingly.
+	 */
+	bool load(const char* path);
+
+	/**
+	 * Method : set_loop
+	 * -------------------------------
+	 * start again from the first frame after the last one instead of
+	 * stopping the system.
+	 */
+	void set_loop(bool loop);
+
+	/**
+	 * Method : next_frame
+	 * -------------------------------
+	 * the user function of the replay, the packets point to the memory of the
+	 * replayer and MUST NOT be written.
+	 * @return the recorded frame of the tick.
+	 */
+	DataPacketsList next_frame(RealTimeInfo* info);
+
+	/**
+	 * Method : get_frequency
+	 * -------------------------------
+	 * @return the frequency of the recorded system.
+	 */
+	uint_fast16_t get_frequency();
+
+	/**
+	 * Method : get_frames
+	 * -------------------------------
+	 * @return the number of recorded frames.
+	 */
+	uint_fast32_t get_frames();
+
+	/**
+	 * Method : get_frame_bytes
+	 * -------------------------------
+	 * @return the bytes of the recorded frame n.
+	 */
+	uint_fast64_t get_frame_bytes(uint_fast32_t n);
+
+	/**
+	 * Method : is_skipped_frame
+	 * -------------------------------
+	 * @return true if the frame n was skipped by the recorded system.
+	 */
+	bool is_skipped_frame(uint_fast32_t n);
+
+	std::string get_error();
+
+	bool is_error();
+
+	~StreamReplayer();
+
+};
+
+#endif
@@ -0,0 +1,200 @@
+#ifndef SRC_SYSTEM_STREAM_SCHEDULER_H
+#define SRC_SYSTEM_STREAM_SCHEDULER_H
+
+#include <sched.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#include <string>
+#include <vector>
+
+#include "flags.h"
+#include "error.h"
+#include "mutex_raii.h"
+#include "real_time_system.h"
+#include "thread_placement.h"
+#include "timers_utils.h"
+
+/**
+ * Struct : StreamStats
+ * -------------------------------
+ * This struct will hold the counters of a single stream hosted by the
+ * StreamScheduler.
+ */
+struct StreamStats{
+
+	//number of ticks handled (user function called)
+	uint_fast64_t ticks = 0;
+
+	//number of ticks which data handed to the sender
+	uint_fast64_t sent = 0;
+
+	//number of ticks which data skipped
+	uint_fast64_t skipped = 0;
+
+	//number of ticks handled after their time slot ended, or dropped
+	//without calling the user function since the next slot already started
+	uint_fast64_t missed = 0;
+
+	//worst delay between the tick time and the time it got handled
+	uint_fast64_t max_wake_delay_ns = 0;
+};
+
+/**
+ * Class : StreamScheduler
+ * -------------------------------
+ * This class will run several RealTimeSystem objects (streams) in the same
+ * process on a shared set of real time threads instead of a timer loop per
+ * system. each stream keeps its own sender, user function, frequency,
+ * tolerance and skip mode, the timer of the streams is not used.
+ * the ready ticks are handled by earliest deadline first, the deadline of a
+ * tick is the end of its time slot, or the end of its tolerance while its
+ * sender is still sending the last data.
+ * unlike RealTimeSystem::run(0) a tick handled after its time slot does not
+ * end the stream, it is counted as missed in the stream stats.
+ */
+class StreamScheduler{
+
+private:
+
+	//the scheduling state of a single stream
+	struct Stream{
+		RealTimeSystem* system;
+		//the time slot of the stream in picoseconds
+		uint_fast64_t period_ps;
+		//the time of tick number 0, and the number of the next tick
+		uint_fast64_t start_ns;
+		uint_fast32_t tick_counter;
+		//the time of the next tick
+		uint_fast64_t release_ns;
+		//when the stream needs to be checked again and its deadline
+		uint_fast64_t event_ns;
+		uint_fast64_t deadline_ns;
+		//the sender didn't finish the last data at the tick time
+		bool waiting_sender;
+		//a thread is handling the stream
+		bool busy;
+		//the stream stopped or failed
+		bool ended;
+		bool failed;
+		StreamStats stats;
+	};
+
+	//the hosted streams
+	std::vector<Stream> streams_;
+
+	//the cores, priority and NUMA node of the scheduler threads
+	ThreadPlacement placement_;
+
+	//number of the scheduler threads including the one calling run(0)
+	uint_fast16_t num_threads_;
+
+	//number of streams not ended yet
+	uint_fast32_t active_streams_;
+
+	//mutex protecting the streams state, condition to wake the idle threads
+	//when a stream state changes
+	pthread_mutex_t streams_mutex_;
+	pthread_cond_t streams_cond_;
+
+	//error handler class
+	Error error_handler_;
+
+	//is the object initialized
+	bool initialized_;
+
+	//the loop executed by each scheduler thread
+	void schedule_loop();
+	static void* thread_function(void* scheduler);
+
+	//handle an event of the stream at time now, called with the lock held
+	void process_stream(Stream& stream, uint_fast64_t now, MutexRAII& prot_lock);
+
+	//move the stream to its next tick
+	void next_tick(Stream& stream);
+
+public:
+
+	StreamScheduler();
+
+	/**
+	 * Method : add_stream
+	 * -------------------------------
+	 * The method will add a stream to the scheduler, the system must have its
+	 * sender, user function and frequency set, its timer and placement are
+	 * not used.
+	 * @param system is the pointer to the constructed system object.
+	 * @return true if successful, false otherwise.
+	 */
+	bool add_stream(RealTimeSystem* system);
+
+	/**
+	 * Method : set_placement
+	 * -------------------------------
+	 * The method will set where the scheduler threads run, by default they
+	 * run on CPU_CORE_AFFINITY with priority 99.
+	 * @return true if the placement is valid, false otherwise.
+	 */
+	bool set_placement(const ThreadPlacement& placement);
+
+	/**
+	 * Method : set_threads
+	 * -------------------------------
+	 * The method will set the number of threads handling the ticks, including
+	 * the thread calling run(0), by default 1.
+	 * @return true if num_threads is between 1 and the number of streams
+	 * (checked in initialize(0)), false otherwise.
+	 */
+	bool set_threads(uint_fast16_t num_threads);
+
+	/**
+	 * Method : initialize
+	 * -------------------------------
+	 * The method will convert the calling thread to real time one and
+	 * initialize the sender of each stream in the order they were added.
+	 * @return true if everything goes fine, false otherwise.
+	 */
+	bool initialize();
+
+	/**
+	 * Method : run
+	 * -------------------------------
+	 * The method will start all the streams in the exact time of calling and
+	 * return when all of them stopped or failed.
+	 * @return true if all the streams stopped by their user functions, false
+	 * if any of them failed, the error of each stream can be pulled from its
+	 * system object.
+	 */
+	bool run();
+
+	/**
+	 * Method : get_stream_stats
+	 * -------------------------------
+	 * The method will copy the counters of the stream, can be called while
+	 * the scheduler is running.
+	 * @param index is the order of the stream in add_stream(1) calls.
+	 * @return true if the stream existed, false otherwise.
+	 */
+	bool get_stream_stats(uint_fast32_t index, StreamStats* stats);
+
+	/**
+	 * Method : get_error
+	 * -------------------------------
+	 * @return the error string if an error occurs and the error will be removed
+	 * after this call, if no error occurs, it return empty string ("").
+	 */
+	std::string get_error();
+
+	/**
+	 * Method : is_error
+	 * -------------------------------
+	 * Check if an error existed.
+	 * @return true if an error occurs, false otherwise.
+	 */
+	bool is_error();
+
+	~StreamScheduler();
+
+};
+
+#endif
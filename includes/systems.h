@@ -1 +1,6 @@
-#include "real_time_system.h"
\ No newline at end of file
+#include "real_time_info.h"
+#include "frame_queue.h"
+#include "real_time_system_t.h"
+#include "real_time_system.h"
+#include "stream_scheduler.h"
+#include "stream_recording.h"
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include <iostream>
 #include <string>
+#include <algorithm>
 
 #include <stdint.h>
 #include <limits.h>
@@ -10,25 +11,165 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/eventfd.h>
 #include <errno.h>
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <netdb.h>
 #include <arpa/inet.h>
 #include <sys/wait.h>
 #include <signal.h>
 #include <sys/sendfile.h>
+#include <poll.h>
 
 #include "flags.h"
 #include "sender.h"
 #include "tcp_sender.h"
 #include "error.h"
 #include "data_packets.h"
+#include "frame_header.h"
+#include "socket_utils.h"
+#include "link_scheduler.h"
 #include "mutex_raii.h"
 #include "atomic_val_raii.h"
 #include "timers_utils.h"
+#include "trace_events.h"
+#include "probes.h"
 
+/**
+ * Class : TCPWritePath
+ * -------------------------------
+ * This class will write the frames of a TCPSender to the socket of its
+ * client, the worker thread calls it for the steps where the TCP senders
+ * differ in the way the data reaches the socket, the server, the clients
+ * and the worker loop stay in TCPSender.
+ * this one copies the memory packets with send(2) and gives the packets
+ * back once their frame is written.
+ */
+class TCPWritePath{
+
+protected:
+
+	//error handler class, the sender reads it once the worker ended
+	Error error_handler_;
+
+public:
+
+	TCPWritePath(std::string owner_identifier = "TCPSender");
+
+	/**
+	 * Method : open
+	 * -------------------------------
+	 * prepare the writes when the worker starts.
+	 * @return true if done, false if the worker must end (the error is set).
+	 */
+	virtual bool open(SenderWorkerData* shared_data);
+
+	/**
+	 * Method : client_opened
+	 * -------------------------------
+	 * prepare the socket of a new client, once its options are set.
+	 * @return true if done, false if the client can't be used (the error is
+	 * set).
+	 */
+	virtual bool client_opened(SenderWorkerData* shared_data);
+
+	/**
+	 * Method : close
+	 * -------------------------------
+	 * give back what the path holds when the worker ends, called without
+	 * the packets lock, even if open(1) wasn't called or failed.
+	 */
+	virtual void close(SenderWorkerData* shared_data);
+
+	/**
+	 * Method : wait_packets
+	 * -------------------------------
+	 * wait on the packets condition for the next frame, called with the
+	 * packets lock which must be held again on return, it may return before
+	 * a frame arrives.
+	 */
+	virtual void wait_packets(SenderWorkerData* shared_data);
+
+	/**
+	 * Method : write_header
+	 * -------------------------------
+	 * copy up to size bytes of the frame header to the socket.
+	 * @return the bytes written, -1 if the socket failed.
+	 */
+	virtual ssize_t write_header(SenderWorkerData* shared_data, const char* data, uint_fast32_t size);
+
+	/**
+	 * Method : write_memory
+	 * -------------------------------
+	 * write up to size bytes of a memory packet to the socket, more is true
+	 * if more data of the frame follows.
+	 * @return the bytes written, -1 if the socket failed, 0 if the worker
+	 * must end (the error is set).
+	 */
+	virtual ssize_t write_memory(SenderWorkerData* shared_data, const char* data, uint_fast32_t size, bool more);
+
+	/**
+	 * Method : file_written
+	 * -------------------------------
+	 * count the bytes of a file packet the worker wrote with sendfile(2).
+	 */
+	virtual void file_written(ssize_t bytes);
+
+	/**
+	 * Method : frame_written
+	 * -------------------------------
+	 * take the packets of a frame once all of it is written to the socket,
+	 * this one gives them back at once.
+	 * @return true if done, false if the client is lost or the worker must
+	 * end (the error is set), the packets are left in the frame.
+	 */
+	virtual bool frame_written(SenderWorkerData* shared_data, DataPacketsList* frame);
+
+	/**
+	 * Method : client_closed
+	 * -------------------------------
+	 * drop what was written to the lost or replaced client, called before
+	 * its socket is closed.
+	 * @return true if done, false if the worker must end (the error is set).
+	 */
+	virtual bool client_closed(SenderWorkerData* shared_data);
+
+	/**
+	 * Method : get_error
+	 * -------------------------------
+	 * @return the error which ended the worker, the error is cleared.
+	 */
+	std::string get_error();
+
+	virtual ~TCPWritePath();
+
+};
+
+/**
+ * Struct : TCPWorkerData
+ * -------------------------------
+ * This struct will be given to the worker thread of a TCPSender, the data
+ * shared with the sender and the way the frames are written.
+ */
+struct TCPWorkerData{
+	SenderWorkerData* shared_data = NULL;
+	TCPWritePath* write_path = NULL;
+	std::string thread_name;
+};
+
+/**
+ * Class : TCPSender
+ * -------------------------------
+ * This class will stream the frames to a TCP client from a worker thread,
+ * the memory packets are copied to the socket.
+ * the senders deriving from it only change the way the frames are written
+ * (TCPWritePath), the Sender methods are final so RealTimeSystemT calls
+ * them directly.
+ */
 class TCPSender : public Sender{
 
 private:
@@ -46,12 +187,44 @@ private:
 	//The data which is shared between this class and it's worker thread
 	SenderWorkerData shared_data_;
 
+	//the way the worker writes the frames, owned by the sender
+	TCPWritePath* write_path_;
+	TCPWorkerData worker_data_;
+
 	//error handler class
 	Error error_handler_;
 
 	//initialized?
 	bool initialized_;
 
+	//stream profile used to size the socket buffers, 0 to use the defaults
+	uint_fast32_t auto_frame_bytes_;
+	uint_fast16_t auto_frequency_;
+	bool limit_unsent_;
+
+	//cores, priority and NUMA node of the worker thread
+	ThreadPlacement worker_placement_;
+
+	//the link shared with other senders, its per tick budget and weight
+	LinkScheduler* link_;
+	uint_fast32_t link_budget_;
+	uint_fast16_t link_weight_;
+
+	//keep the server open and replace the lost client
+	bool reconnect_;
+
+	//the worker accepts the first client instead of initialize(0)
+	bool async_accept_;
+
+	//the worker accounts the usage of each frame
+	bool usage_accounting_;
+
+	//the worker counts the perf events of each frame
+	bool perf_counters_;
+
+	//the worker thread was created and not joined yet
+	bool worker_running_;
+
 	//create the server and set server_sock_fd_ to the server fd
 	//returns true if every thing runs correctly, false otherwise
 	//when false is returned the error_handler_ will be set accordingly.
@@ -62,21 +235,135 @@ private:
 	//set accordingly and true will be returned, else false is returned.
 	bool get_client();
 
+protected:
+
+	//a sender writing the frames through write_path, which it deletes,
+	//name is used for the errors and the worker thread
+	TCPSender(uint_fast16_t port, TCPWritePath* write_path, std::string name);
+
 public:
 
 	TCPSender(uint_fast16_t port);
 
-	bool initialize() override;
+	/**
+	 * Method : set_frame_crc
+	 * -------------------------------
+	 * send a FrameHeader holding the frame size and its crc32c before each
+	 * list of packets, receivers check the frames with frame_header::verify.
+	 * must be called before initialize(0), disabled by default.
+	 */
+	void set_frame_crc(bool enabled);
+
+	/**
+	 * Method : set_auto_buffers
+	 * -------------------------------
+	 * size the socket send buffer at connect time from the bandwidth-delay
+	 * product of the stream (frame_bytes * frequency * measured rtt) instead
+	 * of TCP_SENDER_SEND_BUFFER.
+	 * if limit_unsent is true, TCP_NOTSENT_LOWAT is set to frame_bytes so the
+	 * queued but not sent data never exceeds one tick, the send is marked done
+	 * only after the rest of the frame fits under that limit.
+	 * must be called before initialize(0), frame_bytes = 0 disables it.
+	 */
+	void set_auto_buffers(uint_fast32_t frame_bytes, uint_fast16_t frequency, bool limit_unsent);
+
+	/**
+	 * Method : set_worker_placement
+	 * -------------------------------
+	 * set where the worker thread runs, by default it runs on CPU_CORE_AFFINITY
+	 * with priority 98, the numa_node makes its allocations prefer that node.
+	 * must be called before initialize(0).
+	 * @return true if the placement is valid, false otherwise.
+	 */
+	bool set_worker_placement(const ThreadPlacement& placement);
+
+	/**
+	 * Method : set_link_scheduler
+	 * -------------------------------
+	 * share the link with the other senders using the same scheduler, the
+	 * worker writes the frames in chunks and waits for its turn before each
+	 * chunk, see LinkScheduler.
+	 * @param tick_budget is the bytes this stream sends each tick, 0 for no limit.
+	 * @param weight is the number of chunks written in each round (>= 1).
+	 * must be called before initialize(0), NULL link to stop sharing.
+	 * @return true if the weight is valid, false otherwise.
+	 */
+	bool set_link_scheduler(LinkScheduler* link, uint_fast32_t tick_budget, uint_fast16_t weight);
+
+	/**
+	 * Method : set_reconnect
+	 * -------------------------------
+	 * keep the server open after the first client connects, when the client
+	 * is lost the worker drops the frame and waits for a new client while the
+	 * system skips the ticks (skip mode must be enabled), a client connecting
+	 * while the current one is still alive replaces it at the next frame.
+	 * must be called before initialize(0), disabled by default.
+	 */
+	void set_reconnect(bool enabled);
+
+	/**
+	 * Method : set_async_accept
+	 * -------------------------------
+	 * let initialize(0) return once the server listens, the worker accepts
+	 * the first client in the background while the system skips the ticks
+	 * (skip mode must be enabled), the sender reports is_reconnecting(0)
+	 * until the client connects.
+	 * must be called before initialize(0), disabled by default.
+	 */
+	void set_async_accept(bool enabled);
+
+	/**
+	 * Method : set_usage_accounting
+	 * -------------------------------
+	 * sample the cpu time, context switches and page faults of the worker
+	 * thread around each frame, a frame with a preemption or a page fault is
+	 * flagged in the stats and in the trace events.
+	 * must be called before initialize(0), disabled by default.
+	 */
+	void set_usage_accounting(bool enabled);
+
+	/**
+	 * Method : get_worker_usage_stats
+	 * -------------------------------
+	 * give the usage of the frames sent by the worker since initialize(0),
+	 * it can be called while sending.
+	 */
+	void get_worker_usage_stats(ThreadUsageStats* stats);
+
+	/**
+	 * Method : set_perf_counters
+	 * -------------------------------
+	 * open the perf counters (cycles, instructions, cache misses, task
+	 * clock...) of the worker thread when it starts, they are read around
+	 * each sent frame with its bytes, the kernel time of the sends included
+	 * if allowed. the counters the machine doesn't provide are left out.
+	 * must be called before initialize(0), disabled by default.
+	 */
+	void set_perf_counters(bool enabled);
+
+	/**
+	 * Method : get_worker_perf_stats
+	 * -------------------------------
+	 * give the counters of the frames sent by the worker since
+	 * initialize(0), it can be called while sending.
+	 */
+	void get_worker_perf_stats(PerfCounterStats* stats);
+
+	bool initialize() final;
+
+	bool send(DataPacketsList* list) final;
+
+	bool is_send_done() final;
 
-	bool send(DataPacketsList* list) override;
+	bool get_link_state(SenderLinkState* state) final;
 
-	bool is_send_done() override;
+	bool is_reconnecting() final;
 
-	bool end_sender() override;
+	bool end_sender() final;
 
-	std::string get_error() override;
+	std::string get_error() final;
 
-	bool is_error() override;
+	bool is_error() final;
 
 	~TCPSender();
 
@@ -0,0 +1,117 @@
+#ifndef SRC_SENDERS_TCP_SENDER_SPLICE_H_
+#define SRC_SENDERS_TCP_SENDER_SPLICE_H_
+
+#include <string>
+#include <deque>
+#include <algorithm>
+
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/ioctl.h>
+#include <linux/sockios.h>
+
+#include "flags.h"
+#include "tcp_sender.h"
+#include "data_packets.h"
+#include "timers_utils.h"
+#include "trace_events.h"
+
+/**
+ * Class : TCPSpliceWritePath
+ * -------------------------------
+ * This class will write the memory packets of a TCPSenderSplice without
+ * copying them: their pages are mapped into a pipe with vmsplice(2) and
+ * moved to the socket with splice(2), the frame header is copied.
+ * the packets of a frame are given back once the peer acknowledged all its
+ * bytes (SIOCOUTQ), checked each millisecond while the worker waits for the
+ * next frame.
+ */
+class TCPSpliceWritePath final : public TCPWritePath{
+
+private:
+
+	//a frame spliced to the socket, its pages are still used by the socket
+	//until the peer acknowledged the byte end_byte of the stream
+	struct PendingFrame{
+		DataPacketsList packets;
+		uint_fast64_t end_byte;
+	};
+
+	//the pipe the pages go through and its size
+	int pipe_fds_[2];
+	uint_fast32_t pipe_size_;
+
+	//bytes written to the socket of the current client
+	uint_fast64_t written_bytes_;
+
+	//the frames not acknowledged yet and the acknowledged ones to give back
+	std::deque<PendingFrame> pending_;
+	std::deque<PendingFrame> acked_;
+
+	//create the pipe, as big as allowed up to TCP_SENDER_SPLICE_PIPE_SIZE
+	bool open_pipe();
+
+	void close_pipe();
+
+	//move the frames the peer acknowledged to acked_
+	void take_acked(SenderWorkerData* shared_data);
+
+	//give back the packets of the frames
+	void release_frames(std::deque<PendingFrame>* frames);
+
+public:
+
+	TCPSpliceWritePath();
+
+	bool open(SenderWorkerData* shared_data) override;
+
+	void close(SenderWorkerData* shared_data) override;
+
+	void wait_packets(SenderWorkerData* shared_data) override;
+
+	ssize_t write_header(SenderWorkerData* shared_data, const char* data, uint_fast32_t size) override;
+
+	ssize_t write_memory(SenderWorkerData* shared_data, const char* data, uint_fast32_t size, bool more) override;
+
+	void file_written(ssize_t bytes) override;
+
+	bool frame_written(SenderWorkerData* shared_data, DataPacketsList* frame) override;
+
+	bool client_closed(SenderWorkerData* shared_data) override;
+
+	~TCPSpliceWritePath();
+
+};
+
+/**
+ * Class : TCPSenderSplice
+ * -------------------------------
+ * This class is a TCPSender which doesn't copy the memory packets to the
+ * socket: the worker maps their pages into a pipe with vmsplice(2) and moves
+ * them to the socket with splice(2), so the send is done without waiting for
+ * the MSG_ZEROCOPY completions of TCPSenderZC.
+ * the socket keeps references to the user pages until the peer acknowledges
+ * the data, the buffers are given back through the release function of the
+ * packets once all their bytes are acknowledged (SIOCOUTQ), use a
+ * FrameBufferPool or another release function to reuse the buffers, memory
+ * without a release function must not be written again while it is sent.
+ * on the loopback the receiver reads the same pages, so the data is only
+ * safe to write once the receiver read it.
+ * the frame header and the file descriptor packets are copied as TCPSender
+ * does, page aligned buffers avoid sharing the first and last page with
+ * other data.
+ */
+class TCPSenderSplice final : public TCPSender{
+
+public:
+
+	TCPSenderSplice(uint_fast16_t port);
+
+};
+
+#endif
\ No newline at end of file
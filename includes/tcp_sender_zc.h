@@ -1,89 +1,68 @@
 #ifndef SRC_SENDERS_TCP_SENDER_ZEROCOPY_H_
 #define SRC_SENDERS_TCP_SENDER_ZEROCOPY_H_
 
-#include <iostream>
 #include <string>
 
 #include <stdint.h>
-#include <limits.h>
 #include <string.h>
-#include <stdio.h>
-#include <stdlib.h>
 #include <unistd.h>
 #include <errno.h>
 #include <sys/types.h>
-#include <sys/msg.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
-#include <netdb.h>
-#include <arpa/inet.h>
-#include <sys/wait.h>
-#include <signal.h>
-#include <sys/sendfile.h>
 #include <poll.h>
-#include <mqueue.h>
 #include <linux/errqueue.h>
 
 #include "flags.h"
-#include "sender.h"
 #include "tcp_sender.h"
-#include "error.h"
 #include "data_packets.h"
-#include "mutex_raii.h"
-#include "atomic_val_raii.h"
-#include "timers_utils.h"
-
-class TCPSenderZC : public Sender{
+#include "trace_events.h"
+#include "probes.h"
+
+/**
+ * Class : TCPZeroCopyWritePath
+ * -------------------------------
+ * This class will write the memory packets of a TCPSenderZC with
+ * MSG_ZEROCOPY, the kernel sends them from the user pages and tells on the
+ * error queue of the socket when it is done with them, a frame is written
+ * once all its sends are completed and its packets are given back then.
+ */
+class TCPZeroCopyWritePath final : public TCPWritePath{
 
 private:
 
-	//The port with which we will start a server
-	uint_fast16_t port_;
+	//the zero copy sends made to the socket of the client and the ones the
+	//kernel completed
+	uint_fast32_t sends_;
+	uint_fast32_t completed_sends_;
+
+public:
 
-	//The socket file descriptor of the client to stream data to and the current server
-	int server_sock_fd_;
-	int client_sock_fd_;
+	TCPZeroCopyWritePath();
 
-	//The thread where the actual transmission will happen in
-	pthread_t worker_thread_;
+	bool client_opened(SenderWorkerData* shared_data) override;
 
-	//The data which is shared between this class and it's worker thread
-	SenderWorkerData shared_data_;
+	ssize_t write_memory(SenderWorkerData* shared_data, const char* data, uint_fast32_t size, bool more) override;
 
-	//error handler class
-	Error error_handler_;
+	bool frame_written(SenderWorkerData* shared_data, DataPacketsList* frame) override;
 
-	//initialized?
-	bool initialized_;
+	bool client_closed(SenderWorkerData* shared_data) override;
 
-	//create the server and set server_sock_fd_ to the server fd
-	//returns true if every thing runs correctly, false otherwise
-	//when false is returned the error_handler_ will be set accordingly.
-	bool create_server();
+};
 
-	//this function will wait for a client,
-	//if the client succeeded to connect the client_sock_fd_ will be
-	//set accordingly and true will be returned, else false is returned.
-	bool get_client();
+/**
+ * Class : TCPSenderZC
+ * -------------------------------
+ * This class is a TCPSender which sends the memory packets with
+ * MSG_ZEROCOPY instead of copying them to the socket, the send is done
+ * once the kernel completed the sends of the frame.
+ */
+class TCPSenderZC final : public TCPSender{
 
 public:
 
 	TCPSenderZC(uint_fast16_t port);
 
-	bool initialize() override;
-
-	bool send(DataPacketsList* list) override;
-
-	bool is_send_done() override;
-
-	bool end_sender() override;
-
-	std::string get_error() override;
-
-	bool is_error() override;
-
-	~TCPSenderZC();
-
 };
 
 #endif
\ No newline at end of file
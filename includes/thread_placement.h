@@ -0,0 +1,98 @@
+#ifndef SRC_UTILS_THREAD_PLACEMENT_H
+#define SRC_UTILS_THREAD_PLACEMENT_H
+
+#include <stdint.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#include <string>
+
+#include "flags.h"
+#include "error.h"
+
+/**
+ * Struct : ThreadPlacement
+ * -------------------------------
+ * This struct will hold where a real time thread runs: the cores it may
+ * run on, its SCHED_FIFO priority and the NUMA node its memory allocations
+ * are preferred from.
+ */
+struct ThreadPlacement{
+
+	//cores the thread may run on
+	cpu_set_t cpus;
+
+	//SCHED_FIFO priority of the thread (1 - 99)
+	int priority;
+
+	//preferred NUMA node for the thread allocations, -1 to keep the default
+	int numa_node;
+
+	//constructor, single core placement
+	ThreadPlacement(int cpu = CPU_CORE_AFFINITY, int priority_ = 99, int numa_node_ = -1) {
+		CPU_ZERO(&cpus);
+		CPU_SET(cpu, &cpus);
+		priority = priority_;
+		numa_node = numa_node_;
+	}
+
+	//add a core to the allowed cores
+	void add_cpu(int cpu) {
+		CPU_SET(cpu, &cpus);
+	}
+
+	//remove all the allowed cores
+	void clear_cpus() {
+		CPU_ZERO(&cpus);
+	}
+};
+
+namespace thread_placement{
+
+	/**
+	 * Function : is_valid
+	 * -------------------------------
+	 * @return true if the placement has at least one core and valid priority.
+	 */
+	bool is_valid(const ThreadPlacement& placement);
+
+	/**
+	 * Function : set_affinity
+	 * -------------------------------
+	 * stick the calling thread to the placement cores.
+	 * @return true if done, false otherwise.
+	 */
+	bool set_affinity(const ThreadPlacement& placement);
+
+	/**
+	 * Function : set_memory_node
+	 * -------------------------------
+	 * prefer the placement NUMA node for the future allocations of the calling
+	 * thread, nothing is done if numa_node is -1.
+	 * @return true if done, false otherwise.
+	 */
+	bool set_memory_node(const ThreadPlacement& placement);
+
+	/**
+	 * Function : other_cores
+	 * -------------------------------
+	 * @return a placement with the given priority on the online cores which
+	 * are not cores of placement, on the cores of placement if there is no
+	 * other core.
+	 */
+	ThreadPlacement other_cores(const ThreadPlacement& placement, int priority);
+
+	/**
+	 * Function : make_real_time
+	 * -------------------------------
+	 * lock the process memory, then make the calling thread a SCHED_FIFO
+	 * thread with the placement priority, cores and memory node.
+	 * @return true if done, false otherwise with the error set in
+	 * error_handler.
+	 */
+	bool make_real_time(const ThreadPlacement& placement, Error* error_handler);
+
+}
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef SRC_UTILS_THREAD_USAGE_H
+#define SRC_UTILS_THREAD_USAGE_H
+
+#include <stdint.h>
+
+#include <atomic>
+
+//flags of a sampled interval
+#define THREAD_USAGE_PREEMPTED (1)
+#define THREAD_USAGE_FAULTED (2)
+
+/**
+ * Struct : ThreadUsageStats
+ * -------------------------------
+ * This struct will hold the resources used by a thread in its sampled
+ * intervals (the ticks of a system, the frames of a sender worker).
+ */
+struct ThreadUsageStats{
+
+	//number of sampled intervals
+	uint_fast64_t intervals = 0;
+
+	//cpu time of the thread in the intervals, and the most in one interval
+	uint_fast64_t cpu_ns = 0;
+	uint_fast64_t max_interval_cpu_ns = 0;
+
+	//context switches in the intervals, the involuntary ones are preemptions
+	uint_fast64_t voluntary_switches = 0;
+	uint_fast64_t involuntary_switches = 0;
+
+	//page faults in the intervals
+	uint_fast64_t minor_faults = 0;
+	uint_fast64_t major_faults = 0;
+
+	//intervals with at least one involuntary context switch
+	uint_fast64_t preempted_intervals = 0;
+
+	//intervals with at least one page fault
+	uint_fast64_t faulted_intervals = 0;
+
+	//value given to the last flagged interval, -1 if none
+	int_fast64_t last_flagged = -1;
+};
+
+/**
+ * Class : ThreadUsage
+ * -------------------------------
+ * This class will account the cpu time (CLOCK_THREAD_CPUTIME_ID), context
+ * switches and page faults (getrusage(RUSAGE_THREAD)) of a thread between
+ * begin(0) and end(1), an interval with a preemption or a page fault is
+ * flagged in the stats and as an instant in the trace events.
+ * it's disabled by default and then begin(0) and end(1) cost a load, when
+ * enabled each costs a clock read and a getrusage(2) call.
+ * begin(0) and end(1) are called by the sampled thread only, the stats can
+ * be read by any thread.
+ */
+class ThreadUsage{
+
+private:
+
+	std::atomic<bool> enabled_;
+
+	//sample taken by begin(0), valid if started_
+	bool started_;
+	uint_fast64_t start_cpu_ns_;
+	uint_fast64_t start_voluntary_;
+	uint_fast64_t start_involuntary_;
+	uint_fast64_t start_minor_;
+	uint_fast64_t start_major_;
+
+	std::atomic<uint_fast64_t> intervals_;
+	std::atomic<uint_fast64_t> cpu_ns_;
+	std::atomic<uint_fast64_t> max_interval_cpu_ns_;
+	std::atomic<uint_fast64_t> voluntary_switches_;
+	std::atomic<uint_fast64_t> involuntary_switches_;
+	std::atomic<uint_fast64_t> minor_faults_;
+	std::atomic<uint_fast64_t> major_faults_;
+	std::atomic<uint_fast64_t> preempted_intervals_;
+	std::atomic<uint_fast64_t> faulted_intervals_;
+	std::atomic<int_fast64_t> last_flagged_;
+
+public:
+
+	ThreadUsage();
+
+	/**
+	 * Method : set_enabled
+	 * -------------------------------
+	 * start or stop the accounting, MUST NOT be called between begin(0) and
+	 * end(1).
+	 */
+	void set_enabled(bool enabled);
+
+	/**
+	 * Method : is_enabled
+	 * -------------------------------
+	 * @return true if the intervals are sampled.
+	 */
+	bool is_enabled();
+
+	/**
+	 * Method : begin
+	 * -------------------------------
+	 * sample the calling thread at the start of an interval.
+	 */
+	void begin();
+
+	/**
+	 * Method : end
+	 * -------------------------------
+	 * sample the calling thread at the end of the interval and add it to
+	 * the stats.
+	 * @param value is kept as last_flagged if the interval is flagged (the
+	 * sequence number of the tick or frame).
+	 * @return THREAD_USAGE_PREEMPTED and/or THREAD_USAGE_FAULTED if the thread
+	 * was preempted or faulted in the interval, 0 otherwise.
+	 */
+	uint_fast8_t end(int_fast64_t value);
+
+	/**
+	 * Method : get_stats
+	 * -------------------------------
+	 * copy the stats, the counters are read one by one while the thread may
+	 * still add an interval.
+	 */
+	void get_stats(ThreadUsageStats* stats);
+
+	/**
+	 * Method : reset
+	 * -------------------------------
+	 * clear the stats.
+	 */
+	void reset();
+
+};
+
+#endif
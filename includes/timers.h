@@ -3,3 +3,4 @@
 #include "free_wait_timer.h"
 #include "worst_case_timer.h"
 #include "timers_utils.h"
+#include "simulated_clock.h"
\ No newline at end of file
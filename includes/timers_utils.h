@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <time.h>
 #include <unistd.h>
+#include <sys/resource.h>
 
 namespace timers_utils{
 
@@ -58,9 +59,61 @@ namespace timers_utils{
 			timespec.tv_sec  += NS_TO_SEC(timespec.tv_nsec + (ns)); \
 			timespec.tv_nsec = ((timespec.tv_nsec + (ns)) % SEC_TO_NS(1))
 
+	/**
+	 * Class : Clock
+	 * -------------------------------
+	 * The source of the time and the sleeps used by the timers, the systems
+	 * and the sleep functions below, CLOCK_MONOTONIC and nanosleep(2) unless
+	 * another clock is set, see SimulatedClock.
+	 */
+	class Clock{
+
+	public:
+
+		/**
+		 * Method : get_time
+		 * -------------------------------
+		 * @param time is set to the current time of the clock.
+		 */
+		virtual void get_time(timespec* time) = 0;
+
+		/**
+		 * Method : sleep
+		 * -------------------------------
+		 * return after at least sleep_time_ns of the clock.
+		 */
+		virtual void sleep(uint_fast64_t sleep_time_ns) = 0;
+
+		virtual ~Clock() {};
+
+	};
+
+	/**
+	 * functions : Clock selection
+	 * -------------------------------
+	 * set_clock(1) replaces the monotonic clock of the process, it MUST be
+	 * called while nothing measures the time, NULL sets the monotonic clock
+	 * back. monotonic_time(1) gives the time of the current clock,
+	 * monotonic_ns(0) gives it in nanoseconds.
+	 */
+
+	void set_clock(Clock* clock);
+	Clock* get_clock();
+	void monotonic_time(timespec* time);
+	uint_fast64_t monotonic_ns();
+
+	/**
+	 * function : cpu_time_ns
+	 * -------------------------------
+	 * @param who is RUSAGE_SELF or RUSAGE_THREAD, see getrusage(2).
+	 * @return the user and system cpu time used in nanoseconds.
+	 */
+	uint_fast64_t cpu_time_ns(int who);
+
 	/**
 	 * functions : Linux based sleep functions
 	 * -------------------------------
+	 * they sleep on the current clock.
 	 */
 
 	void nanoseconds_sleep(uint_fast64_t sleep_time_ns);
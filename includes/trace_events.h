@@ -0,0 +1,89 @@
+#ifndef SRC_UTILS_TRACE_EVENTS_H
+#define SRC_UTILS_TRACE_EVENTS_H
+
+#include <stdint.h>
+
+#include "flags.h"
+
+/**
+ * Struct : TraceEvent
+ * -------------------------------
+ * This struct will hold a single event of the timeline, the name MUST be a
+ * string literal (it's kept, not copied).
+ */
+struct TraceEvent{
+
+	//the phase as in the Chrome trace format: 'B' begin, 'E' end, 'i' instant
+	char phase;
+
+	//the thread of the event
+	uint32_t tid;
+
+	//CLOCK_MONOTONIC time of the event
+	uint_fast64_t time_ns;
+
+	const char* name;
+
+	//an argument of the event (a sequence number, bytes...)
+	int_fast64_t value;
+};
+
+namespace trace_events{
+
+	/**
+	 * Function : set_enabled
+	 * -------------------------------
+	 * start or stop the recording, it's stopped by default and then each
+	 * event costs one atomic load.
+	 * each thread records in its own ring of TRACE_EVENTS_PER_THREAD events,
+	 * the oldest events are overwritten, the ring is allocated with the first
+	 * event of the thread while recording, or by set_thread_name(1).
+	 */
+	void set_enabled(bool enabled);
+
+	/**
+	 * Function : is_enabled
+	 * -------------------------------
+	 * @return true if the events are recorded.
+	 */
+	bool is_enabled();
+
+	/**
+	 * Function : set_thread_name
+	 * -------------------------------
+	 * name the calling thread in the trace and allocate its ring if recording,
+	 * a real time thread calls it before its loop.
+	 */
+	void set_thread_name(const char* name);
+
+	/**
+	 * Functions : Events
+	 * -------------------------------
+	 * record an event of the calling thread, begin(1) and end(1) MUST be
+	 * nested in each thread.
+	 */
+	void begin(const char* name, int_fast64_t value = 0);
+	void end(const char* name);
+	void instant(const char* name, int_fast64_t value = 0);
+
+	/**
+	 * Function : dump
+	 * -------------------------------
+	 * write the events of all the threads to a Chrome trace JSON file, to be
+	 * opened by chrome://tracing or ui.perfetto.dev, the recording goes on.
+	 * the events recorded while dumping may replace a few of the oldest ones.
+	 * @param last_ns is the time kept before the newest event, 0 for all.
+	 * @return true if written, false if the file can't be written.
+	 */
+	bool dump(const char* path, uint_fast64_t last_ns = 0);
+
+	/**
+	 * Function : clear
+	 * -------------------------------
+	 * drop the recorded events, MUST NOT be called while recording.
+	 */
+	void clear();
+
+}
+
+#endif
@@ -0,0 +1,129 @@
+#ifndef SRC_UTILS_UNIX_CONSUMER_H
+#define SRC_UTILS_UNIX_CONSUMER_H
+
+#include <stdint.h>
+
+#include <string>
+
+#include "error.h"
+#include "unix_frame.h"
+
+/**
+ * Struct : UnixFrame
+ * -------------------------------
+ * This struct will hold a frame received from a UnixSender, the data is a
+ * read only mapping of the sealed memfd of the frame, it stays valid until
+ * release_frame(1) whatever the sender does.
+ */
+struct UnixFrame{
+
+	//number of the frame since the sender initialized, from 1
+	uint64_t sequence = 0;
+
+	//CLOCK_MONOTONIC time the frame was passed
+	uint64_t timestamp_ns = 0;
+
+	//the packets back to back
+	const char* data = NULL;
+	uint32_t size = 0;
+
+	//the size of each packet
+	uint32_t num_packets = 0;
+	uint32_t packet_sizes[UNIX_FRAME_MAX_PACKETS];
+
+	//the memfd of the frame and its mapping
+	int fd = -1;
+	void* mapping = NULL;
+	uint64_t mapping_size = 0;
+};
+
+/**
+ * Class : UnixConsumer
+ * -------------------------------
+ * This class will receive the frames of a UnixSender from another process
+ * (or the same one): each frame comes as a sealed memfd on the AF_UNIX
+ * socket and is mapped read only, no byte of the frame is copied.
+ * the seals are checked before mapping, so the sender can't change or
+ * truncate a frame being read.
+ * the sender never waits for a consumer, the frames it couldn't pass are
+ * found as gaps in the sequences and counted as lost.
+ */
+class UnixConsumer{
+
+private:
+
+	Error error_handler_;
+
+	int sock_fd_;
+
+	//the sequence of the last received frame
+	uint64_t last_sequence_;
+	uint64_t lost_frames_;
+
+	//the sender closed the connection
+	bool closed_;
+
+public:
+
+	UnixConsumer();
+
+	/**
+	 * Method : open
+	 * -------------------------------
+	 * connect to the socket of a sender, the first frame received is the
+	 * next one passed.
+	 * @param path is the socket path of the sender.
+	 * @return true if connected, false otherwise.
+	 * when false is returned the error_handler_ will be set accordingly.
+	 */
+	bool open(const std::string& path);
+
+	/**
+	 * Method : close
+	 * -------------------------------
+	 * close the connection, the received frames stay valid until released.
+	 */
+	void close();
+
+	/**
+	 * Method : receive_frame
+	 * -------------------------------
+	 * get the next frame, waiting for it.
+	 * @param frame is filled with the frame, to be given back with
+	 * release_frame(1).
+	 * @param timeout_ms is the longest wait in milliseconds, -1 for none.
+	 * @return true if a frame is given, false if the timeout expired, the
+	 * sender ended (is_closed(0)) or on error (is_error(0)).
+	 */
+	bool receive_frame(UnixFrame* frame, int timeout_ms);
+
+	/**
+	 * Method : release_frame
+	 * -------------------------------
+	 * unmap the frame and close its memfd.
+	 */
+	void release_frame(UnixFrame* frame);
+
+	/**
+	 * Method : is_closed
+	 * -------------------------------
+	 * @return true if the sender closed the connection.
+	 */
+	bool is_closed();
+
+	/**
+	 * Method : get_lost_frames
+	 * -------------------------------
+	 * @return the frames the sender couldn't pass to this consumer.
+	 */
+	uint64_t get_lost_frames();
+
+	std::string get_error();
+
+	bool is_error();
+
+	~UnixConsumer();
+
+};
+
+#endif
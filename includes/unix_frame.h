@@ -0,0 +1,46 @@
+#ifndef SRC_UTILS_UNIX_FRAME_H
+#define SRC_UTILS_UNIX_FRAME_H
+
+#include <stdint.h>
+#include <fcntl.h>
+
+#include "flags.h"
+
+//"RTDU" when read as little endian bytes
+#define UNIX_FRAME_MAGIC	(0x55445452u)
+#define UNIX_FRAME_VERSION	(1u)
+
+//the seals of the memfd of a frame, its bytes and size can't change
+#define UNIX_FRAME_SEALS	(F_SEAL_WRITE | F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL)
+
+/**
+ * Struct : UnixFrameMessage
+ * -------------------------------
+ * This struct will be sent by a UnixSender for each frame on the AF_UNIX
+ * socket of each consumer, with the sealed memfd holding the frame passed
+ * in SCM_RIGHTS.
+ * the frame is the packets back to back from data_offset in the memfd.
+ */
+struct UnixFrameMessage{
+
+	//UNIX_FRAME_MAGIC, UNIX_FRAME_VERSION
+	uint32_t magic;
+	uint32_t version;
+
+	//number of the frame since the sender initialized, from 1, a consumer
+	//which misses frames finds a gap
+	uint64_t sequence;
+
+	//CLOCK_MONOTONIC time the frame was passed
+	uint64_t timestamp_ns;
+
+	//the frame in the memfd
+	uint32_t data_offset;
+	uint32_t frame_size;
+
+	//the size of each packet
+	uint32_t num_packets;
+	uint32_t packet_sizes[UNIX_FRAME_MAX_PACKETS];
+};
+
+#endif
@@ -0,0 +1,216 @@
+#ifndef SRC_SENDERS_UNIX_SENDER_H
+#define SRC_SENDERS_UNIX_SENDER_H
+
+#include <string>
+#include <stdint.h>
+#include <limits.h>
+#include <pthread.h>
+
+#include <atomic>
+#include <map>
+
+#include "flags.h"
+#include "sender.h"
+#include "error.h"
+#include "data_packets.h"
+#include "unix_frame.h"
+#include "mutex_raii.h"
+#include "atomic_val_raii.h"
+#include "timers_utils.h"
+#include "trace_events.h"
+
+/**
+ * Struct : UnixWorkerData
+ * -------------------------------
+ * This struct will be given to the worker thread of a UnixSender, the data
+ * shared with the sender and the frame buffers created by the user.
+ */
+struct UnixWorkerData{
+
+	SenderWorkerData* shared_data = NULL;
+
+	//the consumers connected, set by the worker thread
+	std::atomic<uint_fast32_t> consumers = {0};
+
+	//frames not passed to a consumer because its socket was full
+	std::atomic<uint_fast64_t> dropped_frames = {0};
+
+	//the memfd and size of each frame buffer by its mapping, taken by the
+	//worker when the buffer is sent
+	std::map<void*, std::pair<int, uint_fast32_t>> frame_buffers;
+	pthread_mutex_t frame_buffers_mutex = PTHREAD_MUTEX_INITIALIZER;
+};
+
+/**
+ * Class : UnixSender
+ * -------------------------------
+ * This class will pass the frames to the consumers of the same host over an
+ * AF_UNIX socket: each frame is put in a memfd which is sealed against any
+ * change, then the descriptor is passed to every consumer with SCM_RIGHTS
+ * and mapped read only by a UnixConsumer, the frames cross the processes
+ * without being copied by the kernel.
+ * the frames are copied once into their memfd, unless the frame is a single
+ * packet in a buffer from create_frame_buffer(1), then the buffer itself is
+ * sealed and passed without any copy.
+ * the sender never waits for the consumers, a consumer whose socket is full
+ * misses the frame, the frame is done once passed to all the consumers, or
+ * at once if none is connected, the sender never reconnects.
+ */
+class UnixSender final : public Sender{
+
+private:
+
+	//the path of the socket the consumers connect to
+	std::string path_;
+	int server_sock_fd_;
+
+	//The thread where the frames are passed
+	pthread_t worker_thread_;
+
+	//The data which is shared between this class and it's worker thread
+	SenderWorkerData shared_data_;
+	UnixWorkerData worker_data_;
+
+	//error handler class
+	Error error_handler_;
+
+	//initialized?
+	bool initialized_;
+
+	//cores, priority and NUMA node of the worker thread
+	ThreadPlacement worker_placement_;
+
+	//the worker accounts the usage of each frame
+	bool usage_accounting_;
+	//the worker counts the perf events of each frame
+	bool perf_counters_;
+
+	//the worker thread was created and not joined yet
+	bool worker_running_;
+
+	//bytes of the frame given to the worker
+	uint_fast64_t frame_bytes_;
+
+	//create the server and set server_sock_fd_ to the server fd
+	//returns true if every thing runs correctly, false otherwise
+	//when false is returned the error_handler_ will be set accordingly.
+	bool create_server();
+
+public:
+
+	/**
+	 * Method : Constructor
+	 * -------------------------------
+	 * @param path is the path of the AF_UNIX socket, a socket left there is
+	 * replaced, initialize(0) fails if another file exists there.
+	 */
+	UnixSender(const std::string& path);
+
+	/**
+	 * Method : create_frame_buffer
+	 * -------------------------------
+	 * map a memfd the user fills with a frame, sent as the single memory
+	 * packet of a list it's passed to the consumers without a copy.
+	 * once sent the buffer is unmapped by the sender and must not be used
+	 * again, the packet is still released.
+	 * @param size is the bytes of the buffer.
+	 * @return the buffer, NULL on error.
+	 * when NULL is returned the error_handler_ will be set accordingly.
+	 */
+	void* create_frame_buffer(uint_fast32_t size);
+
+	/**
+	 * Method : free_frame_buffer
+	 * -------------------------------
+	 * give back a frame buffer which was not sent.
+	 */
+	void free_frame_buffer(void* buffer);
+
+	/**
+	 * Method : get_consumers
+	 * -------------------------------
+	 * @return the number of consumers the last frame was passed to.
+	 */
+	uint_fast32_t get_consumers();
+
+	/**
+	 * Method : get_dropped_frames
+	 * -------------------------------
+	 * @return the frames not passed to a consumer because its socket was
+	 * full, counted once per consumer.
+	 */
+	uint_fast64_t get_dropped_frames();
+
+	/**
+	 * Method : set_worker_placement
+	 * -------------------------------
+	 * set where the worker thread runs, by default it runs on CPU_CORE_AFFINITY
+	 * with priority 98, the numa_node makes its allocations prefer that node.
+	 * must be called before initialize(0).
+	 * @return true if the placement is valid, false otherwise.
+	 */
+	bool set_worker_placement(const ThreadPlacement& placement);
+
+	/**
+	 * Method : set_usage_accounting
+	 * -------------------------------
+	 * sample the cpu time, context switches and page faults of the worker
+	 * thread around each frame.
+	 * must be called before initialize(0), disabled by default.
+	 */
+	void set_usage_accounting(bool enabled);
+
+	/**
+	 * Method : get_worker_usage_stats
+	 * -------------------------------
+	 * give the usage of the frames passed since initialize(0).
+	 */
+	void get_worker_usage_stats(ThreadUsageStats* stats);
+
+	/**
+	 * Method : set_perf_counters
+	 * -------------------------------
+	 * count the perf events of the worker thread around each frame.
+	 * must be called before initialize(0), disabled by default.
+	 */
+	void set_perf_counters(bool enabled);
+
+	/**
+	 * Method : get_worker_perf_stats
+	 * -------------------------------
+	 * give the counters of the frames passed since initialize(0).
+	 */
+	void get_worker_perf_stats(PerfCounterStats* stats);
+
+	bool initialize() override;
+
+	/**
+	 * Method : send
+	 * -------------------------------
+	 * a frame with more than UNIX_FRAME_MAX_PACKETS packets is refused.
+	 */
+	bool send(DataPacketsList* list) override;
+
+	bool is_send_done() override;
+
+	/**
+	 * Method : get_link_state
+	 * -------------------------------
+	 * the frame being passed is queued and unsent until all the consumers
+	 * got it, the bytes kept by the consumers are not known.
+	 */
+	bool get_link_state(SenderLinkState* state) override;
+
+	bool is_reconnecting() override;
+
+	bool end_sender() override;
+
+	std::string get_error() override;
+
+	bool is_error() override;
+
+	~UnixSender();
+
+};
+
+#endif
@@ -8,7 +8,7 @@
 #include "timers_utils.h"
 #include "error.h"
 
-class WorstCaseTimer : public Timer{
+class WorstCaseTimer final : public Timer{
 
 private:
 
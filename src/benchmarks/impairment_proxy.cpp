@@ -0,0 +1,71 @@
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include "../../includes/impairment_proxy.h"
+
+using namespace std;
+
+/**
+ * Forward a sender on the loopback to a client (the receiver under test)
+ * through a degraded link until interrupted, the forwarded bytes are printed
+ * each second.
+ */
+
+static volatile sig_atomic_t stop = 0;
+
+static void on_signal(int) {
+	stop = 1;
+}
+
+int main(int argc, char** argv) {
+
+	if(argc < 3) {
+		printf("Impairment proxy\n");
+		printf("\n");
+		printf("Usage:\n");
+		printf("%s listen_port sender_port [--bandwidth bytes_per_sec] [--delay us] [--jitter us] "
+			"[--stall period_ms stall_ms] [--queue bytes]\n", argv[0]);
+		exit(0);
+	}
+
+	ImpairmentProxy proxy(atoi(argv[1]), atoi(argv[2]));
+	ImpairmentSettings settings;
+	memset(&settings, 0, sizeof(settings));
+	for(int i=3; i<argc; i++) {
+		if(strcmp(argv[i], "--bandwidth") == 0 && i + 1 < argc) {
+			settings.bandwidth_bytes = strtoull(argv[++i], NULL, 10);
+		} else if(strcmp(argv[i], "--delay") == 0 && i + 1 < argc) {
+			settings.delay_us = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "--jitter") == 0 && i + 1 < argc) {
+			settings.jitter_us = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "--stall") == 0 && i + 2 < argc) {
+			settings.stall_period_ms = atoi(argv[++i]);
+			settings.stall_ms = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "--queue") == 0 && i + 1 < argc) {
+			proxy.set_queue_limit(atoi(argv[++i]));
+		} else {
+			cerr << "Unknown option " << argv[i] << endl;
+			return 1;
+		}
+	}
+	proxy.set_impairment(settings);
+
+	if(!proxy.initialize()) {
+		cerr << proxy.get_error() << endl;
+		return 1;
+	}
+	signal(SIGINT, on_signal);
+	signal(SIGTERM, on_signal);
+	while(!stop) {
+		sleep(1);
+		printf("%lu bytes forwarded, %lu connections\n",
+			(unsigned long) proxy.get_forwarded_bytes(), (unsigned long) proxy.get_connections());
+		fflush(stdout);
+	}
+	proxy.end_proxy();
+	return 0;
+}
@@ -0,0 +1,202 @@
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "../../includes/impairment_proxy.h"
+#include "../../includes/senders.h"
+#include "../../includes/systems.h"
+#include "../../includes/timers.h"
+
+using namespace std;
+using namespace timers_utils;
+
+/**
+ * A system streams 256KB frames at 30Hz (about 7.9MB/s) through an
+ * ImpairmentProxy to a client for each scenario, one JSON object is written
+ * per scenario with the sent and the skipped frames, the drop rate, the
+ * bytes the client got, how the run ended and, when the link is cut, the
+ * time the system took to report the client as disconnected.
+ */
+
+static const uint_fast16_t sender_port = 7600;
+static const uint_fast16_t proxy_port = 7601;
+static const uint_fast16_t frequency = 30;
+static const uint_fast32_t frame_size = 256*1024;
+
+struct Scenario{
+	const char* name;
+	ImpairmentSettings settings;
+	bool skip_mode;
+	uint_fast16_t ms_tolerance;
+	//the link stalls until the end from this second, 0 for never
+	uint_fast32_t cut_at_sec;
+};
+
+//                                 bandwidth      delay  jitter  stall period  stall
+static const std::vector<Scenario> scenarios = {
+	{"clean",                     {0,             0,     0,      0,     0},    true,  0,  0},
+	{"half_bandwidth",            {4000000,       0,     0,      0,     0},    true,  0,  0},
+	{"tight_bandwidth",           {8500000,       0,     0,      0,     0},    true,  0,  0},
+	{"tight_bandwidth_tolerance", {8500000,       0,     0,      0,     0},    true,  10, 0},
+	{"delay_jitter",              {0,             20000, 20000,  0,     0},    true,  0,  0},
+	{"delay_jitter_tolerance",    {0,             20000, 20000,  0,     0},    true,  10, 0},
+	{"periodic_stall",            {0,             0,     0,      2500,  1000}, true,  0,  0},
+	{"periodic_stall_no_skip",    {0,             0,     0,      2500,  1000}, false, 0,  0},
+	{"cut_link",                  {0,             0,     0,      0,     0},    true,  0,  1},
+};
+
+//read everything the proxy forwards until it closes
+static void* client_function(void* data) {
+	std::atomic<uint_fast64_t>* received_bytes = (std::atomic<uint_fast64_t>*) data;
+	int sock_fd = socket(AF_INET, SOCK_STREAM, 0);
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_port = htons(proxy_port);
+	inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+	if(connect(sock_fd, (sockaddr*) &address, sizeof(address)) == 0) {
+		char* buffer = (char*) malloc(256*1024);
+		ssize_t r;
+		while((r = recv(sock_fd, buffer, 256*1024, 0)) > 0) {
+			*received_bytes += r;
+		}
+		free(buffer);
+	}
+	close(sock_fd);
+	return NULL;
+}
+
+static bool run(const Scenario& scenario, uint_fast32_t duration_sec, char* frame, FILE* out) {
+
+	ImpairmentProxy proxy(proxy_port, sender_port);
+	proxy.set_impairment(scenario.settings);
+	if(!proxy.initialize()) {
+		cerr << scenario.name << ": " << proxy.get_error() << endl;
+		return false;
+	}
+
+	//the sender waits in initialize(0) for the proxy to connect
+	std::atomic<uint_fast64_t> received_bytes(0);
+	pthread_t client_thread;
+	pthread_create(&client_thread, NULL, client_function, (void*) &received_bytes);
+
+	uint_fast32_t ticks = uint_fast32_t(duration_sec) * frequency;
+	uint_fast32_t cut_tick = scenario.cut_at_sec * frequency;
+	uint_fast32_t sent_frames = 0, skipped_frames = 0;
+	uint_fast64_t cut_ns = 0;
+	auto user_fn = [&](RealTimeInfo* info) {
+		uint_fast32_t sequence_number = info->get_sequence_number();
+		if(sequence_number + 1 >= ticks) {
+			info->stop_system();
+		}
+		if(cut_tick != 0 && sequence_number == cut_tick) {
+			ImpairmentSettings cut = scenario.settings;
+			cut.stall_period_ms = cut.stall_ms = 1;
+			proxy.set_impairment(cut);
+			cut_ns = monotonic_ns();
+		}
+		if(info->is_skipped_data()) {
+			skipped_frames++;
+		} else {
+			sent_frames++;
+		}
+		DataPacketsList list(1);
+		list.packets[0].data_ptr = frame;
+		list.packets[0].data_size = frame_size;
+		return list;
+	};
+
+	TCPSender sender(sender_port);
+	FreeWaitTimer timer;
+	RealTimeSystem system;
+	system.set_user_data_fn(user_fn);
+	system.set_timer(&timer);
+	system.set_sender(&sender);
+	system.set_frequency(frequency);
+	system.skip_mode(scenario.skip_mode);
+	system.set_ms_tolerance(scenario.ms_tolerance);
+	bool initialized = system.initialize();
+	bool completed = initialized && system.run();
+	uint_fast64_t end_ns = monotonic_ns();
+	std::string error = completed ? "" : system.get_error();
+
+	proxy.end_proxy();
+	pthread_join(client_thread, NULL);
+
+	bool disconnected = error.find("disconnected") != std::string::npos;
+	uint_fast32_t frames = sent_frames + skipped_frames;
+	//the error is a plain sentence, keep it valid JSON
+	for(char& c : error) {
+		if(c == '"' || c == '\\' || c < ' ') {
+			c = ' ';
+		}
+	}
+	fprintf(out, "{\"scenario\": \"%s\", \"skip_mode\": %s, \"ms_tolerance\": %lu, \"frames\": %lu, "
+		"\"sent_frames\": %lu, \"skipped_frames\": %lu, \"drop_rate\": %.3f, \"received_bytes\": %lu, "
+		"\"completed\": %s, \"error\": \"%s\", \"disconnect_detected\": %s, \"detection_ms\": %lu}\n",
+		scenario.name, scenario.skip_mode ? "true" : "false", (unsigned long) scenario.ms_tolerance,
+		(unsigned long) frames, (unsigned long) sent_frames, (unsigned long) skipped_frames,
+		frames ? double(skipped_frames) / frames : 0.0, (unsigned long) received_bytes,
+		completed ? "true" : "false", error.c_str(), disconnected ? "true" : "false",
+		(unsigned long) (disconnected && cut_ns ? NS_TO_MS(end_ns - cut_ns) : 0));
+	fflush(out);
+	return initialized;
+}
+
+int main(int argc, char** argv) {
+
+	uint_fast32_t duration_sec = 5;
+	const char* out_path = NULL;
+	const char* only_scenario = NULL;
+	for(int i=1; i<argc; i++) {
+		if(strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+			duration_sec = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+			out_path = argv[++i];
+		} else if(strcmp(argv[i], "--scenario") == 0 && i + 1 < argc) {
+			only_scenario = argv[++i];
+		} else {
+			printf("Impairment scenarios\n");
+			printf("\n");
+			printf("Usage:\n");
+			printf("%s [--duration sec_per_scenario] [--out results.jsonl] [--scenario name]\n", argv[0]);
+			exit(0);
+		}
+	}
+
+	FILE* out = stdout;
+	if(out_path != NULL && (out = fopen(out_path, "w")) == NULL) {
+		cerr << "Can't open " << out_path << endl;
+		return 1;
+	}
+
+	char* frame = (char*) malloc(frame_size);
+	memset(frame, 3, frame_size);
+
+	bool failed = false;
+	for(const Scenario& scenario : scenarios) {
+		if(only_scenario != NULL && strcmp(only_scenario, scenario.name) != 0) {
+			continue;
+		}
+		//the cut link needs 3 seconds of skipped frames to be detected
+		uint_fast32_t duration = scenario.cut_at_sec != 0 ?
+			std::max(duration_sec, scenario.cut_at_sec + 6) : duration_sec;
+		failed |= !run(scenario, duration, frame, out);
+	}
+
+	free(frame);
+	if(out != stdout) {
+		fclose(out);
+	}
+	return failed ? 1 : 0;
+}
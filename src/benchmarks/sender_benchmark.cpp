@@ -0,0 +1,224 @@
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "../../includes/senders.h"
+#include "../../includes/timers.h"
+#include "sender_registry.h"
+
+using namespace std;
+using namespace timers_utils;
+
+/**
+ * Every sender streams frames over the loopback to a receiver thread of this
+ * process for each payload size, packets per list and frequency, one JSON
+ * object is written per run:
+ * throughput (received bytes per second), cpu per frame (the process cpu
+ * time minus the receiver thread, per sent frame) and the p50/p99/max time
+ * from send(1) until is_send_done(0), polled each 20us, with the perf
+ * counters of the sender worker per frame and per byte when available.
+ * a frame is late if the last one is not done at its tick, it's not sent.
+ */
+
+struct RunConfig{
+	uint_fast32_t frame_bytes;
+	uint_fast32_t packets;
+	uint_fast16_t frequency;
+};
+
+struct ReceiverData{
+	uint_fast16_t port;
+	uint_fast64_t received_bytes;
+	uint_fast64_t cpu_ns;
+};
+
+//connect to the sender and read until it closes the connection
+static void* receiver_function(void* data) {
+	ReceiverData* receiver = (ReceiverData*) data;
+	int sock_fd = socket(AF_INET, SOCK_STREAM, 0);
+	int buff_size = 8*1024*1024;
+	setsockopt(sock_fd, SOL_SOCKET, SO_RCVBUF, &buff_size, sizeof(buff_size));
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_port = htons(receiver->port);
+	inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+	if(connect(sock_fd, (sockaddr*) &address, sizeof(address)) == 0) {
+		char* buffer = (char*) malloc(1024*1024);
+		ssize_t r;
+		while((r = recv(sock_fd, buffer, 1024*1024, 0)) > 0) {
+			receiver->received_bytes += r;
+		}
+		free(buffer);
+	}
+	close(sock_fd);
+	receiver->cpu_ns = cpu_time_ns(RUSAGE_THREAD);
+	return NULL;
+}
+
+static uint_fast64_t percentile(std::vector<uint_fast64_t>& values, double p) {
+	if(values.empty()) {
+		return 0;
+	}
+	size_t index = std::min(values.size() - 1, size_t(p * values.size()));
+	std::nth_element(values.begin(), values.begin() + index, values.end());
+	return values[index];
+}
+
+//stream the frames for duration_ms and write the result line
+static bool run(const SenderEntry& entry, const RunConfig& config, uint_fast32_t duration_ms,
+				char* frame, uint_fast16_t port, FILE* out) {
+
+	Sender* sender = entry.create(port);
+	if(!sender->initialize()) {
+		cerr << entry.name << ": " << sender->get_error() << endl;
+		delete sender;
+		return false;
+	}
+	ReceiverData receiver = {port, 0, 0};
+	pthread_t receiver_thread;
+	pthread_create(&receiver_thread, NULL, receiver_function, (void*) &receiver);
+	//the sender accepts the receiver in the background
+	while(sender->is_reconnecting()) {
+		microseconds_sleep(20);
+	}
+
+	//the frame split in equal packets
+	DataPacketsList list(config.packets);
+	uint_fast32_t packet_bytes = config.frame_bytes / config.packets;
+	for(uint_fast32_t i=0; i<config.packets; i++) {
+		list.packets[i].data_ptr = frame + i * packet_bytes;
+		list.packets[i].data_size = packet_bytes;
+	}
+
+	uint_fast64_t period_ns = SEC_TO_NS(1) / config.frequency;
+	uint_fast32_t ticks = uint_fast64_t(duration_ms) * config.frequency / 1000;
+	std::vector<uint_fast64_t> completions;
+	completions.reserve(ticks);
+	uint_fast32_t late = 0;
+	bool failed = false;
+	uint_fast64_t cpu_start = cpu_time_ns(RUSAGE_SELF);
+	uint_fast64_t start = monotonic_ns();
+	for(uint_fast32_t t=0; t<ticks && !failed; t++) {
+		uint_fast64_t tick = start + t * period_ns;
+		while(monotonic_ns() < tick) {
+			nanoseconds_sleep(std::min(tick - monotonic_ns(), period_ns));
+		}
+		if(!sender->is_send_done()) {
+			late++;
+			continue;
+		}
+		uint_fast64_t send_ns = monotonic_ns();
+		if(!sender->send(&list)) {
+			failed = true;
+			break;
+		}
+		//wait for the completion until the next tick
+		while(!sender->is_send_done() && monotonic_ns() < tick + period_ns) {
+			microseconds_sleep(20);
+		}
+		if(sender->is_send_done()) {
+			completions.push_back(monotonic_ns() - send_ns);
+		}
+	}
+	//let the last frame complete before ending
+	uint_fast64_t drain_end = monotonic_ns() + SEC_TO_NS(1);
+	while(!sender->is_send_done() && monotonic_ns() < drain_end) {
+		microseconds_sleep(20);
+	}
+	uint_fast64_t elapsed_ns = monotonic_ns() - start;
+	sender->end_sender();
+	pthread_join(receiver_thread, NULL);
+	uint_fast64_t cpu_ns = cpu_time_ns(RUSAGE_SELF) - cpu_start - receiver.cpu_ns;
+	if(failed) {
+		cerr << entry.name << ": " << sender->get_error() << endl;
+	}
+	PerfCounterStats perf_stats;
+	if(entry.get_perf_stats) {
+		entry.get_perf_stats(sender, &perf_stats);
+	}
+	delete sender;
+
+	uint_fast32_t sent = ticks - late;
+	fprintf(out, "{\"sender\": \"%s\", \"frame_bytes\": %lu, \"packets\": %lu, \"frequency\": %lu, "
+		"\"frames\": %lu, \"late_frames\": %lu, \"throughput_bytes_per_sec\": %.0f, "
+		"\"cpu_ns_per_frame\": %lu, \"completion_p50_ns\": %lu, \"completion_p99_ns\": %lu, "
+		"\"completion_max_ns\": %lu, \"failed\": %s",
+		entry.name, (unsigned long) config.frame_bytes, (unsigned long) config.packets,
+		(unsigned long) config.frequency, (unsigned long) sent, (unsigned long) late,
+		double(receiver.received_bytes) * SEC_TO_NS(1) / elapsed_ns,
+		(unsigned long) (sent ? cpu_ns / sent : 0),
+		(unsigned long) percentile(completions, 0.5), (unsigned long) percentile(completions, 0.99),
+		(unsigned long) percentile(completions, 1.0), failed ? "true" : "false");
+	write_perf_json(out, perf_stats);
+	fprintf(out, "}\n");
+	fflush(out);
+	return !failed;
+}
+
+int main(int argc, char** argv) {
+
+	uint_fast32_t duration_ms = 1000;
+	const char* out_path = NULL;
+	const char* only_sender = NULL;
+	for(int i=1; i<argc; i++) {
+		if(strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+			duration_ms = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+			out_path = argv[++i];
+		} else if(strcmp(argv[i], "--sender") == 0 && i + 1 < argc) {
+			only_sender = argv[++i];
+		} else {
+			printf("Sender benchmark\n");
+			printf("\n");
+			printf("Usage:\n");
+			printf("%s [--duration ms_per_run] [--out results.jsonl] [--sender name]\n", argv[0]);
+			exit(0);
+		}
+	}
+
+	FILE* out = stdout;
+	if(out_path != NULL && (out = fopen(out_path, "w")) == NULL) {
+		cerr << "Can't open " << out_path << endl;
+		return 1;
+	}
+
+	const uint_fast32_t frame_sizes[] = {64*1024, 1024*1024, 4*1024*1024};
+	const uint_fast32_t packet_counts[] = {1, 8, 64};
+	const uint_fast16_t frequencies[] = {30, 100};
+
+	//page aligned, the spliced pages of a packet are not shared with another
+	char* frame = (char*) aligned_alloc(4096, 4*1024*1024);
+	memset(frame, 1, 4*1024*1024);
+
+	bool failed = false;
+	uint_fast16_t port = 7590;
+	for(const SenderEntry& entry : senders) {
+		if(only_sender != NULL && strcmp(only_sender, entry.name) != 0) {
+			continue;
+		}
+		for(uint_fast32_t frame_bytes : frame_sizes) {
+			for(uint_fast32_t packets : packet_counts) {
+				for(uint_fast16_t frequency : frequencies) {
+					RunConfig config = {frame_bytes, packets, frequency};
+					failed |= !run(entry, config, duration_ms, frame, port, out);
+				}
+			}
+		}
+	}
+
+	free(frame);
+	if(out != stdout) {
+		fclose(out);
+	}
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,67 @@
+#ifndef SRC_BENCHMARKS_SENDER_REGISTRY_H
+#define SRC_BENCHMARKS_SENDER_REGISTRY_H
+
+#include <stdio.h>
+
+#include <functional>
+#include <vector>
+
+#include "../../includes/senders.h"
+
+//the senders under test, a new sender is benchmarked by adding it here,
+//get_perf_stats gives the perf counters of the sender (empty if it has none)
+struct SenderEntry{
+	const char* name;
+	std::function<Sender*(uint_fast16_t port)> create;
+	std::function<void(Sender* sender, PerfCounterStats* stats)> get_perf_stats;
+};
+
+static const std::vector<SenderEntry> senders = {
+	{"TCPSender", [](uint_fast16_t port) {
+		TCPSender* sender = new TCPSender(port);
+		sender->set_async_accept(true);
+		sender->set_perf_counters(true);
+		return (Sender*) sender;
+	}, [](Sender* sender, PerfCounterStats* stats) {
+		((TCPSender*) sender)->get_worker_perf_stats(stats);
+	}},
+	{"TCPSenderZC", [](uint_fast16_t port) {
+		TCPSenderZC* sender = new TCPSenderZC(port);
+		sender->set_async_accept(true);
+		sender->set_perf_counters(true);
+		return (Sender*) sender;
+	}, [](Sender* sender, PerfCounterStats* stats) {
+		((TCPSenderZC*) sender)->get_worker_perf_stats(stats);
+	}},
+	{"TCPSenderSplice", [](uint_fast16_t port) {
+		TCPSenderSplice* sender = new TCPSenderSplice(port);
+		sender->set_async_accept(true);
+		sender->set_perf_counters(true);
+		return (Sender*) sender;
+	}, [](Sender* sender, PerfCounterStats* stats) {
+		((TCPSenderSplice*) sender)->get_worker_perf_stats(stats);
+	}},
+};
+
+//write the counters per frame and per byte as the members of a JSON object,
+//after a comma, nothing if no counter was opened
+static inline void write_perf_json(FILE* out, const PerfCounterStats& stats) {
+	if(stats.intervals == 0) {
+		return;
+	}
+	for(int id=0; id<PERF_COUNTERS; id++) {
+		if(stats.opened[id]) {
+			fprintf(out, ", \"%s_per_frame\": %.0f", perf_counters::name(PERF_COUNTER_ID(id)),
+				double(stats.values[id]) / stats.intervals);
+		}
+	}
+	const PERF_COUNTER_ID per_byte[] = {PERF_INSTRUCTIONS, PERF_CYCLES, PERF_CACHE_MISSES};
+	for(PERF_COUNTER_ID id : per_byte) {
+		if(stats.opened[id] && stats.bytes != 0) {
+			fprintf(out, ", \"%s_per_byte\": %.4f", perf_counters::name(id), double(stats.values[id]) / stats.bytes);
+		}
+	}
+	fprintf(out, ", \"perf_kernel_included\": %s", stats.kernel_included ? "true" : "false");
+}
+
+#endif
@@ -0,0 +1,235 @@
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include <random>
+#include <vector>
+
+#include "../../includes/senders.h"
+#include "../../includes/systems.h"
+#include "../../includes/timers.h"
+#include "../../includes/stream_recording.h"
+#include "sender_registry.h"
+
+using namespace std;
+using namespace timers_utils;
+
+/**
+ * Replay a stream recording through a RealTimeSystem with every sender to a
+ * receiver thread of this process over the loopback, at the recorded
+ * frequency, one JSON object is written per sender:
+ * the recorded and received bytes, the frames skipped by the system and the
+ * throughput, so the senders are compared on the same variable-size frames.
+ * --generate records a synthetic stream instead: a key frame each second and
+ * smaller frames between them of a random size, in packets of up to 64KB,
+ * made by a user function on a simulated clock.
+ */
+
+struct ReceiverData{
+	uint_fast16_t port;
+	uint_fast64_t received_bytes;
+};
+
+//connect to the sender and read until it closes the connection
+static void* receiver_function(void* data) {
+	ReceiverData* receiver = (ReceiverData*) data;
+	int sock_fd = socket(AF_INET, SOCK_STREAM, 0);
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_port = htons(receiver->port);
+	inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+	//the system starts listening after this thread, retry for a second
+	bool connected = false;
+	for(int i=0; i<100 && !connected; i++) {
+		connected = connect(sock_fd, (sockaddr*) &address, sizeof(address)) == 0;
+		if(!connected) {
+			milliseconds_sleep(10);
+		}
+	}
+	if(connected) {
+		char* buffer = (char*) malloc(1024*1024);
+		ssize_t r;
+		while((r = recv(sock_fd, buffer, 1024*1024, 0)) > 0) {
+			receiver->received_bytes += r;
+		}
+		free(buffer);
+	}
+	close(sock_fd);
+	return NULL;
+}
+
+//record the synthetic stream
+static bool generate(const char* path, uint_fast32_t frames, uint_fast16_t frequency, bool payloads) {
+	const uint_fast32_t max_packet = 64*1024;
+	vector<char> frame(2*1024*1024);
+	mt19937 random(frames);
+	for(char& byte : frame) {
+		byte = (char) random();
+	}
+
+	StreamRecorder recorder;
+	if(!recorder.open(path, frequency, payloads)) {
+		cerr << recorder.get_error() << endl;
+		return false;
+	}
+	auto user_fn = [&](RealTimeInfo* info) {
+		uint_fast32_t n = info->get_sequence_number();
+		if(n + 1 >= frames) {
+			info->stop_system();
+		}
+		uint_fast32_t frame_bytes = n % frequency == 0 ? 1536*1024 : 64*1024 + random() % (448*1024);
+		uint_fast32_t offset = random() % (frame.size() - frame_bytes);
+		DataPacketsList list((frame_bytes + max_packet - 1) / max_packet);
+		for(uint_fast32_t i=0; i<list.num_packets; i++) {
+			list.packets[i].data_ptr = &frame[offset + i * max_packet];
+			list.packets[i].data_size = min(max_packet, frame_bytes - i * max_packet);
+		}
+		recorder.record(info, list);
+		return list;
+	};
+
+	SimulatedClock clock;
+	set_clock(&clock);
+	MockSender sender;
+	FreeWaitTimer timer;
+	RealTimeSystem system;
+	system.set_user_data_fn(user_fn);
+	system.set_timer(&timer);
+	system.set_sender(&sender);
+	system.set_frequency(frequency);
+	system.skip_mode(true);
+	bool done = system.initialize() && system.run();
+	set_clock(NULL);
+	if(!done) {
+		cerr << system.get_error() << endl;
+	}
+	if(!recorder.close() || recorder.is_error()) {
+		cerr << recorder.get_error() << endl;
+		return false;
+	}
+	printf("%lu frames recorded to %s\n", (unsigned long) recorder.get_frames(), path);
+	return done;
+}
+
+//replay the recording with one sender and write the result line
+static bool replay(const SenderEntry& entry, StreamReplayer& replayer, uint_fast16_t port, FILE* out) {
+	Sender* sender = entry.create(port);
+	ReceiverData receiver = {port, 0};
+	pthread_t receiver_thread;
+	pthread_create(&receiver_thread, NULL, receiver_function, (void*) &receiver);
+
+	uint_fast64_t recorded_bytes = 0;
+	uint_fast32_t skipped = 0;
+	auto user_fn = [&](RealTimeInfo* info) {
+		recorded_bytes += replayer.get_frame_bytes(info->get_sequence_number());
+		if(info->is_skipped_data() || info->is_predicted_skip()) {
+			skipped++;
+		}
+		return replayer.next_frame(info);
+	};
+	FreeWaitTimer timer;
+	RealTimeSystem system;
+	system.set_user_data_fn(user_fn);
+	system.set_timer(&timer);
+	system.set_sender(sender);
+	system.set_frequency(replayer.get_frequency());
+	system.skip_mode(true);
+	uint_fast64_t start = monotonic_ns();
+	bool done = system.initialize() && system.run();
+	uint_fast64_t elapsed_ns = monotonic_ns() - start;
+	if(!done) {
+		cerr << entry.name << ": " << system.get_error() << endl;
+	}
+	sender->end_sender();
+	pthread_join(receiver_thread, NULL);
+	PerfCounterStats perf_stats;
+	if(entry.get_perf_stats) {
+		entry.get_perf_stats(sender, &perf_stats);
+	}
+	delete sender;
+
+	fprintf(out, "{\"sender\": \"%s\", \"frames\": %lu, \"frequency\": %lu, \"skipped_frames\": %lu, "
+		"\"recorded_bytes\": %lu, \"received_bytes\": %lu, \"throughput_bytes_per_sec\": %.0f, \"failed\": %s",
+		entry.name, (unsigned long) replayer.get_frames(), (unsigned long) replayer.get_frequency(),
+		(unsigned long) skipped, (unsigned long) recorded_bytes, (unsigned long) receiver.received_bytes,
+		double(receiver.received_bytes) * SEC_TO_NS(1) / elapsed_ns, done ? "false" : "true");
+	write_perf_json(out, perf_stats);
+	fprintf(out, "}\n");
+	fflush(out);
+	return done;
+}
+
+int main(int argc, char** argv) {
+
+	const char* path = NULL;
+	const char* generate_path = NULL;
+	const char* out_path = NULL;
+	const char* only_sender = NULL;
+	uint_fast32_t frames = 300;
+	uint_fast16_t frequency = 30;
+	bool payloads = true;
+	for(int i=1; i<argc; i++) {
+		if(strcmp(argv[i], "--generate") == 0 && i + 1 < argc) {
+			generate_path = argv[++i];
+		} else if(strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+			frames = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "--frequency") == 0 && i + 1 < argc) {
+			frequency = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "--sizes-only") == 0) {
+			payloads = false;
+		} else if(strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+			out_path = argv[++i];
+		} else if(strcmp(argv[i], "--sender") == 0 && i + 1 < argc) {
+			only_sender = argv[++i];
+		} else if(argv[i][0] != '-' && path == NULL) {
+			path = argv[i];
+		} else {
+			path = NULL;
+			generate_path = NULL;
+			break;
+		}
+	}
+	if((path == NULL) == (generate_path == NULL) || frames == 0 || frequency == 0) {
+		printf("Stream replay\n");
+		printf("\n");
+		printf("Usage:\n");
+		printf("%s recording [--out results.jsonl] [--sender name]\n", argv[0]);
+		printf("%s --generate recording [--frames n] [--frequency f] [--sizes-only]\n", argv[0]);
+		exit(0);
+	}
+
+	if(generate_path != NULL) {
+		return generate(generate_path, frames, frequency, payloads) ? 0 : 1;
+	}
+
+	StreamReplayer replayer;
+	if(!replayer.load(path)) {
+		cerr << replayer.get_error() << endl;
+		return 1;
+	}
+	FILE* out = stdout;
+	if(out_path != NULL && (out = fopen(out_path, "w")) == NULL) {
+		cerr << "Can't open " << out_path << endl;
+		return 1;
+	}
+
+	bool failed = false;
+	uint_fast16_t port = 7610;
+	for(const SenderEntry& entry : senders) {
+		if(only_sender != NULL && strcmp(only_sender, entry.name) != 0) {
+			continue;
+		}
+		failed |= !replay(entry, replayer, port, out);
+	}
+
+	if(out != stdout) {
+		fclose(out);
+	}
+	return failed ? 1 : 0;
+}
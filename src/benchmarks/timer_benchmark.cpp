@@ -0,0 +1,175 @@
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "../../includes/timers.h"
+
+using namespace std;
+using namespace timers_utils;
+
+/**
+ * Every timer ticks for the given duration at each frequency, the wake time
+ * after each sleep_to_next_tick(0) is compared with the ideal tick
+ * (start + n/frequency) and one JSON object is written per run:
+ * the p50/p99/p999/max lateness of the wake, the drift (mean lateness of the
+ * last tenth of the ticks minus the first tenth), the missed ticks (the call
+ * came after the tick, the timer is restarted) and the cpu time used by the
+ * timer in percent of the run.
+ */
+
+//the timers under test, a new timer is benchmarked by adding it here
+struct TimerEntry{
+	const char* name;
+	std::function<Timer*(uint_fast32_t worst_delay_us)> create;
+};
+
+static const std::vector<TimerEntry> timers = {
+	{"BusyWaitTimer", [](uint_fast32_t) {
+		return (Timer*) new BusyWaitTimer();
+	}},
+	{"FreeWaitTimer", [](uint_fast32_t) {
+		return (Timer*) new FreeWaitTimer();
+	}},
+	{"WorstCaseTimer", [](uint_fast32_t worst_delay_us) {
+		return (Timer*) new WorstCaseTimer(worst_delay_us);
+	}},
+};
+
+static uint_fast64_t percentile(std::vector<uint_fast64_t>& values, double p) {
+	if(values.empty()) {
+		return 0;
+	}
+	size_t index = std::min(values.size() - 1, size_t(p * values.size()));
+	std::nth_element(values.begin(), values.begin() + index, values.end());
+	return values[index];
+}
+
+static double mean(const std::vector<uint_fast64_t>& values, size_t from, size_t to) {
+	if(from >= to) {
+		return 0;
+	}
+	double sum = 0;
+	for(size_t i=from; i<to; i++) {
+		sum += values[i];
+	}
+	return sum / (to - from);
+}
+
+//tick the timer for duration_ms and write the result line
+static bool run(const TimerEntry& entry, uint_fast16_t frequency, uint_fast32_t duration_ms,
+				uint_fast32_t worst_delay_us, FILE* out) {
+
+	Timer* timer = entry.create(worst_delay_us);
+	if(!timer->initialize() || !timer->set_frequency(frequency)) {
+		cerr << entry.name << ": " << timer->get_error() << endl;
+		delete timer;
+		return false;
+	}
+
+	uint_fast64_t period_ps = SEC_TO_PS(1) / frequency;
+	uint_fast32_t ticks = uint_fast64_t(duration_ms) * frequency / 1000;
+	//lateness of each wake in order, the percentiles reorder a copy
+	std::vector<uint_fast64_t> lateness;
+	lateness.reserve(ticks);
+	uint_fast32_t missed = 0;
+	bool failed = false;
+
+	uint_fast64_t cpu_start = cpu_time_ns(RUSAGE_THREAD);
+	uint_fast64_t run_start = monotonic_ns();
+	uint_fast64_t start = monotonic_ns();
+	if(!timer->start_timer()) {
+		failed = true;
+	}
+	uint_fast32_t tick = 0;
+	for(uint_fast32_t t=0; t<ticks && !failed; t++) {
+		if(!timer->sleep_to_next_tick()) {
+			//the tick passed before the call, start again from now
+			missed++;
+			timer->get_error();
+			timer->stop_timer();
+			start = monotonic_ns();
+			tick = 0;
+			failed = !timer->start_timer();
+			continue;
+		}
+		uint_fast64_t wake = monotonic_ns();
+		tick++;
+		uint_fast64_t ideal = start + PS_TO_NS(period_ps * tick);
+		lateness.push_back(wake > ideal ? wake - ideal : 0);
+	}
+	timer->stop_timer();
+	uint_fast64_t elapsed_ns = monotonic_ns() - run_start;
+	uint_fast64_t cpu_ns = cpu_time_ns(RUSAGE_THREAD) - cpu_start;
+	if(failed) {
+		cerr << entry.name << ": " << timer->get_error() << endl;
+	}
+	delete timer;
+
+	size_t tenth = lateness.size() / 10;
+	double drift = mean(lateness, lateness.size() - tenth, lateness.size()) - mean(lateness, 0, tenth);
+	std::vector<uint_fast64_t> sorted = lateness;
+	fprintf(out, "{\"timer\": \"%s\", \"frequency\": %lu, \"ticks\": %lu, \"missed_ticks\": %lu, "
+		"\"lateness_p50_ns\": %lu, \"lateness_p99_ns\": %lu, \"lateness_p999_ns\": %lu, "
+		"\"lateness_max_ns\": %lu, \"drift_ns\": %.0f, \"cpu_percent\": %.1f, \"failed\": %s}\n",
+		entry.name, (unsigned long) frequency, (unsigned long) lateness.size(), (unsigned long) missed,
+		(unsigned long) percentile(sorted, 0.5), (unsigned long) percentile(sorted, 0.99),
+		(unsigned long) percentile(sorted, 0.999), (unsigned long) percentile(sorted, 1.0),
+		drift, elapsed_ns ? 100.0 * cpu_ns / elapsed_ns : 0.0, failed ? "true" : "false");
+	fflush(out);
+	return !failed;
+}
+
+int main(int argc, char** argv) {
+
+	uint_fast32_t duration_ms = 2000;
+	uint_fast32_t worst_delay_us = 500;
+	const char* out_path = NULL;
+	const char* only_timer = NULL;
+	std::vector<uint_fast16_t> frequencies = {10, 30, 60, 100};
+	for(int i=1; i<argc; i++) {
+		if(strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+			duration_ms = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "--frequency") == 0 && i + 1 < argc) {
+			frequencies = {uint_fast16_t(atoi(argv[++i]))};
+		} else if(strcmp(argv[i], "--worst-delay") == 0 && i + 1 < argc) {
+			worst_delay_us = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+			out_path = argv[++i];
+		} else if(strcmp(argv[i], "--timer") == 0 && i + 1 < argc) {
+			only_timer = argv[++i];
+		} else {
+			printf("Timer benchmark\n");
+			printf("\n");
+			printf("Usage:\n");
+			printf("%s [--duration ms_per_run] [--frequency hz] [--worst-delay us] [--out results.jsonl] [--timer name]\n", argv[0]);
+			exit(0);
+		}
+	}
+
+	FILE* out = stdout;
+	if(out_path != NULL && (out = fopen(out_path, "w")) == NULL) {
+		cerr << "Can't open " << out_path << endl;
+		return 1;
+	}
+
+	bool failed = false;
+	for(const TimerEntry& entry : timers) {
+		if(only_timer != NULL && strcmp(only_timer, entry.name) != 0) {
+			continue;
+		}
+		for(uint_fast16_t frequency : frequencies) {
+			failed |= !run(entry, frequency, duration_ms, worst_delay_us, out);
+		}
+	}
+
+	if(out != stdout) {
+		fclose(out);
+	}
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,216 @@
+#include "../../includes/link_scheduler.h"
+
+#include <algorithm>
+
+LinkScheduler::LinkScheduler(uint_fast32_t chunk_size) {
+	chunk_size_ = chunk_size == 0 ? LINK_SCHEDULER_CHUNK_SIZE : chunk_size;
+	owner_ = -1;
+	pthread_mutex_init(&link_mutex_, NULL);
+	pthread_cond_init(&link_cond_, NULL);
+}
+
+int LinkScheduler::add_flow(uint_fast32_t tick_budget, uint_fast16_t weight) {
+	if(weight == 0) {
+		return -1;
+	}
+	MutexRAII prot_lock(link_mutex_);
+	prot_lock.lock_block();
+	//reuse the slot of a removed flow nothing waits on, with the next generation
+	uint_fast32_t slot = 0;
+	while(slot < flows_.size() && !(flows_[slot].removed && flows_[slot].waiters == 0)) {
+		slot++;
+	}
+	if(slot == (uint_fast32_t(1) << LINK_SCHEDULER_SLOT_BITS)) {
+		return -1;
+	}
+	Flow flow = {};
+	flow.tick_budget = tick_budget;
+	flow.quantum = uint_fast64_t(chunk_size_) * weight;
+	if(slot == flows_.size()) {
+		flows_.push_back(flow);
+	} else {
+		//the generation fits the bits of a positive id above the slot
+		flow.generation = (flows_[slot].generation + 1) % (1 << (31 - LINK_SCHEDULER_SLOT_BITS));
+		flows_[slot] = flow;
+	}
+	return int(slot | (flow.generation << LINK_SCHEDULER_SLOT_BITS));
+}
+
+void LinkScheduler::remove_flow(int flow_id) {
+	MutexRAII prot_lock(link_mutex_);
+	prot_lock.lock_block();
+	if(!is_flow(flow_id)) {
+		return;
+	}
+	leave_ring(flow_id);
+	get_flow(flow_id).removed = true;
+	advance();
+	//wake the pending acquire of the removed flow
+	pthread_cond_broadcast(&link_cond_);
+}
+
+uint_fast32_t LinkScheduler::get_chunk_size() {
+	return chunk_size_;
+}
+
+void LinkScheduler::begin_frame(int flow_id) {
+	MutexRAII prot_lock(link_mutex_);
+	prot_lock.lock_block();
+	if(!is_flow(flow_id)) {
+		return;
+	}
+	get_flow(flow_id).used = 0;
+}
+
+bool LinkScheduler::acquire(int flow_id, uint_fast32_t bytes) {
+	MutexRAII prot_lock(link_mutex_);
+	prot_lock.lock_block();
+	if(!is_flow(flow_id)) {
+		return false;
+	}
+	Flow& flow = get_flow(flow_id);
+	//the link is still kept for this flow from its last chunk
+	if(owner_ == flow_id) {
+		return true;
+	}
+	flow.request = std::min(bytes, chunk_size_);
+	if(!flow.in_ring) {
+		flow.in_ring = true;
+		flow.deficit = 0;
+		flow.has_quantum = false;
+		ring_.push_back(flow_id);
+	}
+	advance();
+	//add_flow(2) may resize the vector while waiting, so index it again, the
+	//slot isn't reused while it has waiters
+	get_flow(flow_id).waiters++;
+	while(owner_ != flow_id && !get_flow(flow_id).removed) {
+		pthread_cond_wait(&link_cond_, &link_mutex_);
+	}
+	get_flow(flow_id).waiters--;
+	return !get_flow(flow_id).removed;
+}
+
+void LinkScheduler::release(int flow_id, uint_fast32_t written_bytes) {
+	MutexRAII prot_lock(link_mutex_);
+	prot_lock.lock_block();
+	if(!is_flow(flow_id) || owner_ != flow_id) {
+		return;
+	}
+	Flow& flow = get_flow(flow_id);
+	flow.deficit -= std::min(uint_fast64_t(written_bytes), flow.deficit);
+	flow.used += written_bytes;
+	//the size of the next chunk is not known yet
+	flow.request = chunk_size_;
+
+	//keep the link while the flow can write another chunk in this round,
+	//unless it went over its budget while others within their budget have data.
+	bool over_budget = flow.tick_budget != 0 && flow.used >= flow.tick_budget;
+	bool others_in_budget = false;
+	for(uint_fast32_t i=0; i<ring_.size(); i++) {
+		const Flow& other = get_flow(ring_[i]);
+		if(ring_[i] != flow_id && (other.tick_budget == 0 || other.used < other.tick_budget)) {
+			others_in_budget = true;
+			break;
+		}
+	}
+	if(flow.deficit >= chunk_size_ && !(over_budget && others_in_budget)) {
+		return;
+	}
+
+	//the round of this flow ended, move it to the back of the ring
+	owner_ = -1;
+	flow.has_quantum = false;
+	std::deque<int>::iterator it = std::find(ring_.begin(), ring_.end(), flow_id);
+	if(it != ring_.end()) {
+		ring_.erase(it);
+		ring_.push_back(flow_id);
+	}
+	advance();
+}
+
+void LinkScheduler::end_frame(int flow_id) {
+	MutexRAII prot_lock(link_mutex_);
+	prot_lock.lock_block();
+	if(!is_flow(flow_id)) {
+		return;
+	}
+	leave_ring(flow_id);
+	advance();
+}
+
+void LinkScheduler::advance() {
+
+	if(owner_ != -1 || ring_.empty()) {
+		return;
+	}
+
+	//are there flows within their budget
+	bool in_budget = false;
+	for(uint_fast32_t i=0; i<ring_.size(); i++) {
+		const Flow& flow = get_flow(ring_[i]);
+		if(flow.tick_budget == 0 || flow.used < flow.tick_budget) {
+			in_budget = true;
+			break;
+		}
+	}
+
+	//each eligible flow gets its quantum on its visit and the quantum is at
+	//least one chunk, so two passes over the ring are enough.
+	//a flow in the ring is in the middle of a frame, it may be between two
+	//chunks and not in acquire(2) yet, the link is kept for it anyway so
+	//it doesn't lose its turn, acquire(2) then returns immediately.
+	for(uint_fast32_t visits = 0; visits < 2 * ring_.size(); visits++) {
+		int flow_id = ring_.front();
+		Flow& flow = get_flow(flow_id);
+		bool over_budget = flow.tick_budget != 0 && flow.used >= flow.tick_budget;
+		if(!(in_budget && over_budget)) {
+			if(!flow.has_quantum) {
+				flow.deficit += flow.quantum;
+				flow.has_quantum = true;
+			}
+			if(flow.deficit >= flow.request) {
+				owner_ = flow_id;
+				pthread_cond_broadcast(&link_cond_);
+				return;
+			}
+			flow.has_quantum = false;
+		}
+		ring_.pop_front();
+		ring_.push_back(flow_id);
+	}
+}
+
+void LinkScheduler::leave_ring(int flow_id) {
+	Flow& flow = get_flow(flow_id);
+	if(flow.in_ring) {
+		std::deque<int>::iterator it = std::find(ring_.begin(), ring_.end(), flow_id);
+		if(it != ring_.end()) {
+			ring_.erase(it);
+		}
+	}
+	flow.in_ring = false;
+	flow.deficit = 0;
+	flow.has_quantum = false;
+	if(owner_ == flow_id) {
+		owner_ = -1;
+	}
+}
+
+bool LinkScheduler::is_flow(int flow_id) {
+	if(flow_id < 0) {
+		return false;
+	}
+	uint_fast32_t slot = flow_id & ((1 << LINK_SCHEDULER_SLOT_BITS) - 1);
+	return slot < flows_.size() && !flows_[slot].removed &&
+		   flows_[slot].generation == uint_fast16_t(flow_id >> LINK_SCHEDULER_SLOT_BITS);
+}
+
+LinkScheduler::Flow& LinkScheduler::get_flow(int flow_id) {
+	return flows_[flow_id & ((1 << LINK_SCHEDULER_SLOT_BITS) - 1)];
+}
+
+LinkScheduler::~LinkScheduler() {
+	pthread_cond_destroy(&link_cond_);
+	pthread_mutex_destroy(&link_mutex_);
+}
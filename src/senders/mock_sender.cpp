@@ -0,0 +1,135 @@
+#include "../../includes/mock_sender.h"
+#include "../../includes/timers_utils.h"
+
+#include <algorithm>
+
+using namespace std;
+using namespace timers_utils;
+
+MockSender::MockSender() : error_handler_("MockSender") {
+	initialized_ = false;
+	completion_fn_ = [](uint_fast32_t, uint_fast64_t) {
+		return uint_fast64_t(0);
+	};
+	packets_list_ = NULL;
+	frame_bytes_ = 0;
+	send_start_ns_ = 0;
+	send_time_ns_ = 0;
+	delivery_rate_ = 0;
+	is_reconnecting_ = false;
+	sent_frames_ = 0;
+	done_frames_ = 0;
+}
+
+void MockSender::set_completion_fn(CompletionFn completion_fn) {
+	completion_fn_ = completion_fn;
+}
+
+void MockSender::set_reconnecting(bool is_reconnecting) {
+	is_reconnecting_ = is_reconnecting;
+}
+
+uint_fast32_t MockSender::get_sent_frames() {
+	return sent_frames_;
+}
+
+uint_fast32_t MockSender::get_done_frames() {
+	return done_frames_;
+}
+
+bool MockSender::initialize() {
+	end_sender();
+	delivery_rate_ = 0;
+	sent_frames_ = 0;
+	done_frames_ = 0;
+	initialized_ = true;
+	return true;
+}
+
+bool MockSender::send(DataPacketsList* list) {
+
+	//if the object not yet initialized
+	if(!initialized_) {
+		error_handler_.set_error("You must initialize the sender object first");
+		return false;
+	}
+
+	//if there is already send operation, then decline this send operation
+	if(!is_send_done()) {
+		error_handler_.set_error("system called send(DataPacketsList*) while on going send operation.");
+		return false;
+	}
+
+	packets_list_ = list;
+	frame_bytes_ = 0;
+	for(uint_fast32_t i=0; i<list->num_packets; i++) {
+		frame_bytes_ += list->packets[i].data_size;
+	}
+	send_start_ns_ = monotonic_ns();
+	send_time_ns_ = completion_fn_(sent_frames_, frame_bytes_);
+	sent_frames_++;
+	return true;
+}
+
+bool MockSender::is_send_done() {
+	if(packets_list_ == NULL) {
+		return true;
+	}
+	if(send_time_ns_ == MOCK_SENDER_NEVER || monotonic_ns() - send_start_ns_ < send_time_ns_) {
+		return false;
+	}
+	//the frame is done
+	if(send_time_ns_ != 0) {
+		delivery_rate_ = frame_bytes_ * SEC_TO_NS(1) / send_time_ns_;
+	}
+	packets_list_->release_packets();
+	packets_list_ = NULL;
+	done_frames_++;
+	return true;
+}
+
+bool MockSender::get_link_state(SenderLinkState* state) {
+	if(!initialized_) {
+		return false;
+	}
+	*state = SenderLinkState();
+	state->delivery_rate = delivery_rate_;
+	if(!is_send_done()) {
+		uint_fast64_t unsent_bytes = frame_bytes_;
+		if(send_time_ns_ != MOCK_SENDER_NEVER) {
+			uint_fast64_t remaining_ns = send_time_ns_ - std::min(send_time_ns_, monotonic_ns() - send_start_ns_);
+			unsent_bytes = uint_fast64_t(double(frame_bytes_) * remaining_ns / send_time_ns_);
+		}
+		state->queued_bytes = unsent_bytes;
+		state->unsent_bytes = unsent_bytes;
+	}
+	return true;
+}
+
+bool MockSender::is_reconnecting() {
+	return initialized_ && is_reconnecting_;
+}
+
+bool MockSender::end_sender() {
+	initialized_ = false;
+	//drop the frame not sent yet
+	if(packets_list_ != NULL) {
+		packets_list_->release_packets();
+		packets_list_ = NULL;
+	}
+	return true;
+}
+
+string MockSender::get_error() {
+	string error = error_handler_.get_error();
+	error_handler_.clear_error();
+	return error;
+}
+
+bool MockSender::is_error() {
+	return error_handler_.is_error();
+}
+
+MockSender::~MockSender() {
+	end_sender();
+}
@@ -0,0 +1,481 @@
+#include "../../includes/shm_sender.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+
+namespace shm_sender{
+
+	#define END_THREAD_ERROR(ERROR_FLAG, ERROR_CODE)\
+		shared_data->is_error = (ERROR_FLAG);	\
+		shared_data->error_code = (ERROR_CODE);	\
+		data_to_be_sent.release_packets();	\
+		prot_lock.~MutexRAII(); 		\
+		prot_term_flag.~AtomicValRAII();	\
+		pthread_exit(NULL)
+
+	enum SHM_SENDER_ERROR_CODES
+	 {CANT_CPU_AFFINITY, READING_ERROR, NOT_SUPPORTED_DATA_TYPE, NO_ERROR, CANT_MEMORY_NODE};
+}
+
+using namespace shm_sender;
+using namespace timers_utils;
+
+//give back the cursors of the consumers which died without closing, only
+//checked for the consumers behind the ring
+static void reclaim_cursors(ShmRingHeader* ring, const ShmRingLayout& layout, uint64_t sequence) {
+	for(int i=0; i<SHM_RING_MAX_CONSUMERS; i++) {
+		ShmConsumerCursor* cursor = ring->cursors + i;
+		uint32_t pid = cursor->pid.load(std::memory_order_relaxed);
+		if(pid != 0 && cursor->next_frame.load(std::memory_order_relaxed) + layout.slots <= sequence &&
+		   kill(pid, 0) == -1 && errno == ESRCH) {
+			cursor->pid.compare_exchange_strong(pid, 0);
+		}
+	}
+}
+
+static void* shm_worker_function(void* data) {
+	ShmWorkerData* worker_data = (ShmWorkerData*) data;
+	//the shared data between the main thread and the worker thread.
+	SenderWorkerData* shared_data = worker_data->shared_data;
+	ShmRingHeader* ring = worker_data->ring;
+	const ShmRingLayout layout = worker_data->layout;
+	//release the lock whenever the scope of this function end
+	MutexRAII prot_lock(shared_data->packets_mutex);
+	//set the termination flag of this thread to true whenever this
+	//function goes out of scope.
+	AtomicValRAII<bool> prot_term_flag(shared_data->is_terminated_thread, true);
+	//this is the buffer to copy data from the shared buffer to be sent later.
+	DataPacketsList data_to_be_sent(0);
+	//stick the thread to the placement cores
+	if(!thread_placement::set_affinity(shared_data->placement)) {
+		END_THREAD_ERROR(true, CANT_CPU_AFFINITY);
+	}
+	//prefer the placement memory node
+	if(!thread_placement::set_memory_node(shared_data->placement)) {
+		END_THREAD_ERROR(true, CANT_MEMORY_NODE);
+	}
+	trace_events::set_thread_name("ShmSender worker");
+	//the frames are published without the counters if none can be opened
+	if(shared_data->perf_counters) {
+		shared_data->perf.open();
+	}
+	//the sequence of the frame, the first one is 1
+	uint64_t sequence = ring->last_frame.load() + 1;
+	//start the publishing loop
+	while(!shared_data->terminate_thread) {
+		/**
+		 * take the data from the buffer if available
+		 **/
+		//acquire the lock
+		prot_lock.lock_block();
+
+		//check if there is no data
+		while(shared_data->packets_list == NULL) {
+			//check if the signal due to the termination
+			if(shared_data->terminate_thread) {
+				END_THREAD_ERROR(false, NO_ERROR);
+			}
+			//if no data yet and no termination signal arrived, then wait on the
+			//condition
+			pthread_cond_wait(&(shared_data->packets_cond), &(shared_data->packets_mutex));
+		}
+		//copy the data to the buffer to be sent later
+		data_to_be_sent = *(shared_data->packets_list);
+		shared_data->packets_list = NULL;
+		//release the lock
+		prot_lock.unlock();
+		trace_events::begin("frame");
+		shared_data->usage.begin();
+		shared_data->perf.begin();
+
+		/**
+		 * write the frame in its slot, the slot is marked empty meanwhile so
+		 * a consumer still reading the old frame finds it overwritten
+		 **/
+		ShmSlotHeader* slot = shm_ring::slot(ring, layout, sequence);
+		slot->sequence.store(0, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		char* slot_data = shm_ring::slot_data(slot);
+		uint_fast64_t frame_bytes = 0;
+		for(uint_fast32_t i=0; i<data_to_be_sent.num_packets; i++) {
+			DataPacket* current_packet = (data_to_be_sent.packets) + i;
+			if(current_packet->data_ptr_type == DataPacket::DATA_PTR_MEMORY_LOCATION) {
+				trace_events::begin("memcpy", current_packet->data_size);
+				memcpy(slot_data + frame_bytes, ((char*)current_packet->data_ptr) + current_packet->data_offset, current_packet->data_size);
+				trace_events::end("memcpy");
+			} else if(current_packet->data_ptr_type == DataPacket::DATA_PTR_FILE_DESCRIPTOR) {
+				//read the packet from the file descriptor
+				uint_fast32_t data_read = 0;
+				while(data_read < current_packet->data_size) {
+					trace_events::begin("pread", current_packet->data_size - data_read);
+					ssize_t r = pread(*((int*)current_packet->data_ptr), slot_data + frame_bytes + data_read,
+									  current_packet->data_size - data_read, current_packet->data_offset + data_read);
+					trace_events::end("pread");
+					if(r <= 0) {
+						END_THREAD_ERROR(true, READING_ERROR);
+					}
+					data_read += r;
+				}
+			} else {
+				END_THREAD_ERROR(true, NOT_SUPPORTED_DATA_TYPE);
+			}
+			slot->packet_sizes[i] = current_packet->data_size;
+			frame_bytes += current_packet->data_size;
+		}
+		slot->frame_size = frame_bytes;
+		slot->num_packets = data_to_be_sent.num_packets;
+		slot->timestamp_ns = monotonic_ns();
+		slot->sequence.store(sequence, std::memory_order_release);
+		shm_ring::publish(ring, sequence);
+		reclaim_cursors(ring, layout, sequence);
+
+		//the data is in the ring, give the packets back
+		data_to_be_sent.release_packets();
+		shared_data->perf.end(frame_bytes);
+		shared_data->usage.end(sequence++);
+		//mark the send as done
+		shared_data->is_done = true;
+		trace_events::end("frame");
+	}
+
+	END_THREAD_ERROR(false, NO_ERROR);
+}
+
+ShmSender::ShmSender(uint_fast32_t slot_capacity, uint_fast32_t slots) : error_handler_("ShmSender"), worker_placement_(CPU_CORE_AFFINITY, 98) {
+	slots_ = slots;
+	slot_capacity_ = slot_capacity;
+	ring_fd_ = -1;
+	ring_ = NULL;
+	initialized_ = false;
+	usage_accounting_ = false;
+	perf_counters_ = false;
+	worker_running_ = false;
+	frame_bytes_ = 0;
+}
+
+bool ShmSender::create_ring() {
+	ring_layout_ = shm_ring::layout(slots_, slot_capacity_);
+	ring_fd_ = memfd_create("rtdt-shm-ring", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if(ring_fd_ == -1) {
+		error_handler_.set_error(std::string("Can't create the memfd of the ring : ") + strerror(errno));
+		return false;
+	}
+	if(ftruncate(ring_fd_, ring_layout_.size) == -1) {
+		error_handler_.set_error(std::string("Can't size the ring : ") + strerror(errno));
+		return false;
+	}
+	//the consumers map the whole ring, it must not shrink under them
+	if(fcntl(ring_fd_, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) == -1) {
+		error_handler_.set_error(std::string("Can't seal the ring : ") + strerror(errno));
+		return false;
+	}
+	void* memory = mmap(NULL, ring_layout_.size, PROT_READ | PROT_WRITE, MAP_SHARED, ring_fd_, 0);
+	if(memory == MAP_FAILED) {
+		error_handler_.set_error(std::string("Can't map the ring : ") + strerror(errno));
+		return false;
+	}
+	//touch every page now, the frames don't fault in the real time loop
+	memset(memory, 0, ring_layout_.size);
+	ring_ = (ShmRingHeader*) memory;
+	ring_->slots = ring_layout_.slots;
+	ring_->slot_capacity = ring_layout_.slot_capacity;
+	ring_->slot_stride = ring_layout_.slot_stride;
+	ring_->slots_offset = ring_layout_.slots_offset;
+	ring_->last_frame.store(0);
+	ring_->futex.store(0);
+	ring_->closed.store(0);
+	//the consumers check the magic last
+	ring_->version = SHM_RING_VERSION;
+	std::atomic_thread_fence(std::memory_order_release);
+	ring_->magic = SHM_RING_MAGIC;
+	return true;
+}
+
+std::string ShmSender::get_consumer_path() {
+	if(ring_fd_ == -1) {
+		return "";
+	}
+	return "/proc/" + std::to_string(getpid()) + "/fd/" + std::to_string(ring_fd_);
+}
+
+uint_fast32_t ShmSender::get_consumers() {
+	uint_fast32_t consumers = 0;
+	for(int i=0; ring_ != NULL && i<SHM_RING_MAX_CONSUMERS; i++) {
+		consumers += ring_->cursors[i].pid.load(std::memory_order_relaxed) != 0;
+	}
+	return consumers;
+}
+
+bool ShmSender::set_worker_placement(const ThreadPlacement& placement) {
+	if(!thread_placement::is_valid(placement)) {
+		error_handler_.set_error("Invalid placement, no cores or priority out of range");
+		return false;
+	}
+	worker_placement_ = placement;
+	return true;
+}
+
+void ShmSender::set_usage_accounting(bool enabled) {
+	usage_accounting_ = enabled;
+}
+
+void ShmSender::get_worker_usage_stats(ThreadUsageStats* stats) {
+	shared_data_.usage.get_stats(stats);
+}
+
+void ShmSender::set_perf_counters(bool enabled) {
+	perf_counters_ = enabled;
+}
+
+void ShmSender::get_worker_perf_stats(PerfCounterStats* stats) {
+	shared_data_.perf.get_stats(stats);
+}
+
+bool ShmSender::initialize() {
+
+	//clean the last state
+	//destroying the thread
+	//unmapping the ring
+	end_sender();
+
+	if(slots_ == 0 || slot_capacity_ == 0) {
+		error_handler_.set_error("The ring needs at least one slot of one byte.");
+		return false;
+	}
+
+	//re initialize the shared data
+	shared_data_.packets_list = NULL;
+	shared_data_.is_done = true;
+	shared_data_.is_error = false;
+	shared_data_.terminate_thread = false;
+	shared_data_.error_code = 0;
+	shared_data_.placement = worker_placement_;
+	shared_data_.usage.set_enabled(usage_accounting_);
+	shared_data_.usage.reset();
+	shared_data_.perf_counters = perf_counters_;
+	shared_data_.perf.reset();
+	shared_data_.packets_mutex = PTHREAD_MUTEX_INITIALIZER;
+	shared_data_.packets_cond = PTHREAD_COND_INITIALIZER;
+	frame_bytes_ = 0;
+
+	if(!create_ring()) {
+		end_sender();
+		return false;
+	}
+
+	//create thread
+	struct sched_param param;
+	pthread_attr_t attr;
+	int ret;
+
+	/* Initialize pthread attributes (default values) */
+	ret = pthread_attr_init(&attr);
+	if (ret) {
+		error_handler_.set_error("init pthread attributes failed");
+		return false;
+	}
+
+	/* Set a specific stack size  */
+	ret = pthread_attr_setstacksize(&attr, PTHREAD_STACK_MIN);
+	if (ret) {
+		error_handler_.set_error("pthread setstacksize failed");
+		return false;
+	}
+
+	/* Set scheduler policy and priority of pthread */
+	ret = pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+	if (ret) {
+		error_handler_.set_error("pthread setschedpolicy failed");
+		return false;
+	}
+	param.sched_priority = worker_placement_.priority;
+	ret = pthread_attr_setschedparam(&attr, &param);
+	if (ret) {
+		error_handler_.set_error("pthread setschedparam failed");
+		return false;
+	}
+
+	/* Use scheduling parameters of attr */
+	ret = pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+	if (ret) {
+		error_handler_.set_error("pthread setinheritsched failed");
+		return false;
+	}
+
+	//the worker sets it back when it ends
+	worker_data_.shared_data = &shared_data_;
+	worker_data_.ring = ring_;
+	worker_data_.layout = ring_layout_;
+	shared_data_.is_terminated_thread = false;
+	int th_st = pthread_create(&worker_thread_, &attr, shm_worker_function, (void*) &worker_data_);
+	if(th_st) {
+		shared_data_.is_terminated_thread = true;
+		error_handler_.set_error("pthread_create() return code: " + std::to_string(th_st));
+		return false;
+	}
+	worker_running_ = true;
+
+	initialized_ = true;
+	return true;
+}
+
+bool ShmSender::send(DataPacketsList* list) {
+
+	//if the object not yet initialized
+	if(!initialized_) {
+		error_handler_.set_error("You must initialize the sender object first");
+		return false;
+	}
+
+	//if the sender worker thread terminates, get the error from it
+	if(shared_data_.is_terminated_thread) {
+		if(!shared_data_.is_error) {
+			error_handler_.set_error("No Thread Available to execute the send operation");
+			return false;
+		}
+		switch(shared_data_.error_code) {
+			case CANT_CPU_AFFINITY:
+				error_handler_.set_error("Sender worker thread can't set CPU Affinity.");
+			break;
+			case READING_ERROR:
+				error_handler_.set_error("Sender worker thread, error while reading the file descriptor packet.");
+			break;
+			case NOT_SUPPORTED_DATA_TYPE:
+				error_handler_.set_error("Sender worker thread can't send that type of packets.");
+			break;
+			case CANT_MEMORY_NODE:
+				error_handler_.set_error("Sender worker thread can't set the preferred memory node.");
+			break;
+			default:
+				error_handler_.set_error("Unknown error in sender worker thread.");
+			break;
+		}
+		return false;
+	}
+
+	//if there is already send operation, then decline this send operation
+	if(!shared_data_.is_done) {
+		error_handler_.set_error("system called send(DataPacketsList*) while on going send operation.");
+		return false;
+	}
+
+	//the frame must fit a slot
+	uint_fast64_t frame_bytes = 0;
+	for(uint_fast32_t i=0; i<list->num_packets; i++) {
+		frame_bytes += list->packets[i].data_size;
+	}
+	if(list->num_packets > SHM_RING_MAX_PACKETS || frame_bytes > slot_capacity_) {
+		error_handler_.set_error("The frame of " + std::to_string(frame_bytes) + " bytes in " +
+			std::to_string(list->num_packets) + " packets doesn't fit the slots of " +
+			std::to_string(slot_capacity_) + " bytes.");
+		return false;
+	}
+	frame_bytes_ = frame_bytes;
+
+	//release the lock whenever the scope of this function end
+	MutexRAII prot_lock(shared_data_.packets_mutex);
+
+	//add the data, set the is_done flag, and signal the thread
+	prot_lock.lock_block();
+	shared_data_.packets_list = list;
+	shared_data_.is_done = false;
+	pthread_cond_signal(&(shared_data_.packets_cond));
+	prot_lock.unlock();
+	return true;
+
+}
+
+bool ShmSender::is_send_done() {
+	return shared_data_.is_done;
+}
+
+bool ShmSender::get_link_state(SenderLinkState* state) {
+	if(!initialized_) {
+		return false;
+	}
+	*state = SenderLinkState();
+	uint64_t last_frame = ring_->last_frame.load(std::memory_order_acquire);
+	//the oldest frame not read by an attached consumer
+	uint64_t oldest_unread = last_frame + 1;
+	for(int i=0; i<SHM_RING_MAX_CONSUMERS; i++) {
+		if(ring_->cursors[i].pid.load(std::memory_order_relaxed) != 0) {
+			oldest_unread = std::min(oldest_unread, ring_->cursors[i].next_frame.load(std::memory_order_relaxed));
+		}
+	}
+	if(last_frame >= ring_layout_.slots) {
+		oldest_unread = std::max(oldest_unread, last_frame - ring_layout_.slots + 1);
+	}
+	uint_fast64_t queued_bytes = 0;
+	for(uint64_t sequence = std::max(oldest_unread, uint64_t(1)); sequence <= last_frame; sequence++) {
+		queued_bytes += shm_ring::slot(ring_, ring_layout_, sequence)->frame_size;
+	}
+	if(!shared_data_.is_done) {
+		state->unsent_bytes = frame_bytes_;
+		queued_bytes += frame_bytes_;
+	}
+	state->queued_bytes = std::min(queued_bytes, uint_fast64_t(UINT32_MAX));
+	return true;
+}
+
+bool ShmSender::is_reconnecting() {
+	return false;
+}
+
+bool ShmSender::end_sender() {
+
+	//mark it as uninitialized
+	initialized_ = false;
+
+	//end the thread if it was started
+	if(worker_running_) {
+		//signal the thread to terminate
+		shared_data_.terminate_thread = true;
+		MutexRAII prot_lock(shared_data_.packets_mutex);
+		prot_lock.lock_block();
+		//drop the data the worker didn't take
+		if(shared_data_.packets_list != NULL) {
+			shared_data_.packets_list->release_packets();
+		}
+		shared_data_.packets_list = NULL;
+		shared_data_.is_done = false;
+		pthread_cond_signal(&(shared_data_.packets_cond));
+		prot_lock.unlock();
+		//wait until the thread terminates
+		pthread_join(worker_thread_, NULL);
+		worker_running_ = false;
+	}
+	//the counters of the ended worker, their stats are kept
+	shared_data_.perf.close();
+
+	//wake the consumers, the ring stays with the ones which mapped it
+	if(ring_ != NULL) {
+		shm_ring::close(ring_);
+		munmap(ring_, ring_layout_.size);
+		ring_ = NULL;
+	}
+	if(ring_fd_ != -1) {
+		close(ring_fd_);
+		ring_fd_ = -1;
+	}
+	return true;
+}
+
+std::string ShmSender::get_error() {
+	std::string error = error_handler_.get_error();
+	error_handler_.clear_error();
+	return error;
+}
+
+bool ShmSender::is_error() {
+	return error_handler_.is_error();
+}
+
+ShmSender::~ShmSender() {
+	end_sender();
+}
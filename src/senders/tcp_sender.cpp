@@ -5,24 +5,189 @@ namespace tcp_sender{
 	#define END_THREAD_ERROR(ERROR_FLAG, ERROR_CODE)\
 		shared_data->is_error = (ERROR_FLAG);	\
 		shared_data->error_code = (ERROR_CODE);	\
+		end_link_frame(shared_data);		\
+		data_to_be_sent.release_packets();	\
 		prot_lock.~MutexRAII(); 		\
+		write_path->close(shared_data);		\
 		prot_term_flag.~AtomicValRAII();	\
 		pthread_exit(NULL)						
 
+	//drop the frame and wait for a new client if the sender reconnects
+	#define LOST_CLIENT(ERROR_CODE)\
+		if(!shared_data->reconnect) {		\
+			END_THREAD_ERROR(true, (ERROR_CODE));	\
+		}					\
+		goto lost_client
+
 	enum TCP_SENDER_ERROR_CODES
 	 {CANT_CPU_AFFINITY, CANT_SOCKET_TIMEOUT, SENDING_ERROR,
-	  NOT_SUPPORTED_DATA_TYPE, NO_ERROR, CANT_SOCKET_BUFFERS};
+	  NOT_SUPPORTED_DATA_TYPE, NO_ERROR, CANT_SOCKET_BUFFERS, CANT_MEMORY_NODE,
+	  WRITE_PATH_ERROR};
 }
 
 using namespace tcp_sender;
 using namespace timers_utils;
 
+//give up the link when the worker ends in the middle of a frame
+static void end_link_frame(SenderWorkerData* shared_data) {
+	if(shared_data->link != NULL) {
+		shared_data->link->end_frame(shared_data->link_flow);
+	}
+}
+
+//set the timeout and the buffers of the client socket, then let the write
+//path prepare it
+//returns NO_ERROR if done, the error code otherwise.
+static int configure_socket(SenderWorkerData* shared_data, TCPWritePath* write_path) {
+	//set the timeout to the socket to 1 second
+	struct timeval timeout;
+	timeout.tv_sec = 1;
+	timeout.tv_usec = 0;
+	if(setsockopt(shared_data->sock_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(struct timeval)) < 0) {
+		return CANT_SOCKET_TIMEOUT;
+	}
+	//set buffer sizes for send and recv, sized from the rtt measured while
+	//connecting if the stream profile is known
+	int buff_size = shared_data->send_buffer_size;
+	if(shared_data->auto_frame_bytes != 0) {
+		SenderLinkState state;
+		uint_fast32_t rtt_us = 0;
+		if(socket_utils::get_tcp_link_state(shared_data->sock_fd, &state)) {
+			rtt_us = state.rtt_us;
+		}
+		buff_size = socket_utils::tcp_send_buffer_size(shared_data->auto_frame_bytes, shared_data->auto_frequency, rtt_us);
+	}
+	if(setsockopt(shared_data->sock_fd, SOL_SOCKET, SO_SNDBUF, &buff_size, sizeof(buff_size)) < 0) {
+		return CANT_SOCKET_BUFFERS;
+	}
+	//limit the not sent data in the socket
+	if(shared_data->notsent_lowat != 0) {
+		int lowat = shared_data->notsent_lowat;
+		if(setsockopt(shared_data->sock_fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT, &lowat, sizeof(lowat)) < 0) {
+			return CANT_SOCKET_BUFFERS;
+		}
+	}
+	buff_size = TCP_SENDER_RECV_BUFFER;
+	if(setsockopt(shared_data->sock_fd, SOL_SOCKET, SO_RCVBUF, &buff_size, sizeof(buff_size)) < 0) {
+		return CANT_SOCKET_BUFFERS;
+	}
+	if(!write_path->client_opened(shared_data)) {
+		return WRITE_PATH_ERROR;
+	}
+	return NO_ERROR;
+}
+
+//close the socket of the lost or replaced client
+static void close_client(SenderWorkerData* shared_data) {
+	//get_link_state(1) may be querying the socket
+	MutexRAII sock_lock(shared_data->sock_mutex);
+	sock_lock.lock_block();
+	int sock_fd = shared_data->sock_fd.exchange(-1);
+	if(sock_fd != -1) {
+		shutdown(sock_fd, SHUT_RDWR);
+		close(sock_fd);
+	}
+}
+
+//wait backoff_ms after a failed client then double it up to
+//TCP_SENDER_ACCEPT_BACKOFF_MS, so the worker doesn't spin on its core while
+//accept(2) keeps failing (out of descriptors or memory), the termination
+//signal ends the wait.
+static void accept_backoff(SenderWorkerData* shared_data, uint_fast32_t* backoff_ms) {
+	struct pollfd pfd;
+	pfd.fd = shared_data->wake_fd;
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+	poll(&pfd, 1, *backoff_ms);
+	*backoff_ms = std::min(*backoff_ms * 2, uint_fast32_t(TCP_SENDER_ACCEPT_BACKOFF_MS));
+}
+
+//wait for a client on the server and set its socket options, the send stays
+//not done meanwhile so the system skips the ticks, it's done once the
+//client is ready.
+//returns true if a client is connected, false if the worker must terminate.
+static bool wait_client(SenderWorkerData* shared_data, TCPWritePath* write_path) {
+	shared_data->is_reconnecting = true;
+	int client_fd;
+	uint_fast32_t backoff_ms = 1;
+	while(!shared_data->terminate_thread) {
+		//wakes on a client or on the termination signal
+		if(!socket_utils::accept_client(shared_data->server_sock_fd, shared_data->wake_fd, -1, &client_fd)) {
+			accept_backoff(shared_data, &backoff_ms);
+			continue;
+		}
+		shared_data->sock_fd = client_fd;
+		if(configure_socket(shared_data, write_path) == NO_ERROR) {
+			shared_data->is_done = true;
+			shared_data->is_reconnecting = false;
+			return true;
+		}
+		close_client(shared_data);
+		accept_backoff(shared_data, &backoff_ms);
+	}
+	return false;
+}
+
+TCPWritePath::TCPWritePath(std::string owner_identifier) : error_handler_(owner_identifier) {
+}
+
+bool TCPWritePath::open(SenderWorkerData* shared_data) {
+	return true;
+}
+
+bool TCPWritePath::client_opened(SenderWorkerData* shared_data) {
+	return true;
+}
+
+void TCPWritePath::close(SenderWorkerData* shared_data) {
+}
+
+void TCPWritePath::wait_packets(SenderWorkerData* shared_data) {
+	pthread_cond_wait(&(shared_data->packets_cond), &(shared_data->packets_mutex));
+}
+
+ssize_t TCPWritePath::write_header(SenderWorkerData* shared_data, const char* data, uint_fast32_t size) {
+	trace_events::begin("send", size);
+	ssize_t s = ::send(shared_data->sock_fd, data, size, 0);
+	trace_events::end("send");
+	return s;
+}
+
+ssize_t TCPWritePath::write_memory(SenderWorkerData* shared_data, const char* data, uint_fast32_t size, bool more) {
+	trace_events::begin("send", size);
+	ssize_t s = ::send(shared_data->sock_fd, data, size, 0);
+	trace_events::end("send");
+	return s;
+}
+
+void TCPWritePath::file_written(ssize_t bytes) {
+}
+
+bool TCPWritePath::frame_written(SenderWorkerData* shared_data, DataPacketsList* frame) {
+	//the data is copied to the socket, give it back to its owner
+	frame->release_packets();
+	return true;
+}
+
+bool TCPWritePath::client_closed(SenderWorkerData* shared_data) {
+	return true;
+}
+
+std::string TCPWritePath::get_error() {
+	std::string error = error_handler_.get_error();
+	error_handler_.clear_error();
+	return error;
+}
+
+TCPWritePath::~TCPWritePath() {
+}
+
 static void* tcp_worker_function(void* data) {
+	TCPWorkerData* worker_data = (TCPWorkerData*) data;
 	//the shared data between the main thread and the worker thread.
-	SenderWorkerData* shared_data = (SenderWorkerData*) data;
-	//I'm alive!
-	shared_data->is_terminated_thread = false;
-	shared_data->thread_initialized = true;
+	SenderWorkerData* shared_data = worker_data->shared_data;
+	//the way the frames are written to the socket
+	TCPWritePath* write_path = worker_data->write_path;
 	//release the lock whenever the scope of this function end
 	MutexRAII prot_lock(shared_data->packets_mutex);
 	//set the termination flag of this thread to true whenever this
@@ -30,29 +195,43 @@ static void* tcp_worker_function(void* data) {
 	AtomicValRAII<bool> prot_term_flag(shared_data->is_terminated_thread, true);
 	//this is the buffer to copy data from the shared buffer to be sent later.
 	DataPacketsList data_to_be_sent(0);
-	//stick the thread to core 0
-	cpu_set_t cpuset;
-	CPU_ZERO(&cpuset);
-	CPU_SET(CPU_CORE_AFFINITY, &cpuset);
-	if(pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset) != 0) {
+	//stick the thread to the placement cores
+	if(!thread_placement::set_affinity(shared_data->placement)) {
 		END_THREAD_ERROR(true, CANT_CPU_AFFINITY);
 	}
-	//set the timeout to the socket to 1 second
-	struct timeval timeout;
-	timeout.tv_sec = 1;
-	timeout.tv_usec = 0;
-	if(setsockopt(shared_data->sock_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(struct timeval)) < 0) {
-		END_THREAD_ERROR(true, CANT_SOCKET_TIMEOUT);
+	//prefer the placement memory node
+	if(!thread_placement::set_memory_node(shared_data->placement)) {
+		END_THREAD_ERROR(true, CANT_MEMORY_NODE);
 	}
-	//set buffer sizes for send and recv
-	int buff_size = TCP_SENDER_SEND_BUFFER;
-	if(setsockopt(shared_data->sock_fd, SOL_SOCKET, SO_SNDBUF, &buff_size, sizeof(buff_size)) < 0) {
-		END_THREAD_ERROR(true, CANT_SOCKET_BUFFERS);
+	if(!write_path->open(shared_data)) {
+		END_THREAD_ERROR(true, WRITE_PATH_ERROR);
 	}
-	buff_size = TCP_SENDER_RECV_BUFFER;
-	if(setsockopt(shared_data->sock_fd, SOL_SOCKET, SO_RCVBUF, &buff_size, sizeof(buff_size)) < 0) {
-		END_THREAD_ERROR(true, CANT_SOCKET_BUFFERS);
+	trace_events::set_thread_name((worker_data->thread_name + " worker").c_str());
+	//the frames are sent without the counters if none can be opened
+	if(shared_data->perf_counters) {
+		shared_data->perf.open();
 	}
+	//wait for the first client if the server accepts it in the background,
+	//otherwise set the options of the client accepted by initialize(0)
+	int socket_error = NO_ERROR;
+	if(shared_data->sock_fd == -1) {
+		if(!wait_client(shared_data, write_path)) {
+			END_THREAD_ERROR(false, NO_ERROR);
+		}
+	} else {
+		socket_error = configure_socket(shared_data, write_path);
+		if(socket_error != NO_ERROR) {
+			END_THREAD_ERROR(true, socket_error);
+		}
+	}
+	//the socket of a replacement client
+	int client_fd = -1;
+	//frames counter - used for the frame header
+	uint32_t frame_sequence = 0;
+	//frames counter - used for the usage accounting
+	uint_fast32_t frame_number = 0;
+	//bytes of the frame - used for the perf counters
+	uint_fast64_t frame_bytes = 0;
 	//start the sending loop
 	while(!shared_data->terminate_thread) {
 		/** 
@@ -68,28 +247,85 @@ static void* tcp_worker_function(void* data) {
 				END_THREAD_ERROR(false, NO_ERROR);
 			}
 			//if no data yet and no termination signal arrived, then wait on the condition
-			pthread_cond_wait(&(shared_data->packets_cond), &(shared_data->packets_mutex));
+			write_path->wait_packets(shared_data);
 		}
 		//copy the data to the buffer to be sent later
 		data_to_be_sent = *(shared_data->packets_list);
 		shared_data->packets_list = NULL;
 		//release the lock
 		prot_lock.unlock();
+		trace_events::begin("frame");
+		shared_data->usage.begin();
+		shared_data->perf.begin();
+		//move to a replacement client at the frame boundary
+		if(shared_data->reconnect && socket_utils::accept_client(shared_data->server_sock_fd, -1, 0, &client_fd)) {
+			if(!write_path->client_closed(shared_data)) {
+				close(client_fd);
+				END_THREAD_ERROR(true, WRITE_PATH_ERROR);
+			}
+			close_client(shared_data);
+			shared_data->sock_fd = client_fd;
+			socket_error = configure_socket(shared_data, write_path);
+			if(socket_error != NO_ERROR) {
+				LOST_CLIENT(socket_error);
+			}
+		}
+		//renew the budget of this stream on the link
+		if(shared_data->link != NULL) {
+			shared_data->link->begin_frame(shared_data->link_flow);
+		}
+		/** 
+		 * send the frame header if needed, the crc is calculated right before
+		 * sending so the data stays hot in the cache.
+		 **/
+		if(shared_data->frame_crc) {
+			FrameHeader header;
+			frame_header::build(data_to_be_sent, frame_sequence++, &header);
+			uint_fast32_t data_sent = 0, remaining_data = sizeof(header);
+			while(remaining_data != 0) {
+				//try to send, the header is copied
+				ssize_t s = write_path->write_header(shared_data, ((char*)&header) + data_sent, remaining_data);
+				//detect error
+				if(s < 0) {
+					LOST_CLIENT(SENDING_ERROR);
+				}
+				//update state variables
+				data_sent += s;
+				remaining_data -= s;
+			}
+		}
 		/** 
 		 * send all the data from the buffer list
 		 **/
-		for(int i=0; i<data_to_be_sent.num_packets; i++) {
+		for(uint_fast32_t i=0; i<data_to_be_sent.num_packets; i++) {
 			//get the packet to be sent
 			DataPacket* current_packet = (data_to_be_sent.packets) + i;
+			bool last_packet = i + 1 == data_to_be_sent.num_packets;
+			RTDT_PROBE2(packet__send__start, i, current_packet->data_size);
 			if (current_packet->data_ptr_type == DataPacket::DATA_PTR_MEMORY_LOCATION) {
 				//send the packet from memory location
 				uint_fast32_t data_sent = current_packet->data_offset, remaining_data = current_packet->data_size;
 				while(remaining_data != 0) {
+					//wait for the turn of this stream on the link
+					uint_fast32_t chunk = remaining_data;
+					if(shared_data->link != NULL) {
+						chunk = std::min(chunk, shared_data->link->get_chunk_size());
+						if(!shared_data->link->acquire(shared_data->link_flow, chunk)) {
+							END_THREAD_ERROR(false, NO_ERROR);
+						}
+					}
 					//try to send
-					ssize_t s = send(shared_data->sock_fd, ((char*)current_packet->data_ptr) + data_sent, remaining_data, 0);
+					ssize_t s = write_path->write_memory(shared_data, ((char*)current_packet->data_ptr) + data_sent,
+														 chunk, !last_packet || chunk < remaining_data);
+					if(shared_data->link != NULL) {
+						shared_data->link->release(shared_data->link_flow, s > 0 ? s : 0);
+					}
 					//detect error
+					if(s == 0) {
+						END_THREAD_ERROR(true, WRITE_PATH_ERROR);
+					}
 					if(s < 0) {
-						END_THREAD_ERROR(true, SENDING_ERROR);
+						LOST_CLIENT(SENDING_ERROR);
 					}
 					//check thread termination signal
 					if(shared_data->terminate_thread) {
@@ -104,42 +340,111 @@ static void* tcp_worker_function(void* data) {
 				uint_fast32_t remaining_data = current_packet->data_size;
 				off_t offset = current_packet->data_offset;
 				while(remaining_data != 0) {
+					//wait for the turn of this stream on the link
+					uint_fast32_t chunk = remaining_data;
+					if(shared_data->link != NULL) {
+						chunk = std::min(chunk, shared_data->link->get_chunk_size());
+						if(!shared_data->link->acquire(shared_data->link_flow, chunk)) {
+							END_THREAD_ERROR(false, NO_ERROR);
+						}
+					}
 					//try to send
-					ssize_t s = sendfile(shared_data->sock_fd, *((int*)current_packet->data_ptr), &offset, remaining_data);
+					trace_events::begin("sendfile", chunk);
+					ssize_t s = sendfile(shared_data->sock_fd, *((int*)current_packet->data_ptr), &offset, chunk);
+					trace_events::end("sendfile");
+					if(shared_data->link != NULL) {
+						shared_data->link->release(shared_data->link_flow, s > 0 ? s : 0);
+					}
 					//detect error
 					if(s < 0) {
-						END_THREAD_ERROR(true, SENDING_ERROR);
+						LOST_CLIENT(SENDING_ERROR);
 					}
 					//check thread termination signal
 					if(shared_data->terminate_thread) {
 						END_THREAD_ERROR(false, NO_ERROR);
 					}
 					//update state variables
+					write_path->file_written(s);
 					remaining_data -= s;
 				}
 			} else {
 				END_THREAD_ERROR(true, NOT_SUPPORTED_DATA_TYPE);
 			}
+			RTDT_PROBE2(packet__send__done, i, current_packet->data_size);
 
 		}
 
+		//the frame is queued, let the other streams use the link
+		end_link_frame(shared_data);
+
+		//the frame is written, the write path gives it back to its owner
+		frame_bytes = 0;
+		if(shared_data->perf.is_open()) {
+			for(uint_fast32_t i=0; i<data_to_be_sent.num_packets; i++) {
+				frame_bytes += data_to_be_sent.packets[i].data_size;
+			}
+		}
+		if(!write_path->frame_written(shared_data, &data_to_be_sent)) {
+			if(shared_data->terminate_thread) {
+				END_THREAD_ERROR(false, NO_ERROR);
+			}
+			LOST_CLIENT(WRITE_PATH_ERROR);
+		}
+
 		//mark the send as done
+		if(shared_data->perf.is_open()) {
+			shared_data->perf.end(frame_bytes);
+		}
+		shared_data->usage.end(frame_number++);
 		shared_data->is_done = true;
+		trace_events::end("frame");
+		continue;
+
+	lost_client:
+		trace_events::instant("client lost");
+		shared_data->perf.discard();
+		shared_data->usage.end(frame_number++);
+		trace_events::end("frame");
+		//drop the frame, the next client starts with the next frame
+		end_link_frame(shared_data);
+		data_to_be_sent.release_packets();
+		if(!write_path->client_closed(shared_data)) {
+			END_THREAD_ERROR(true, WRITE_PATH_ERROR);
+		}
+		close_client(shared_data);
+		if(!wait_client(shared_data, write_path)) {
+			END_THREAD_ERROR(false, NO_ERROR);
+		}
 	}
 	
 	END_THREAD_ERROR(false, NO_ERROR);
 }
 
 
-TCPSender::TCPSender(uint_fast16_t port) : error_handler_("TCPSender") {
+TCPSender::TCPSender(uint_fast16_t port) : TCPSender(port, new TCPWritePath(), "TCPSender") {
+}
+
+TCPSender::TCPSender(uint_fast16_t port, TCPWritePath* write_path, std::string name) : error_handler_(name), worker_placement_(CPU_CORE_AFFINITY, 98) {
 	port_ = port;
+	write_path_ = write_path;
+	worker_data_.shared_data = &shared_data_;
+	worker_data_.write_path = write_path_;
+	worker_data_.thread_name = name;
 	server_sock_fd_ = -1;
 	client_sock_fd_ = -1;
 	initialized_ = false;
-	//this is true here to prevent deadlock in case the object got
-	//destroyed before initialization, this flag means that there is
-	//no thread currently operate and will be set to false if the 
-	//thread was running.
+	auto_frame_bytes_ = 0;
+	auto_frequency_ = 0;
+	limit_unsent_ = false;
+	link_ = NULL;
+	link_budget_ = 0;
+	link_weight_ = 1;
+	reconnect_ = false;
+	async_accept_ = false;
+	usage_accounting_ = false;
+	perf_counters_ = false;
+	worker_running_ = false;
+	//no worker thread is running yet
 	shared_data_.is_terminated_thread = true;
 }
 
@@ -211,6 +516,60 @@ bool TCPSender::get_client() {
 }
 
 
+void TCPSender::set_frame_crc(bool enabled) {
+	shared_data_.frame_crc = enabled;
+}
+
+void TCPSender::set_auto_buffers(uint_fast32_t frame_bytes, uint_fast16_t frequency, bool limit_unsent) {
+	auto_frame_bytes_ = frame_bytes;
+	auto_frequency_ = frequency;
+	limit_unsent_ = limit_unsent;
+}
+
+bool TCPSender::set_worker_placement(const ThreadPlacement& placement) {
+	if(!thread_placement::is_valid(placement)) {
+		error_handler_.set_error("Invalid placement, no cores or priority out of range");
+		return false;
+	}
+	worker_placement_ = placement;
+	return true;
+}
+
+bool TCPSender::set_link_scheduler(LinkScheduler* link, uint_fast32_t tick_budget, uint_fast16_t weight) {
+	if(link != NULL && weight == 0) {
+		error_handler_.set_error("The link weight must be at least 1");
+		return false;
+	}
+	link_ = link;
+	link_budget_ = tick_budget;
+	link_weight_ = weight;
+	return true;
+}
+
+void TCPSender::set_reconnect(bool enabled) {
+	reconnect_ = enabled;
+}
+
+void TCPSender::set_async_accept(bool enabled) {
+	async_accept_ = enabled;
+}
+
+void TCPSender::set_usage_accounting(bool enabled) {
+	usage_accounting_ = enabled;
+}
+
+void TCPSender::get_worker_usage_stats(ThreadUsageStats* stats) {
+	shared_data_.usage.get_stats(stats);
+}
+
+void TCPSender::set_perf_counters(bool enabled) {
+	perf_counters_ = enabled;
+}
+
+void TCPSender::get_worker_perf_stats(PerfCounterStats* stats) {
+	shared_data_.perf.get_stats(stats);
+}
+
 bool TCPSender::initialize() {
 	
 	//clean the last state
@@ -224,33 +583,73 @@ bool TCPSender::initialize() {
 	shared_data_.is_error = false;
 	shared_data_.sock_fd = -1;
 	shared_data_.terminate_thread = false;
-	shared_data_.thread_initialized = false;
-
-	//again this can't be initialized here and must be initialized in
-	//the worker thread itself to prevent deadlock.
-	//shared_data_.is_terminated_thread = false;
 
 	shared_data_.error_code = 0;
+	shared_data_.server_sock_fd = -1;
+	shared_data_.reconnect = reconnect_;
+	shared_data_.is_reconnecting = false;
+	shared_data_.placement = worker_placement_;
+	shared_data_.usage.set_enabled(usage_accounting_);
+	shared_data_.usage.reset();
+	shared_data_.perf_counters = perf_counters_;
+	shared_data_.perf.reset();
 	shared_data_.packets_mutex = PTHREAD_MUTEX_INITIALIZER;
 	shared_data_.packets_cond = PTHREAD_COND_INITIALIZER;
+	shared_data_.sock_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 	//create the server
 	if(!create_server()) {
 		return false;
 	}
 	
-	//wait for client to connect
-	if(!get_client()) {
+	//wait for client to connect, or let the worker accept it
+	if(async_accept_) {
+		shared_data_.is_done = false;
+		shared_data_.is_reconnecting = true;
+	} else if(!get_client()) {
 		return false;
 	}
 
-	//shutdown the server
-	shutdown(server_sock_fd_, SHUT_RDWR);
-	close(server_sock_fd_);
-	server_sock_fd_ = -1;
+	if(reconnect_ || async_accept_) {
+		//keep the server for the worker, it only takes clients which are
+		//already waiting
+		if(fcntl(server_sock_fd_, F_SETFL, fcntl(server_sock_fd_, F_GETFL) | O_NONBLOCK) == -1) {
+			error_handler_.set_error("can't make the server socket non blocking");
+			return false;
+		}
+		shared_data_.server_sock_fd = server_sock_fd_;
+	} else {
+		//shutdown the server
+		shutdown(server_sock_fd_, SHUT_RDWR);
+		close(server_sock_fd_);
+		server_sock_fd_ = -1;
+	}
 
-	//set the client fd in the shared data
+	//hand the client to the worker, it may replace it later
 	shared_data_.sock_fd = client_sock_fd_;
+	client_sock_fd_ = -1;
+
+	//the socket buffers are sized by the worker for each client
+	shared_data_.send_buffer_size = TCP_SENDER_SEND_BUFFER;
+	shared_data_.auto_frame_bytes = auto_frame_bytes_;
+	shared_data_.auto_frequency = auto_frequency_;
+	shared_data_.notsent_lowat = 0;
+	if(auto_frame_bytes_ != 0 && limit_unsent_) {
+		shared_data_.notsent_lowat = auto_frame_bytes_;
+	}
+
+	//wakes the worker from its blocking waits when the sender ends
+	shared_data_.wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if(shared_data_.wake_fd == -1) {
+		error_handler_.set_error("can't create the wake event of the worker");
+		return false;
+	}
+
+	//join the shared link
+	if(link_ != NULL) {
+		shared_data_.link_flow = link_->add_flow(link_budget_, link_weight_);
+		shared_data_.link = link_;
+	}
 
 	//create thread
 	struct sched_param param;
@@ -277,7 +676,7 @@ bool TCPSender::initialize() {
 		error_handler_.set_error("pthread setschedpolicy failed");
 		return false;
 	}
-	param.sched_priority = 98;
+	param.sched_priority = worker_placement_.priority;
 	ret = pthread_attr_setschedparam(&attr, &param);
 	if (ret) {
 		error_handler_.set_error("pthread setschedparam failed");
@@ -291,16 +690,15 @@ bool TCPSender::initialize() {
 		return false;
 	}
 
-	int th_st = pthread_create(&worker_thread_, &attr, tcp_worker_function, (void*) &shared_data_);
+	//the worker sets it back when it ends
+	shared_data_.is_terminated_thread = false;
+	int th_st = pthread_create(&worker_thread_, &attr, tcp_worker_function, (void*) &worker_data_);
 	if(th_st) {
+		shared_data_.is_terminated_thread = true;
 		error_handler_.set_error("pthread_create() return code: " + std::to_string(th_st));
 		return false;
 	}
-
-	//wait until the thread initialized
-	while(!shared_data_.thread_initialized) {
-		milliseconds_sleep(5);
-	}
+	worker_running_ = true;
 
 	initialized_ = true;
 	return true;
@@ -336,6 +734,12 @@ bool TCPSender::send(DataPacketsList* list) {
 			case CANT_SOCKET_BUFFERS:
 				error_handler_.set_error("Can't reserve the buffers needed for the socket.");
 			break;
+			case CANT_MEMORY_NODE:
+				error_handler_.set_error("Sender worker thread can't set the preferred memory node.");
+			break;
+			case WRITE_PATH_ERROR:
+				error_handler_.set_error(write_path_->get_error());
+			break;
 			default:
 				error_handler_.set_error("Unknown error in sender worker thread.");
 			break;
@@ -366,26 +770,65 @@ bool TCPSender::is_send_done() {
 	return shared_data_.is_done;
 }
 
+bool TCPSender::get_link_state(SenderLinkState* state) {
+	if(!initialized_) {
+		return false;
+	}
+	//the worker doesn't close the socket meanwhile
+	MutexRAII sock_lock(shared_data_.sock_mutex);
+	sock_lock.lock_block();
+	return socket_utils::get_tcp_link_state(shared_data_.sock_fd, state);
+}
+
+bool TCPSender::is_reconnecting() {
+	return initialized_ && shared_data_.is_reconnecting;
+}
+
 bool TCPSender::end_sender() {
 
 	//mark it as uninitialized
 	initialized_ = false;
 
-	//end the thread if it was running
-	if(!shared_data_.is_terminated_thread) {
+	//end the thread if it was started
+	if(worker_running_) {
 		//terminate the worker thread
 		shared_data_.terminate_thread = true;
+		//wake the worker if it waits for its turn on the link
+		if(shared_data_.link != NULL) {
+			shared_data_.link->remove_flow(shared_data_.link_flow);
+		}
+		//wake the worker if it waits for a client or for the kernel
+		uint64_t wake = 1;
+		if(write(shared_data_.wake_fd, &wake, sizeof(wake)) != sizeof(wake)) {
+			error_handler_.set_error("can't wake the worker thread");
+		}
 		//signal the thread to terminate
 		MutexRAII prot_lock(shared_data_.packets_mutex);
 		prot_lock.lock_block();
+		//drop the data the worker didn't take
+		if(shared_data_.packets_list != NULL) {
+			shared_data_.packets_list->release_packets();
+		}
 		shared_data_.packets_list = NULL;
 		shared_data_.is_done = false;
 		pthread_cond_signal(&(shared_data_.packets_cond));
 		prot_lock.unlock();
 		//wait until the thread terminates
-		while(!shared_data_.is_terminated_thread) {
-			milliseconds_sleep(50);
-		}
+		pthread_join(worker_thread_, NULL);
+		worker_running_ = false;
+	}
+	//the counters of the ended worker, their stats are kept
+	shared_data_.perf.close();
+	if(shared_data_.wake_fd != -1) {
+		close(shared_data_.wake_fd);
+		shared_data_.wake_fd = -1;
+	}
+
+	//leave the link
+	if(shared_data_.link != NULL) {
+		shared_data_.link->remove_flow(shared_data_.link_flow);
+		shared_data_.link = NULL;
+		shared_data_.link_flow = -1;
 	}
 
 	//close the sockets
@@ -395,6 +838,8 @@ bool TCPSender::end_sender() {
 		close(server_sock_fd_);
 		server_sock_fd_ = -1;
 	}
+	shared_data_.server_sock_fd = -1;
+	close_client(&shared_data_);
 	if(client_sock_fd_ != -1) {
 		shutdown(client_sock_fd_, SHUT_RDWR);
 		close(client_sock_fd_);
@@ -416,4 +861,5 @@ bool TCPSender::is_error() {
 
 TCPSender::~TCPSender() {
 	end_sender();
+	delete write_path_;
 }
@@ -0,0 +1,182 @@
+#include "../../includes/tcp_sender_splice.h"
+
+using namespace timers_utils;
+
+TCPSpliceWritePath::TCPSpliceWritePath() : TCPWritePath("TCPSenderSplice") {
+	pipe_fds_[0] = pipe_fds_[1] = -1;
+	pipe_size_ = 0;
+	written_bytes_ = 0;
+}
+
+bool TCPSpliceWritePath::open_pipe() {
+	if(pipe2(pipe_fds_, O_CLOEXEC) == -1) {
+		pipe_fds_[0] = pipe_fds_[1] = -1;
+		return false;
+	}
+	//the default size is kept if the limit is lower
+	fcntl(pipe_fds_[1], F_SETPIPE_SZ, TCP_SENDER_SPLICE_PIPE_SIZE);
+	int pipe_size = fcntl(pipe_fds_[1], F_GETPIPE_SZ);
+	if(pipe_size <= 0) {
+		return false;
+	}
+	pipe_size_ = pipe_size;
+	return true;
+}
+
+void TCPSpliceWritePath::close_pipe() {
+	for(int i=0; i<2; i++) {
+		if(pipe_fds_[i] != -1) {
+			::close(pipe_fds_[i]);
+			pipe_fds_[i] = -1;
+		}
+	}
+}
+
+void TCPSpliceWritePath::take_acked(SenderWorkerData* shared_data) {
+	if(pending_.empty()) {
+		return;
+	}
+	//bytes written but not acknowledged yet
+	int unacked = 0;
+	if(ioctl(shared_data->sock_fd, SIOCOUTQ, &unacked) == -1) {
+		return;
+	}
+	uint_fast64_t acked_bytes = written_bytes_ - unacked;
+	while(!pending_.empty() && pending_.front().end_byte <= acked_bytes) {
+		acked_.push_back(PendingFrame{DataPacketsList(0), pending_.front().end_byte});
+		acked_.back().packets.swap(pending_.front().packets);
+		pending_.pop_front();
+	}
+}
+
+void TCPSpliceWritePath::release_frames(std::deque<PendingFrame>* frames) {
+	for(PendingFrame& frame : *frames) {
+		frame.packets.release_packets();
+	}
+	frames->clear();
+}
+
+bool TCPSpliceWritePath::open(SenderWorkerData* shared_data) {
+	written_bytes_ = 0;
+	if(!open_pipe()) {
+		error_handler_.set_error("Sender worker thread can't create the pipe of the pages.");
+		return false;
+	}
+	return true;
+}
+
+void TCPSpliceWritePath::close(SenderWorkerData* shared_data) {
+	//wait up to TCP_SENDER_SPLICE_LINGER_MS for the peer to acknowledge the
+	//pending frames, then give back all the packets
+	for(uint_fast32_t waited_ms = 0; !pending_.empty() && shared_data->sock_fd != -1 &&
+		waited_ms < TCP_SENDER_SPLICE_LINGER_MS; waited_ms++) {
+		take_acked(shared_data);
+		release_frames(&acked_);
+		if(!pending_.empty()) {
+			milliseconds_sleep(1);
+		}
+	}
+	release_frames(&acked_);
+	release_frames(&pending_);
+	written_bytes_ = 0;
+	close_pipe();
+}
+
+void TCPSpliceWritePath::wait_packets(SenderWorkerData* shared_data) {
+	//give back the acknowledged pages, their release functions run without
+	//the lock
+	take_acked(shared_data);
+	if(!acked_.empty()) {
+		pthread_mutex_unlock(&(shared_data->packets_mutex));
+		release_frames(&acked_);
+		pthread_mutex_lock(&(shared_data->packets_mutex));
+		return;
+	}
+	//wait each millisecond while the socket holds pages to give back
+	if(pending_.empty()) {
+		pthread_cond_wait(&(shared_data->packets_cond), &(shared_data->packets_mutex));
+		return;
+	}
+	timespec wake_time;
+	clock_gettime(CLOCK_REALTIME, &wake_time);
+	wake_time.tv_nsec += MS_TO_NS(1);
+	if(wake_time.tv_nsec >= (long) SEC_TO_NS(1)) {
+		wake_time.tv_sec++;
+		wake_time.tv_nsec -= SEC_TO_NS(1);
+	}
+	pthread_cond_timedwait(&(shared_data->packets_cond), &(shared_data->packets_mutex), &wake_time);
+}
+
+ssize_t TCPSpliceWritePath::write_header(SenderWorkerData* shared_data, const char* data, uint_fast32_t size) {
+	//the packets of the frame follow the header
+	trace_events::begin("send", size);
+	ssize_t s = ::send(shared_data->sock_fd, data, size, MSG_MORE);
+	trace_events::end("send");
+	if(s > 0) {
+		written_bytes_ += s;
+	}
+	return s;
+}
+
+ssize_t TCPSpliceWritePath::write_memory(SenderWorkerData* shared_data, const char* data, uint_fast32_t size, bool more) {
+	//map the memory into the pipe then move it to the socket
+	iovec iov;
+	iov.iov_base = (void*) data;
+	iov.iov_len = std::min(size, pipe_size_);
+	trace_events::begin("vmsplice", iov.iov_len);
+	ssize_t mapped = vmsplice(pipe_fds_[1], &iov, 1, 0);
+	trace_events::end("vmsplice");
+	if(mapped <= 0) {
+		error_handler_.set_error("Sender worker thread can't map the data into the pipe.");
+		return 0;
+	}
+	ssize_t moved = 0;
+	while(moved < mapped) {
+		trace_events::begin("splice", mapped - moved);
+		ssize_t s = splice(pipe_fds_[0], NULL, shared_data->sock_fd, NULL, mapped - moved,
+						   SPLICE_F_MOVE | ((more || mapped < ssize_t(size)) ? SPLICE_F_MORE : 0));
+		trace_events::end("splice");
+		//the pipe may still hold data, it's replaced with the client
+		if(s <= 0) {
+			return -1;
+		}
+		moved += s;
+	}
+	written_bytes_ += mapped;
+	return mapped;
+}
+
+void TCPSpliceWritePath::file_written(ssize_t bytes) {
+	written_bytes_ += bytes;
+}
+
+bool TCPSpliceWritePath::frame_written(SenderWorkerData* shared_data, DataPacketsList* frame) {
+	//the socket still reads the pages, the packets are given back to their
+	//owner once the peer acknowledged them
+	pending_.push_back(PendingFrame{DataPacketsList(0), written_bytes_});
+	pending_.back().packets.swap(*frame);
+	take_acked(shared_data);
+	release_frames(&acked_);
+	return true;
+}
+
+bool TCPSpliceWritePath::client_closed(SenderWorkerData* shared_data) {
+	//the pages still used by the old socket are given back with it, the
+	//pipe may still hold the pages of a lost frame
+	release_frames(&acked_);
+	release_frames(&pending_);
+	written_bytes_ = 0;
+	close_pipe();
+	if(!open_pipe()) {
+		error_handler_.set_error("Sender worker thread can't create the pipe of the pages.");
+		return false;
+	}
+	return true;
+}
+
+TCPSpliceWritePath::~TCPSpliceWritePath() {
+	close_pipe();
+}
+
+TCPSenderSplice::TCPSenderSplice(uint_fast16_t port) : TCPSender(port, new TCPSpliceWritePath(), "TCPSenderSplice") {
+}
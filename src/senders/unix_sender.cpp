@@ -0,0 +1,611 @@
+#include "../../includes/unix_sender.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include <algorithm>
+
+namespace unix_sender{
+
+	#define END_THREAD_ERROR(ERROR_FLAG, ERROR_CODE)\
+		shared_data->is_error = (ERROR_FLAG);	\
+		shared_data->error_code = (ERROR_CODE);	\
+		data_to_be_sent.release_packets();	\
+		close_frame(&frame_fd);			\
+		close_consumers(worker_data, consumers, &num_consumers);	\
+		prot_lock.~MutexRAII(); 		\
+		prot_term_flag.~AtomicValRAII();	\
+		pthread_exit(NULL)
+
+	enum UNIX_SENDER_ERROR_CODES
+	 {CANT_CPU_AFFINITY, READING_ERROR, NOT_SUPPORTED_DATA_TYPE, NO_ERROR, CANT_MEMORY_NODE,
+	  CANT_MEMFD};
+}
+
+using namespace unix_sender;
+using namespace timers_utils;
+
+static void close_frame(int* frame_fd) {
+	if(*frame_fd != -1) {
+		close(*frame_fd);
+		*frame_fd = -1;
+	}
+}
+
+static void close_consumers(UnixWorkerData* worker_data, int* consumers, uint_fast32_t* num_consumers) {
+	for(uint_fast32_t i=0; i<*num_consumers; i++) {
+		close(consumers[i]);
+	}
+	*num_consumers = 0;
+	worker_data->consumers = 0;
+}
+
+//take the consumers waiting on the server, the ones over the limit are
+//closed
+static void accept_consumers(SenderWorkerData* shared_data, int* consumers, uint_fast32_t* num_consumers) {
+	int consumer_fd;
+	while((consumer_fd = accept4(shared_data->server_sock_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) != -1) {
+		if(*num_consumers == UNIX_SENDER_MAX_CONSUMERS) {
+			close(consumer_fd);
+			continue;
+		}
+		consumers[(*num_consumers)++] = consumer_fd;
+		trace_events::instant("consumer connected");
+	}
+}
+
+//take the frame buffer of the list if the frame is a single packet in it
+//returns its memfd, -1 if the frame must be copied
+static int take_frame_buffer(UnixWorkerData* worker_data, const DataPacketsList& list) {
+	if(list.num_packets != 1 || list.packets[0].data_ptr_type != DataPacket::DATA_PTR_MEMORY_LOCATION) {
+		return -1;
+	}
+	MutexRAII buffers_lock(worker_data->frame_buffers_mutex);
+	buffers_lock.lock_block();
+	auto buffer = worker_data->frame_buffers.find(list.packets[0].data_ptr);
+	if(buffer == worker_data->frame_buffers.end() ||
+	   list.packets[0].data_offset + list.packets[0].data_size > buffer->second.second) {
+		return -1;
+	}
+	int fd = buffer->second.first;
+	//no writable mapping may be left for the seal
+	munmap(buffer->first, buffer->second.second);
+	worker_data->frame_buffers.erase(buffer);
+	return fd;
+}
+
+//copy the frame into a new memfd
+//returns the memfd, -1 if it can't be created, -2 if a packet can't be read
+static int copy_frame(const DataPacketsList& list, uint_fast64_t frame_bytes) {
+	int fd = memfd_create("rtdt-frame", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if(fd == -1) {
+		return -1;
+	}
+	if(frame_bytes == 0) {
+		return fd;
+	}
+	char* memory = NULL;
+	if(ftruncate(fd, frame_bytes) == -1 ||
+	   (memory = (char*) mmap(NULL, frame_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED) {
+		close(fd);
+		return -1;
+	}
+	uint_fast64_t copied = 0;
+	for(uint_fast32_t i=0; i<list.num_packets; i++) {
+		const DataPacket* current_packet = list.packets + i;
+		if(current_packet->data_ptr_type == DataPacket::DATA_PTR_MEMORY_LOCATION) {
+			trace_events::begin("memcpy", current_packet->data_size);
+			memcpy(memory + copied, ((char*)current_packet->data_ptr) + current_packet->data_offset, current_packet->data_size);
+			trace_events::end("memcpy");
+		} else {
+			//read the packet from the file descriptor
+			uint_fast32_t data_read = 0;
+			while(data_read < current_packet->data_size) {
+				trace_events::begin("pread", current_packet->data_size - data_read);
+				ssize_t r = pread(*((int*)current_packet->data_ptr), memory + copied + data_read,
+								  current_packet->data_size - data_read, current_packet->data_offset + data_read);
+				trace_events::end("pread");
+				if(r <= 0) {
+					munmap(memory, frame_bytes);
+					close(fd);
+					return -2;
+				}
+				data_read += r;
+			}
+		}
+		copied += current_packet->data_size;
+	}
+	munmap(memory, frame_bytes);
+	return fd;
+}
+
+static void* unix_worker_function(void* data) {
+	UnixWorkerData* worker_data = (UnixWorkerData*) data;
+	//the shared data between the main thread and the worker thread.
+	SenderWorkerData* shared_data = worker_data->shared_data;
+	//release the lock whenever the scope of this function end
+	MutexRAII prot_lock(shared_data->packets_mutex);
+	//set the termination flag of this thread to true whenever this
+	//function goes out of scope.
+	AtomicValRAII<bool> prot_term_flag(shared_data->is_terminated_thread, true);
+	//this is the buffer to copy data from the shared buffer to be sent later.
+	DataPacketsList data_to_be_sent(0);
+	//the memfd of the frame being passed
+	int frame_fd = -1;
+	//the sockets of the consumers
+	int consumers[UNIX_SENDER_MAX_CONSUMERS];
+	uint_fast32_t num_consumers = 0;
+	//stick the thread to the placement cores
+	if(!thread_placement::set_affinity(shared_data->placement)) {
+		END_THREAD_ERROR(true, CANT_CPU_AFFINITY);
+	}
+	//prefer the placement memory node
+	if(!thread_placement::set_memory_node(shared_data->placement)) {
+		END_THREAD_ERROR(true, CANT_MEMORY_NODE);
+	}
+	trace_events::set_thread_name("UnixSender worker");
+	//the frames are passed without the counters if none can be opened
+	if(shared_data->perf_counters) {
+		shared_data->perf.open();
+	}
+	//the sequence of the frame, the first one is 1
+	uint64_t sequence = 1;
+	//start the passing loop
+	while(!shared_data->terminate_thread) {
+		/**
+		 * take the data from the buffer if available
+		 **/
+		//acquire the lock
+		prot_lock.lock_block();
+
+		//check if there is no data
+		while(shared_data->packets_list == NULL) {
+			//check if the signal due to the termination
+			if(shared_data->terminate_thread) {
+				END_THREAD_ERROR(false, NO_ERROR);
+			}
+			//if no data yet and no termination signal arrived, then wait on the
+			//condition
+			pthread_cond_wait(&(shared_data->packets_cond), &(shared_data->packets_mutex));
+		}
+		//copy the data to the buffer to be sent later
+		data_to_be_sent = *(shared_data->packets_list);
+		shared_data->packets_list = NULL;
+		//release the lock
+		prot_lock.unlock();
+		trace_events::begin("frame");
+		shared_data->usage.begin();
+		shared_data->perf.begin();
+
+		UnixFrameMessage message;
+		memset(&message, 0, sizeof(message));
+		message.magic = UNIX_FRAME_MAGIC;
+		message.version = UNIX_FRAME_VERSION;
+		message.sequence = sequence;
+		message.num_packets = data_to_be_sent.num_packets;
+		for(uint_fast32_t i=0; i<data_to_be_sent.num_packets; i++) {
+			DataPacket* current_packet = (data_to_be_sent.packets) + i;
+			if(current_packet->data_ptr_type != DataPacket::DATA_PTR_MEMORY_LOCATION &&
+			   current_packet->data_ptr_type != DataPacket::DATA_PTR_FILE_DESCRIPTOR) {
+				END_THREAD_ERROR(true, NOT_SUPPORTED_DATA_TYPE);
+			}
+			message.packet_sizes[i] = current_packet->data_size;
+			message.frame_size += current_packet->data_size;
+		}
+
+		/**
+		 * put the frame in a sealed memfd and pass it to the consumers, the
+		 * frame is dropped if there is none
+		 **/
+		accept_consumers(shared_data, consumers, &num_consumers);
+		//a frame buffer is given up even if no consumer takes it
+		frame_fd = take_frame_buffer(worker_data, data_to_be_sent);
+		if(num_consumers == 0) {
+			close_frame(&frame_fd);
+		} else {
+			if(frame_fd != -1) {
+				message.data_offset = data_to_be_sent.packets[0].data_offset;
+			} else {
+				frame_fd = copy_frame(data_to_be_sent, message.frame_size);
+				if(frame_fd == -2) {
+					frame_fd = -1;
+					END_THREAD_ERROR(true, READING_ERROR);
+				}
+			}
+			if(frame_fd == -1 || fcntl(frame_fd, F_ADD_SEALS, UNIX_FRAME_SEALS) == -1) {
+				END_THREAD_ERROR(true, CANT_MEMFD);
+			}
+			message.timestamp_ns = monotonic_ns();
+			char control[CMSG_SPACE(sizeof(int))];
+			memset(control, 0, sizeof(control));
+			iovec iov = {&message, sizeof(message)};
+			msghdr header = {};
+			header.msg_iov = &iov;
+			header.msg_iovlen = 1;
+			header.msg_control = control;
+			header.msg_controllen = sizeof(control);
+			cmsghdr* cmsg = CMSG_FIRSTHDR(&header);
+			cmsg->cmsg_level = SOL_SOCKET;
+			cmsg->cmsg_type = SCM_RIGHTS;
+			cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+			memcpy(CMSG_DATA(cmsg), &frame_fd, sizeof(int));
+			for(uint_fast32_t i=0; i<num_consumers; ) {
+				trace_events::begin("sendmsg");
+				ssize_t s = sendmsg(consumers[i], &header, MSG_DONTWAIT | MSG_NOSIGNAL);
+				trace_events::end("sendmsg");
+				if(s < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+					//the consumer is behind, it misses this frame
+					worker_data->dropped_frames++;
+				} else if(s < 0) {
+					//the consumer is gone
+					trace_events::instant("consumer lost");
+					close(consumers[i]);
+					consumers[i] = consumers[--num_consumers];
+					continue;
+				}
+				i++;
+			}
+			//the consumers hold their own descriptors
+			close_frame(&frame_fd);
+		}
+		worker_data->consumers = num_consumers;
+
+		//the frame is passed, give the packets back
+		data_to_be_sent.release_packets();
+		shared_data->perf.end(message.frame_size);
+		shared_data->usage.end(sequence++);
+		//mark the send as done
+		shared_data->is_done = true;
+		trace_events::end("frame");
+	}
+
+	END_THREAD_ERROR(false, NO_ERROR);
+}
+
+UnixSender::UnixSender(const std::string& path) : error_handler_("UnixSender"), worker_placement_(CPU_CORE_AFFINITY, 98) {
+	path_ = path;
+	server_sock_fd_ = -1;
+	initialized_ = false;
+	usage_accounting_ = false;
+	perf_counters_ = false;
+	worker_running_ = false;
+	frame_bytes_ = 0;
+}
+
+bool UnixSender::create_server() {
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	if(path_.size() >= sizeof(address.sun_path)) {
+		error_handler_.set_error("The socket path " + path_ + " is too long.");
+		return false;
+	}
+	strcpy(address.sun_path, path_.c_str());
+	//replace the socket left by a previous sender, any other file is kept
+	struct stat path_stat;
+	if(lstat(path_.c_str(), &path_stat) == 0) {
+		if(!S_ISSOCK(path_stat.st_mode)) {
+			error_handler_.set_error("The path " + path_ + " exists and isn't a socket.");
+			return false;
+		}
+		unlink(path_.c_str());
+	}
+	//the consumers are accepted by the worker between the frames
+	server_sock_fd_ = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if(server_sock_fd_ == -1) {
+		error_handler_.set_error(std::string("Can't create the server socket : ") + strerror(errno));
+		return false;
+	}
+	if(bind(server_sock_fd_, (sockaddr*) &address, sizeof(address)) == -1) {
+		error_handler_.set_error("Can't bind the server to " + path_ + " : " + strerror(errno));
+		//the path isn't the server one, end_sender(0) must not unlink it
+		close(server_sock_fd_);
+		server_sock_fd_ = -1;
+		return false;
+	}
+	if(listen(server_sock_fd_, UNIX_SENDER_MAX_CONSUMERS) == -1) {
+		error_handler_.set_error(std::string("Can't listen on the server socket : ") + strerror(errno));
+		return false;
+	}
+	return true;
+}
+
+void* UnixSender::create_frame_buffer(uint_fast32_t size) {
+	int fd = memfd_create("rtdt-frame", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if(fd == -1 || size == 0 || ftruncate(fd, size) == -1) {
+		error_handler_.set_error("Can't create a frame buffer of " + std::to_string(size) + " bytes.");
+		if(fd != -1) {
+			close(fd);
+		}
+		return NULL;
+	}
+	void* buffer = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if(buffer == MAP_FAILED) {
+		error_handler_.set_error(std::string("Can't map a frame buffer : ") + strerror(errno));
+		close(fd);
+		return NULL;
+	}
+	MutexRAII buffers_lock(worker_data_.frame_buffers_mutex);
+	buffers_lock.lock_block();
+	worker_data_.frame_buffers[buffer] = std::make_pair(fd, size);
+	return buffer;
+}
+
+void UnixSender::free_frame_buffer(void* buffer) {
+	MutexRAII buffers_lock(worker_data_.frame_buffers_mutex);
+	buffers_lock.lock_block();
+	auto found = worker_data_.frame_buffers.find(buffer);
+	if(found != worker_data_.frame_buffers.end()) {
+		munmap(found->first, found->second.second);
+		close(found->second.first);
+		worker_data_.frame_buffers.erase(found);
+	}
+}
+
+uint_fast32_t UnixSender::get_consumers() {
+	return worker_data_.consumers;
+}
+
+uint_fast64_t UnixSender::get_dropped_frames() {
+	return worker_data_.dropped_frames;
+}
+
+bool UnixSender::set_worker_placement(const ThreadPlacement& placement) {
+	if(!thread_placement::is_valid(placement)) {
+		error_handler_.set_error("Invalid placement, no cores or priority out of range");
+		return false;
+	}
+	worker_placement_ = placement;
+	return true;
+}
+
+void UnixSender::set_usage_accounting(bool enabled) {
+	usage_accounting_ = enabled;
+}
+
+void UnixSender::get_worker_usage_stats(ThreadUsageStats* stats) {
+	shared_data_.usage.get_stats(stats);
+}
+
+void UnixSender::set_perf_counters(bool enabled) {
+	perf_counters_ = enabled;
+}
+
+void UnixSender::get_worker_perf_stats(PerfCounterStats* stats) {
+	shared_data_.perf.get_stats(stats);
+}
+
+bool UnixSender::initialize() {
+
+	//clean the last state
+	//destroying the thread
+	//closing open files
+	end_sender();
+
+	//re initialize the shared data
+	shared_data_.packets_list = NULL;
+	shared_data_.is_done = true;
+	shared_data_.is_error = false;
+	shared_data_.terminate_thread = false;
+	shared_data_.error_code = 0;
+	shared_data_.placement = worker_placement_;
+	shared_data_.usage.set_enabled(usage_accounting_);
+	shared_data_.usage.reset();
+	shared_data_.perf_counters = perf_counters_;
+	shared_data_.perf.reset();
+	shared_data_.packets_mutex = PTHREAD_MUTEX_INITIALIZER;
+	shared_data_.packets_cond = PTHREAD_COND_INITIALIZER;
+	worker_data_.shared_data = &shared_data_;
+	worker_data_.consumers = 0;
+	worker_data_.dropped_frames = 0;
+	frame_bytes_ = 0;
+
+	//create the server, the worker takes the consumers from it
+	if(!create_server()) {
+		end_sender();
+		return false;
+	}
+	shared_data_.server_sock_fd = server_sock_fd_;
+
+	//create thread
+	struct sched_param param;
+	pthread_attr_t attr;
+	int ret;
+
+	/* Initialize pthread attributes (default values) */
+	ret = pthread_attr_init(&attr);
+	if (ret) {
+		error_handler_.set_error("init pthread attributes failed");
+		return false;
+	}
+
+	/* Set a specific stack size  */
+	ret = pthread_attr_setstacksize(&attr, PTHREAD_STACK_MIN);
+	if (ret) {
+		error_handler_.set_error("pthread setstacksize failed");
+		return false;
+	}
+
+	/* Set scheduler policy and priority of pthread */
+	ret = pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+	if (ret) {
+		error_handler_.set_error("pthread setschedpolicy failed");
+		return false;
+	}
+	param.sched_priority = worker_placement_.priority;
+	ret = pthread_attr_setschedparam(&attr, &param);
+	if (ret) {
+		error_handler_.set_error("pthread setschedparam failed");
+		return false;
+	}
+
+	/* Use scheduling parameters of attr */
+	ret = pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+	if (ret) {
+		error_handler_.set_error("pthread setinheritsched failed");
+		return false;
+	}
+
+	//the worker sets it back when it ends
+	shared_data_.is_terminated_thread = false;
+	int th_st = pthread_create(&worker_thread_, &attr, unix_worker_function, (void*) &worker_data_);
+	if(th_st) {
+		shared_data_.is_terminated_thread = true;
+		error_handler_.set_error("pthread_create() return code: " + std::to_string(th_st));
+		return false;
+	}
+	worker_running_ = true;
+
+	initialized_ = true;
+	return true;
+}
+
+bool UnixSender::send(DataPacketsList* list) {
+
+	//if the object not yet initialized
+	if(!initialized_) {
+		error_handler_.set_error("You must initialize the sender object first");
+		return false;
+	}
+
+	//if the sender worker thread terminates, get the error from it
+	if(shared_data_.is_terminated_thread) {
+		if(!shared_data_.is_error) {
+			error_handler_.set_error("No Thread Available to execute the send operation");
+			return false;
+		}
+		switch(shared_data_.error_code) {
+			case CANT_CPU_AFFINITY:
+				error_handler_.set_error("Sender worker thread can't set CPU Affinity.");
+			break;
+			case READING_ERROR:
+				error_handler_.set_error("Sender worker thread, error while reading the file descriptor packet.");
+			break;
+			case NOT_SUPPORTED_DATA_TYPE:
+				error_handler_.set_error("Sender worker thread can't send that type of packets.");
+			break;
+			case CANT_MEMORY_NODE:
+				error_handler_.set_error("Sender worker thread can't set the preferred memory node.");
+			break;
+			case CANT_MEMFD:
+				error_handler_.set_error("Sender worker thread can't create or seal the memfd of the frame.");
+			break;
+			default:
+				error_handler_.set_error("Unknown error in sender worker thread.");
+			break;
+		}
+		return false;
+	}
+
+	//if there is already send operation, then decline this send operation
+	if(!shared_data_.is_done) {
+		error_handler_.set_error("system called send(DataPacketsList*) while on going send operation.");
+		return false;
+	}
+
+	if(list->num_packets > UNIX_FRAME_MAX_PACKETS) {
+		error_handler_.set_error("The frame of " + std::to_string(list->num_packets) + " packets has more than " +
+			std::to_string(UNIX_FRAME_MAX_PACKETS) + ".");
+		return false;
+	}
+	frame_bytes_ = 0;
+	for(uint_fast32_t i=0; i<list->num_packets; i++) {
+		frame_bytes_ += list->packets[i].data_size;
+	}
+
+	//release the lock whenever the scope of this function end
+	MutexRAII prot_lock(shared_data_.packets_mutex);
+
+	//add the data, set the is_done flag, and signal the thread
+	prot_lock.lock_block();
+	shared_data_.packets_list = list;
+	shared_data_.is_done = false;
+	pthread_cond_signal(&(shared_data_.packets_cond));
+	prot_lock.unlock();
+	return true;
+
+}
+
+bool UnixSender::is_send_done() {
+	return shared_data_.is_done;
+}
+
+bool UnixSender::get_link_state(SenderLinkState* state) {
+	if(!initialized_) {
+		return false;
+	}
+	*state = SenderLinkState();
+	if(!shared_data_.is_done) {
+		state->queued_bytes = std::min(frame_bytes_, uint_fast64_t(UINT32_MAX));
+		state->unsent_bytes = state->queued_bytes;
+	}
+	return true;
+}
+
+bool UnixSender::is_reconnecting() {
+	return false;
+}
+
+bool UnixSender::end_sender() {
+
+	//mark it as uninitialized
+	initialized_ = false;
+
+	//end the thread if it was started, it closes the consumers
+	if(worker_running_) {
+		//signal the thread to terminate
+		shared_data_.terminate_thread = true;
+		MutexRAII prot_lock(shared_data_.packets_mutex);
+		prot_lock.lock_block();
+		//drop the data the worker didn't take
+		if(shared_data_.packets_list != NULL) {
+			shared_data_.packets_list->release_packets();
+		}
+		shared_data_.packets_list = NULL;
+		shared_data_.is_done = false;
+		pthread_cond_signal(&(shared_data_.packets_cond));
+		prot_lock.unlock();
+		//wait until the thread terminates
+		pthread_join(worker_thread_, NULL);
+		worker_running_ = false;
+	}
+	//the counters of the ended worker, their stats are kept
+	shared_data_.perf.close();
+
+	//close the server
+	if(server_sock_fd_ != -1) {
+		close(server_sock_fd_);
+		server_sock_fd_ = -1;
+		unlink(path_.c_str());
+	}
+	shared_data_.server_sock_fd = -1;
+
+	//the frame buffers not sent
+	MutexRAII buffers_lock(worker_data_.frame_buffers_mutex);
+	buffers_lock.lock_block();
+	for(auto& buffer : worker_data_.frame_buffers) {
+		munmap(buffer.first, buffer.second.second);
+		close(buffer.second.first);
+	}
+	worker_data_.frame_buffers.clear();
+	return true;
+}
+
+std::string UnixSender::get_error() {
+	std::string error = error_handler_.get_error();
+	error_handler_.clear_error();
+	return error;
+}
+
+bool UnixSender::is_error() {
+	return error_handler_.is_error();
+}
+
+UnixSender::~UnixSender() {
+	end_sender();
+}
@@ -0,0 +1,92 @@
+#include "../../includes/frame_queue.h"
+
+FrameQueue::FrameQueue() {
+	head_ = 0;
+	count_ = 0;
+	pushing_ = false;
+	closed_ = true;
+	//the producer holding the lock runs at the priority of the real time
+	//thread waiting for it
+	pthread_mutexattr_t attr;
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+	pthread_mutex_init(&queue_mutex_, &attr);
+	pthread_mutexattr_destroy(&attr);
+	pthread_cond_init(&queue_cond_, NULL);
+}
+
+bool FrameQueue::initialize(uint_fast16_t depth) {
+	if(depth == 0) {
+		return false;
+	}
+	MutexRAII prot_lock(queue_mutex_);
+	prot_lock.lock_block();
+	//the slots are allocated here, not in the real time loop
+	frames_.assign(depth, DataPacketsList(0));
+	stops_.assign(depth, false);
+	head_ = 0;
+	count_ = 0;
+	pushing_ = false;
+	closed_ = false;
+	return true;
+}
+
+DataPacketsList* FrameQueue::begin_push() {
+	MutexRAII prot_lock(queue_mutex_);
+	prot_lock.lock_block();
+	while(!closed_ && count_ == frames_.size()) {
+		pthread_cond_wait(&queue_cond_, &queue_mutex_);
+	}
+	if(closed_) {
+		return NULL;
+	}
+	pushing_ = true;
+	return &frames_[(head_ + count_) % frames_.size()];
+}
+
+void FrameQueue::end_push(bool stop) {
+	MutexRAII prot_lock(queue_mutex_);
+	prot_lock.lock_block();
+	if(!pushing_) {
+		return;
+	}
+	pushing_ = false;
+	stops_[(head_ + count_) % frames_.size()] = stop;
+	count_++;
+	pthread_cond_broadcast(&queue_cond_);
+}
+
+bool FrameQueue::pop(DataPacketsList* list, bool* stop) {
+	MutexRAII prot_lock(queue_mutex_);
+	prot_lock.lock_block();
+	if(count_ == 0) {
+		return false;
+	}
+	list->swap(frames_[head_]);
+	*stop = stops_[head_];
+	head_ = (head_ + 1) % frames_.size();
+	count_--;
+	pthread_cond_broadcast(&queue_cond_);
+	return true;
+}
+
+void FrameQueue::wait_full() {
+	MutexRAII prot_lock(queue_mutex_);
+	prot_lock.lock_block();
+	while(!closed_ && count_ != frames_.size() &&
+		  !(count_ != 0 && stops_[(head_ + count_ - 1) % frames_.size()])) {
+		pthread_cond_wait(&queue_cond_, &queue_mutex_);
+	}
+}
+
+void FrameQueue::close() {
+	MutexRAII prot_lock(queue_mutex_);
+	prot_lock.lock_block();
+	closed_ = true;
+	pthread_cond_broadcast(&queue_cond_);
+}
+
+FrameQueue::~FrameQueue() {
+	pthread_cond_destroy(&queue_cond_);
+	pthread_mutex_destroy(&queue_mutex_);
+}
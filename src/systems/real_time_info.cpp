@@ -0,0 +1,37 @@
+#include "../../includes/real_time_info.h"
+
+/**
+ * Class : RealTimeInfo
+ * --------------------------------------------------------------
+ */	
+RealTimeInfo::RealTimeInfo(uint_fast32_t sequence_number, bool skip_next_data, uint_fast16_t delayed_ms, bool system_stopped, bool predicted_skip) {
+	sequence_number_ = sequence_number;
+	skip_next_data_ = skip_next_data;
+	delayed_ms_ = delayed_ms;
+	system_stopped_ = system_stopped;
+	predicted_skip_ = predicted_skip;
+}
+
+uint_fast32_t RealTimeInfo::get_sequence_number() {
+	return sequence_number_;
+}
+
+uint_fast32_t RealTimeInfo::get_delayed_time_ms() {
+	return delayed_ms_;
+}
+
+bool RealTimeInfo::is_skipped_data() {
+	return skip_next_data_;
+}
+
+bool RealTimeInfo::is_predicted_skip() {
+	return predicted_skip_;
+}
+
+void RealTimeInfo::stop_system() {
+	system_stopped_ = true;
+}
+
+bool RealTimeInfo::is_system_stopped() {
+	return system_stopped_;
+}
@@ -0,0 +1,260 @@
+#include "../../includes/stream_recording.h"
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+using namespace std;
+
+static bool write_u32(FILE* file, uint_fast32_t value) {
+	uint32_t value_32 = value;
+	return fwrite(&value_32, sizeof(value_32), 1, file) == 1;
+}
+
+static bool read_u32(FILE* file, uint_fast32_t* value) {
+	uint32_t value_32;
+	if(fread(&value_32, sizeof(value_32), 1, file) != 1) {
+		return false;
+	}
+	*value = value_32;
+	return true;
+}
+
+StreamRecorder::StreamRecorder() : error_handler_("StreamRecorder") {
+	file_ = NULL;
+	payloads_ = false;
+	frames_ = 0;
+}
+
+bool StreamRecorder::open(const char* path, uint_fast16_t frequency, bool payloads) {
+	if(file_ != NULL) {
+		error_handler_.set_error("The recording file is already open.");
+		return false;
+	}
+	file_ = fopen(path, "wb");
+	if(file_ == NULL) {
+		error_handler_.set_error(string("Can't create the recording file : ") + strerror(errno));
+		return false;
+	}
+	payloads_ = payloads;
+	frames_ = 0;
+	if(fwrite(STREAM_RECORDING_MAGIC, strlen(STREAM_RECORDING_MAGIC), 1, file_) != 1 ||
+	   !write_u32(file_, payloads ? STREAM_RECORDING_PAYLOADS : 0) || !write_u32(file_, frequency)) {
+		error_handler_.set_error("Can't write the recording header.");
+		fclose(file_);
+		file_ = NULL;
+		return false;
+	}
+	return true;
+}
+
+bool StreamRecorder::write_payload(const DataPacket& packet) {
+	if(packet.data_size == 0) {
+		return true;
+	}
+	if(packet.data_ptr_type == DataPacket::DATA_PTR_MEMORY_LOCATION) {
+		return fwrite((char*) packet.data_ptr + packet.data_offset, packet.data_size, 1, file_) == 1;
+	}
+	//data_ptr points to the descriptor, the payload starts at data_offset
+	int fd = *((int*) packet.data_ptr);
+	if(fd_buffer_.size() < packet.data_size) {
+		fd_buffer_.resize(packet.data_size);
+	}
+	uint_fast32_t read_bytes = 0;
+	while(read_bytes < packet.data_size) {
+		ssize_t result = pread(fd, fd_buffer_.data() + read_bytes, packet.data_size - read_bytes,
+							   packet.data_offset + read_bytes);
+		if(result < 0 && errno == EINTR) {
+			continue;
+		}
+		if(result <= 0) {
+			return false;
+		}
+		read_bytes += result;
+	}
+	return fwrite(fd_buffer_.data(), packet.data_size, 1, file_) == 1;
+}
+
+bool StreamRecorder::record(RealTimeInfo* info, const DataPacketsList& list) {
+	if(file_ == NULL) {
+		error_handler_.set_error("You must open the recording file first.");
+		return false;
+	}
+	bool written = write_u32(file_, info->get_sequence_number()) &&
+				   write_u32(file_, info->is_skipped_data() || info->is_predicted_skip()) &&
+				   write_u32(file_, list.num_packets);
+	for(uint_fast32_t i=0; written && i<list.num_packets; i++) {
+		written = write_u32(file_, list.packets[i].data_size);
+	}
+	for(uint_fast32_t i=0; written && payloads_ && i<list.num_packets; i++) {
+		written = write_payload(list.packets[i]);
+	}
+	if(!written) {
+		error_handler_.set_error(string("Can't write the frame to the recording file : ") + strerror(errno));
+		return false;
+	}
+	frames_++;
+	return true;
+}
+
+bool StreamRecorder::close() {
+	if(file_ == NULL) {
+		return true;
+	}
+	bool closed = fclose(file_) == 0;
+	file_ = NULL;
+	if(!closed) {
+		error_handler_.set_error("Can't write the end of the recording file.");
+	}
+	return closed;
+}
+
+uint_fast32_t StreamRecorder::get_frames() {
+	return frames_;
+}
+
+string StreamRecorder::get_error() {
+	string error = error_handler_.get_error();
+	error_handler_.clear_error();
+	return error;
+}
+
+bool StreamRecorder::is_error() {
+	return error_handler_.is_error();
+}
+
+StreamRecorder::~StreamRecorder() {
+	close();
+}
+
+StreamReplayer::StreamReplayer() : error_handler_("StreamReplayer") {
+	frequency_ = 0;
+	has_payloads_ = false;
+	loop_ = false;
+}
+
+bool StreamReplayer::load(const char* path) {
+	frames_.clear();
+	sizes_.clear();
+	payloads_.clear();
+	pattern_.clear();
+	FILE* file = fopen(path, "rb");
+	if(file == NULL) {
+		error_handler_.set_error(string("Can't open the recording file : ") + strerror(errno));
+		return false;
+	}
+	char magic[sizeof(STREAM_RECORDING_MAGIC) - 1];
+	uint_fast32_t flags, frequency;
+	if(fread(magic, sizeof(magic), 1, file) != 1 || memcmp(magic, STREAM_RECORDING_MAGIC, sizeof(magic)) != 0 ||
+	   !read_u32(file, &flags) || !read_u32(file, &frequency) || frequency == 0) {
+		error_handler_.set_error("The file is not a stream recording.");
+		fclose(file);
+		return false;
+	}
+	has_payloads_ = (flags & STREAM_RECORDING_PAYLOADS) != 0;
+	frequency_ = frequency;
+
+	uint_fast32_t max_size = 0;
+	bool complete = true;
+	RecordedFrame frame;
+	uint_fast32_t skipped = 0;
+	while(read_u32(file, &frame.sequence_number)) {
+		complete = read_u32(file, &skipped) && read_u32(file, &frame.num_packets);
+		frame.skipped = skipped != 0;
+		frame.first_packet = sizes_.size();
+		frame.first_byte = payloads_.size();
+		uint_fast64_t frame_bytes = 0;
+		for(uint_fast32_t i=0; complete && i<frame.num_packets; i++) {
+			uint_fast32_t size = 0;
+			complete = read_u32(file, &size);
+			sizes_.push_back(size);
+			frame_bytes += size;
+			max_size = max(max_size, size);
+		}
+		if(complete && has_payloads_ && frame_bytes != 0) {
+			payloads_.resize(frame.first_byte + frame_bytes);
+			complete = fread(&payloads_[frame.first_byte], frame_bytes, 1, file) == 1;
+		}
+		if(!complete) {
+			break;
+		}
+		frames_.push_back(frame);
+	}
+	fclose(file);
+	if(!complete) {
+		error_handler_.set_error("The recording file is truncated.");
+		return false;
+	}
+	if(!has_payloads_) {
+		//a pattern the receiver can tell from zeroed memory
+		pattern_.resize(max_size);
+		for(uint_fast32_t i=0; i<max_size; i++) {
+			pattern_[i] = (char) (i * 131 + 7);
+		}
+	}
+	return true;
+}
+
+void StreamReplayer::set_loop(bool loop) {
+	loop_ = loop;
+}
+
+DataPacketsList StreamReplayer::next_frame(RealTimeInfo* info) {
+	uint_fast32_t n = info->get_sequence_number();
+	if(frames_.empty() || (!loop_ && n >= frames_.size())) {
+		info->stop_system();
+		return DataPacketsList(0);
+	}
+	n %= frames_.size();
+	if(!loop_ && n + 1 == frames_.size()) {
+		info->stop_system();
+	}
+	const RecordedFrame& frame = frames_[n];
+	DataPacketsList list(frame.num_packets);
+	size_t byte = frame.first_byte;
+	for(uint_fast32_t i=0; i<frame.num_packets; i++) {
+		uint_fast32_t size = sizes_[frame.first_packet + i];
+		list.packets[i].data_ptr = has_payloads_ ? &payloads_[byte] : pattern_.data();
+		list.packets[i].data_size = size;
+		byte += size;
+	}
+	return list;
+}
+
+uint_fast16_t StreamReplayer::get_frequency() {
+	return frequency_;
+}
+
+uint_fast32_t StreamReplayer::get_frames() {
+	return frames_.size();
+}
+
+uint_fast64_t StreamReplayer::get_frame_bytes(uint_fast32_t n) {
+	if(n >= frames_.size()) {
+		return 0;
+	}
+	uint_fast64_t frame_bytes = 0;
+	for(uint_fast32_t i=0; i<frames_[n].num_packets; i++) {
+		frame_bytes += sizes_[frames_[n].first_packet + i];
+	}
+	return frame_bytes;
+}
+
+bool StreamReplayer::is_skipped_frame(uint_fast32_t n) {
+	return n < frames_.size() && frames_[n].skipped;
+}
+
+string StreamReplayer::get_error() {
+	string error = error_handler_.get_error();
+	error_handler_.clear_error();
+	return error;
+}
+
+bool StreamReplayer::is_error() {
+	return error_handler_.is_error();
+}
+
+StreamReplayer::~StreamReplayer() {
+}
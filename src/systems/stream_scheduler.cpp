@@ -0,0 +1,350 @@
+#include "../../includes/stream_scheduler.h"
+
+using namespace std;
+using namespace timers_utils;
+
+StreamScheduler::StreamScheduler() : placement_(CPU_CORE_AFFINITY, 99), error_handler_("StreamScheduler") {
+	num_threads_ = 1;
+	active_streams_ = 0;
+	initialized_ = false;
+	//the idle threads wait on the monotonic clock like the timers, or sleep on
+	//the clock set by timers_utils::set_clock(1)
+	pthread_mutex_init(&streams_mutex_, NULL);
+	pthread_condattr_t cond_attr;
+	pthread_condattr_init(&cond_attr);
+	pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&streams_cond_, &cond_attr);
+	pthread_condattr_destroy(&cond_attr);
+}
+
+bool StreamScheduler::add_stream(RealTimeSystem* system) {
+	initialized_ = false;
+	if(system == NULL) {
+		error_handler_.set_error("Null System provided");
+		return false;
+	}
+	Stream stream = {};
+	stream.system = system;
+	streams_.push_back(stream);
+	return true;
+}
+
+bool StreamScheduler::set_placement(const ThreadPlacement& placement) {
+	initialized_ = false;
+	if(!thread_placement::is_valid(placement)) {
+		error_handler_.set_error("Invalid placement, no cores or priority out of range");
+		return false;
+	}
+	placement_ = placement;
+	return true;
+}
+
+bool StreamScheduler::set_threads(uint_fast16_t num_threads) {
+	initialized_ = false;
+	if(num_threads == 0) {
+		error_handler_.set_error("At least one thread is needed");
+		return false;
+	}
+	num_threads_ = num_threads;
+	return true;
+}
+
+bool StreamScheduler::initialize() {
+
+	//checks for not given data
+	if(streams_.empty()) {
+		error_handler_.set_error("No streams provided");
+		return false;
+	}
+	if(num_threads_ > streams_.size()) {
+		error_handler_.set_error("More threads than streams");
+		return false;
+	}
+	for(uint_fast32_t i=0; i<streams_.size(); i++) {
+		RealTimeSystem* system = streams_[i].system;
+		if(!system->check_components(false)) {
+			error_handler_.set_error("Stream " + std::to_string(i) + ": " + system->get_error());
+			return false;
+		}
+		if(system->frequency_ > TIMER_MAX_FREQUENCY) {
+			error_handler_.set_error("Stream " + std::to_string(i) + ": the max frequency supported is " + std::to_string(TIMER_MAX_FREQUENCY));
+			return false;
+		}
+	}
+
+	//try to convert the process to real time one.
+	if(!thread_placement::make_real_time(placement_, &error_handler_)) {
+		return false;
+	}
+
+	//initialize the senders
+	for(uint_fast32_t i=0; i<streams_.size(); i++) {
+		RealTimeSystem* system = streams_[i].system;
+		if(!system->initialize_components(false)) {
+			error_handler_.set_error("Stream " + std::to_string(i) + ": " + system->get_error());
+			return false;
+		}
+	}
+
+	initialized_ = true;
+	return true;
+}
+
+bool StreamScheduler::run() {
+
+	//check initialization
+	if(!initialized_) {
+		error_handler_.set_error("Scheduler not initialized yet.");
+		return false;
+	}
+	//set the initialization flag to false again.
+	initialized_ = false;
+
+	//reset the ticks and prepare the first frames of each stream
+	vector<bool> started(streams_.size());
+	for(uint_fast32_t i=0; i<streams_.size(); i++) {
+		started[i] = streams_[i].system->start_ticks();
+		if(!started[i]) {
+			streams_[i].system->sender_->end_sender();
+		}
+	}
+
+	//start all the streams now
+	uint_fast64_t now = monotonic_ns();
+	for(uint_fast32_t i=0; i<streams_.size(); i++) {
+		Stream& stream = streams_[i];
+		stream.system->initialized_ = false;
+		stream.period_ps = SEC_TO_PS(1) / stream.system->frequency_;
+		stream.start_ns = now;
+		stream.tick_counter = 0;
+		stream.release_ns = now;
+		stream.event_ns = now;
+		stream.deadline_ns = now + PS_TO_NS(stream.period_ps);
+		stream.waiting_sender = false;
+		stream.busy = false;
+		stream.ended = !started[i];
+		stream.failed = !started[i];
+		stream.stats = StreamStats();
+	}
+	active_streams_ = count(started.begin(), started.end(), true);
+
+	//create the other scheduler threads
+	vector<pthread_t> threads;
+	for(uint_fast16_t i=1; i<num_threads_; i++) {
+
+		struct sched_param param;
+		pthread_attr_t attr;
+		pthread_t thread;
+
+		//same policy and priority as this thread
+		if(pthread_attr_init(&attr) ||
+		   pthread_attr_setschedpolicy(&attr, SCHED_FIFO)) {
+			error_handler_.set_error("init pthread attributes failed");
+			break;
+		}
+		param.sched_priority = placement_.priority;
+		if(pthread_attr_setschedparam(&attr, &param) ||
+		   pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED)) {
+			error_handler_.set_error("pthread setschedparam failed");
+			pthread_attr_destroy(&attr);
+			break;
+		}
+		int th_st = pthread_create(&thread, &attr, thread_function, (void*) this);
+		pthread_attr_destroy(&attr);
+		if(th_st) {
+			error_handler_.set_error("pthread_create() return code: " + std::to_string(th_st));
+			break;
+		}
+		threads.push_back(thread);
+	}
+
+	//this thread is a scheduler thread too, it still runs with fewer threads
+	//if some of them couldn't be created and the error is kept.
+	schedule_loop();
+
+	for(uint_fast32_t i=0; i<threads.size(); i++) {
+		pthread_join(threads[i], NULL);
+	}
+	for(uint_fast32_t i=0; i<streams_.size(); i++) {
+		streams_[i].system->end_ticks();
+	}
+
+	//report the first failed stream
+	for(uint_fast32_t i=0; i<streams_.size(); i++) {
+		if(streams_[i].failed) {
+			error_handler_.set_error("Stream " + std::to_string(i) + " failed: " + streams_[i].system->error_handler_.get_error());
+			return false;
+		}
+	}
+	return !error_handler_.is_error();
+}
+
+void* StreamScheduler::thread_function(void* scheduler) {
+	StreamScheduler* self = (StreamScheduler*) scheduler;
+	//the scheduling loop must run even if the placement fails, otherwise the
+	//streams assigned to this thread would never end.
+	thread_placement::set_affinity(self->placement_);
+	thread_placement::set_memory_node(self->placement_);
+	self->schedule_loop();
+	return NULL;
+}
+
+void StreamScheduler::schedule_loop() {
+
+	//release the lock whenever the scope of this function end
+	MutexRAII prot_lock(streams_mutex_);
+	prot_lock.lock_block();
+
+	while(active_streams_ > 0) {
+
+		//find the ready stream with the earliest deadline, and the earliest
+		//future event if none is ready
+		uint_fast64_t now = monotonic_ns();
+		Stream* ready = NULL;
+		Stream* next = NULL;
+		for(uint_fast32_t i=0; i<streams_.size(); i++) {
+			Stream& stream = streams_[i];
+			if(stream.ended || stream.busy) {
+				continue;
+			}
+			if(stream.event_ns <= now) {
+				if(ready == NULL || stream.deadline_ns < ready->deadline_ns) {
+					ready = &stream;
+				}
+			} else if(next == NULL || stream.event_ns < next->event_ns) {
+				next = &stream;
+			}
+		}
+
+		if(ready != NULL) {
+			ready->busy = true;
+			process_stream(*ready, now, prot_lock);
+			ready->busy = false;
+			//let the idle threads recheck the events
+			pthread_cond_broadcast(&streams_cond_);
+		} else if(next != NULL && get_clock() != NULL) {
+			//another clock only moves when slept on, sleep on it without
+			//the lock
+			uint_fast64_t sleep_time_ns = next->event_ns - now;
+			prot_lock.unlock();
+			nanoseconds_sleep(sleep_time_ns);
+			prot_lock.lock_block();
+		} else if(next != NULL) {
+			timespec wake_time;
+			wake_time.tv_sec = NS_TO_SEC(next->event_ns);
+			wake_time.tv_nsec = next->event_ns % SEC_TO_NS(1);
+			pthread_cond_timedwait(&streams_cond_, &streams_mutex_, &wake_time);
+		} else {
+			//all the remaining streams are handled by other threads
+			pthread_cond_wait(&streams_cond_, &streams_mutex_);
+		}
+	}
+
+	pthread_cond_broadcast(&streams_cond_);
+}
+
+void StreamScheduler::process_stream(Stream& stream, uint_fast64_t now, MutexRAII& prot_lock) {
+
+	RealTimeSystem* system = stream.system;
+	uint_fast64_t tolerance_end_ns = stream.release_ns + MS_TO_NS(system->ms_tolerance_);
+
+	//first look at this tick
+	if(!stream.waiting_sender) {
+		stream.stats.max_wake_delay_ns = max(stream.stats.max_wake_delay_ns, now - stream.release_ns);
+	}
+
+	//if the sender not done yet, then let it consume as much as wanted from
+	//the extra time, recheck each 0.5ms like RealTimeSystem::run(0).
+	if(!system->sender_->is_send_done() && now < tolerance_end_ns) {
+		stream.waiting_sender = true;
+		stream.event_ns = min(now + US_TO_NS(500), tolerance_end_ns);
+		stream.deadline_ns = tolerance_end_ns;
+		return;
+	}
+	uint_fast32_t used_tolerated_time = 0;
+	if(stream.waiting_sender) {
+		used_tolerated_time = min(uint_fast64_t(system->ms_tolerance_*2), NS_TO_US(now - stream.release_ns) / 500);
+	}
+	stream.waiting_sender = false;
+
+	//handle the tick without holding the lock
+	prot_lock.unlock();
+	system->usage_.begin();
+	RealTimeSystem::TICK_RESULT result = system->process_tick(used_tolerated_time);
+	system->usage_.end(system->sequence_number_);
+	uint_fast64_t done = monotonic_ns();
+	prot_lock.lock_block();
+
+	stream.stats.ticks++;
+	switch(result) {
+		case RealTimeSystem::TICK_SENT:
+			stream.stats.sent++;
+		break;
+		case RealTimeSystem::TICK_SKIPPED:
+			stream.stats.skipped++;
+		break;
+		case RealTimeSystem::TICK_FAILED:
+			stream.failed = true;
+			stream.ended = true;
+		break;
+		case RealTimeSystem::TICK_STOPPED:
+			stream.ended = true;
+		break;
+	}
+	if(stream.ended) {
+		active_streams_--;
+		return;
+	}
+
+	//handled after the end of its time slot
+	if(done > stream.release_ns + PS_TO_NS(stream.period_ps)) {
+		stream.stats.missed++;
+	}
+	next_tick(stream);
+	//drop the ticks which time slots already ended
+	while(stream.release_ns + PS_TO_NS(stream.period_ps) <= done) {
+		stream.stats.missed++;
+		next_tick(stream);
+	}
+}
+
+void StreamScheduler::next_tick(Stream& stream) {
+	/**
+	 * prevent overflow: same as the timers, the start time is moved to the
+	 * current tick when the counter reaches 2^23.
+	 */
+	if(stream.tick_counter == (uint_fast32_t (1 << 23))) {
+		stream.start_ns = stream.release_ns;
+		stream.tick_counter = 0;
+	}
+	stream.tick_counter++;
+	stream.release_ns = stream.start_ns + PS_TO_NS(stream.period_ps * stream.tick_counter);
+	stream.event_ns = stream.release_ns;
+	stream.deadline_ns = stream.release_ns + PS_TO_NS(stream.period_ps);
+}
+
+bool StreamScheduler::get_stream_stats(uint_fast32_t index, StreamStats* stats) {
+	if(index >= streams_.size()) {
+		error_handler_.set_error("No stream with index " + std::to_string(index));
+		return false;
+	}
+	MutexRAII prot_lock(streams_mutex_);
+	prot_lock.lock_block();
+	*stats = streams_[index].stats;
+	return true;
+}
+
+std::string StreamScheduler::get_error() {
+	std::string error = error_handler_.get_error();
+	error_handler_.clear_error();
+	return error;
+}
+
+bool StreamScheduler::is_error() {
+	return error_handler_.is_error();
+}
+
+StreamScheduler::~StreamScheduler() {
+	pthread_cond_destroy(&streams_cond_);
+	pthread_mutex_destroy(&streams_mutex_);
+}
@@ -0,0 +1,108 @@
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../includes/crc32c.h"
+#include "../../includes/frame_header.h"
+#include "../../includes/timers.h"
+
+using namespace std;
+using namespace timers_utils;
+
+int main(int argc, char** argv) {
+
+	if(argc != 1 && argc != 3) {
+		printf("CRC32C test\n");
+		printf("\n");
+		printf("Usage:\n");
+		printf("%s [frame_size_in_bytes frequency]\n", argv[0]);
+		exit(0);
+	}
+
+	uint_fast32_t frame_size = 300000;
+	uint_fast32_t frequency = 30;
+	if(argc == 3) {
+		frame_size = atoi(argv[1]);
+		frequency = atoi(argv[2]);
+	}
+
+	//known answer
+	const char* check = "123456789";
+	if(crc32c::compute(check, 9) != 0xE3069283u || crc32c::extend_portable(0, check, 9) != 0xE3069283u) {
+		cout << "Wrong checksum for the check string." << endl;
+		return 1;
+	}
+
+	//hardware and table implementations must agree for all sizes and alignments
+	uint8_t* data = (uint8_t*) malloc(frame_size + 64);
+	for(uint_fast32_t i=0; i<frame_size + 64; i++) {
+		data[i] = uint8_t(rand());
+	}
+	for(int offset=0; offset<8; offset++) {
+		for(int size=0; size<200; size++) {
+			if(crc32c::compute(data + offset, size) != crc32c::extend_portable(0, data + offset, size)) {
+				cout << "Mismatch between the implementations at offset " << offset << " size " << size << "." << endl;
+				return 2;
+			}
+		}
+	}
+	//extending must be the same as computing the whole buffer
+	if(crc32c::extend(crc32c::compute(data, 1000), data + 1000, 3000) != crc32c::compute(data, 4000)) {
+		cout << "Extending the checksum gives different result." << endl;
+		return 3;
+	}
+
+	//frame header over two packets
+	DataPacketsList list(2);
+	list.packets[0] = DataPacket();
+	list.packets[0].data_ptr = data;
+	list.packets[0].data_size = frame_size / 2;
+	list.packets[1] = DataPacket();
+	list.packets[1].data_ptr = data;
+	list.packets[1].data_offset = frame_size / 2;
+	list.packets[1].data_size = frame_size - frame_size / 2;
+	FrameHeader header;
+	frame_header::build(list, 0, &header);
+	if(header.frame_size != frame_size || !frame_header::verify(&header, data)) {
+		cout << "Frame header verification failed." << endl;
+		return 4;
+	}
+	data[frame_size / 3] ^= 1;
+	if(frame_header::verify(&header, data)) {
+		cout << "Frame header verification didn't detect the corruption." << endl;
+		return 5;
+	}
+	cout << "All checks passed." << endl;
+
+	//throughput against the tick budget, the checksums are summed so the
+	//loops are kept and both implementations must give the same sum
+	const int iterations = 1000;
+	uint32_t hw_sum = 0, table_sum = 0;
+	timespec start_time, mid_time, end_time;
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+	for(int i=0; i<iterations; i++) {
+		hw_sum += crc32c::compute(data, frame_size);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &mid_time);
+	for(int i=0; i<iterations; i++) {
+		table_sum += crc32c::extend_portable(0, data, frame_size);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end_time);
+	if(hw_sum != table_sum) {
+		cout << "The checksums of the two implementations differ." << endl;
+		return 6;
+	}
+
+	double tick_ns = 1e9 / frequency;
+	double hw_ns = double(TIMESPEC_DIFF_NS(start_time, mid_time)) / iterations;
+	double table_ns = double(TIMESPEC_DIFF_NS(mid_time, end_time)) / iterations;
+	printf("Frame : %lu bytes at %lu fps (checksums sum %08x)\n", frame_size, frequency, hw_sum);
+	printf("%-10s : %8.1f us/frame, %6.2f GB/s, %.3f%% of the tick\n", crc32c::is_hardware_accelerated() ? "hardware" : "table",
+		hw_ns / 1000, frame_size / hw_ns, 100 * hw_ns / tick_ns);
+	printf("%-10s : %8.1f us/frame, %6.2f GB/s, %.3f%% of the tick\n", "table",
+		table_ns / 1000, frame_size / table_ns, 100 * table_ns / tick_ns);
+
+	free(data);
+	return 0;
+}
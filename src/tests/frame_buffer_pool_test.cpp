@@ -0,0 +1,133 @@
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "../../includes/frame_buffer_pool.h"
+#include "../../includes/senders.h"
+#include "../../includes/systems.h"
+#include "../../includes/timers.h"
+
+using namespace std;
+using namespace timers_utils;
+
+/**
+ * The frames are written to the buffers of a small pool and sent by the
+ * sender to a client on the loopback, every buffer must be back in the pool
+ * at the end and all the frames must be received.
+ */
+
+struct ReceiverData{
+	uint_fast16_t port;
+	uint_fast64_t received_bytes;
+};
+
+//connect to the sender and read until it closes the connection
+static void* receiver_function(void* data) {
+	ReceiverData* receiver = (ReceiverData*) data;
+	int sock_fd = socket(AF_INET, SOCK_STREAM, 0);
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_port = htons(receiver->port);
+	inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+	//the sender may not listen yet
+	while(connect(sock_fd, (sockaddr*) &address, sizeof(address)) != 0) {
+		milliseconds_sleep(10);
+	}
+	char buffer[64*1024];
+	ssize_t r;
+	while((r = recv(sock_fd, buffer, sizeof(buffer), 0)) > 0) {
+		receiver->received_bytes += r;
+	}
+	close(sock_fd);
+	return NULL;
+}
+
+int main(int argc, char** argv) {
+
+	if(argc != 1 && argc != 2) {
+		printf("Frame buffer pool test\n");
+		printf("\n");
+		printf("Usage:\n");
+		printf("%s [zerocopy|nozerocopy]\n", argv[0]);
+		exit(0);
+	}
+	bool zerocopy = argc == 2 && strcmp(argv[1], "zerocopy") == 0;
+
+	const uint_fast32_t frame_size = 1024*1024;
+	const uint_fast32_t num_buffers = 3;
+	const uint_fast32_t frames = 100;
+
+	FrameBufferPool pool;
+	if(!pool.initialize(frame_size, num_buffers)) {
+		cout << pool.get_error() << endl;
+		return 1;
+	}
+
+	uint_fast32_t sent_frames = 0, empty_frames = 0;
+	auto user_fn = [&](RealTimeInfo* info) {
+		if(info->get_sequence_number() + 1 == frames) {
+			info->stop_system();
+			return DataPacketsList(0);
+		}
+		FrameBuffer* buffer = pool.acquire();
+		//all the buffers are in flight, nothing to send this tick
+		if(buffer == NULL) {
+			empty_frames++;
+			return DataPacketsList(0);
+		}
+		memset(buffer->data, info->get_sequence_number(), frame_size);
+		DataPacketsList list(1);
+		list.packets[0] = buffer->make_packet(frame_size);
+		if(!info->is_skipped_data()) {
+			sent_frames++;
+		}
+		return list;
+	};
+
+	ReceiverData receiver = {7576, 0};
+	pthread_t receiver_thread;
+	pthread_create(&receiver_thread, NULL, receiver_function, (void*) &receiver);
+
+	Sender* sender;
+	if(zerocopy) {
+		sender = new TCPSenderZC(receiver.port);
+	} else {
+		sender = new TCPSender(receiver.port);
+	}
+	FreeWaitTimer timer;
+	RealTimeSystem system;
+	system.set_user_data_fn(user_fn);
+	system.set_timer(&timer);
+	system.set_sender(sender);
+	system.set_frequency(50);
+	system.skip_mode(true);
+	if(!system.initialize() || !system.run()) {
+		cout << "Failed to run the system." << endl;
+		cout << system.get_error() << endl;
+		return 1;
+	}
+	pthread_join(receiver_thread, NULL);
+	delete sender;
+
+	uint_fast64_t expected_bytes = uint_fast64_t(sent_frames) * frame_size;
+	cout << "Sent frames: " << sent_frames << ", ticks without a buffer: " << empty_frames << endl;
+	cout << "Received bytes: " << receiver.received_bytes << " of " << expected_bytes << endl;
+	cout << "Free buffers: " << pool.available() << " of " << num_buffers << endl;
+
+	bool failed = false;
+	if(pool.available() != num_buffers) {
+		cout << "Some buffers were not given back to the pool." << endl;
+		failed = true;
+	}
+	if(receiver.received_bytes != expected_bytes) {
+		cout << "Some frames were not received." << endl;
+		failed = true;
+	}
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,210 @@
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/errqueue.h>
+#include <linux/perf_event.h>
+
+#include "../../includes/huge_page_memory.h"
+#include "../../includes/timers.h"
+
+using namespace std;
+using namespace timers_utils;
+
+/**
+ * The same frames are sent with MSG_ZEROCOPY from a malloc'd buffer and from
+ * a locked huge page block, the time spent in send(2) (mostly pinning the
+ * pages) and the dTLB misses of a random read sweep over the buffer are
+ * reported for both.
+ */
+
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY	60
+#endif
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY	0x4000000
+#endif
+
+//read everything from the listening socket until the sender closes
+static void* receiver_function(void* data) {
+	int client_fd = accept(*((int*) data), NULL, NULL);
+	char buffer[256*1024];
+	while(recv(client_fd, buffer, sizeof(buffer), 0) > 0);
+	close(client_fd);
+	return NULL;
+}
+
+//open a counter of the dTLB read misses of this thread, -1 if not available
+static int open_dtlb_counter() {
+	perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = PERF_TYPE_HW_CACHE;
+	attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+		(PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+//read one byte of each 4K page in a random order, return the dTLB misses
+static long long random_sweep(char* buffer, size_t size, volatile char* sink) {
+	size_t pages = size / 4096;
+	int counter = open_dtlb_counter();
+	if(counter >= 0) {
+		ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+		ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+	}
+	size_t page = 0;
+	for(size_t i=0; i<pages*4; i++) {
+		//visits all the pages before repeating if their number is a power of 2
+		page = (page * 1103515245 + 12345) % pages;
+		*sink += buffer[page * 4096];
+	}
+	long long misses = -1;
+	if(counter >= 0) {
+		ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+		if(read(counter, &misses, sizeof(misses)) != sizeof(misses)) {
+			misses = -1;
+		}
+		close(counter);
+	}
+	return misses;
+}
+
+//wait until the kernel released all the zero copy sends
+static bool wait_completions(int sock_fd, uint_fast32_t sends) {
+	uint_fast32_t completed = 0;
+	while(completed < sends) {
+		pollfd pfd = {sock_fd, 0, 0};
+		if(poll(&pfd, 1, 1000) != 1 || (pfd.revents & POLLERR) == 0) {
+			return false;
+		}
+		char control[100];
+		msghdr msg;
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_control = control;
+		msg.msg_controllen = sizeof(control);
+		if(recvmsg(sock_fd, &msg, MSG_ERRQUEUE) == -1) {
+			return false;
+		}
+		for(cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm != NULL; cm = CMSG_NXTHDR(&msg, cm)) {
+			sock_extended_err* serr = (sock_extended_err*) CMSG_DATA(cm);
+			if(serr->ee_origin == SO_EE_ORIGIN_ZEROCOPY) {
+				completed += serr->ee_data - serr->ee_info + 1;
+			}
+		}
+	}
+	return true;
+}
+
+//send the buffer frames times with MSG_ZEROCOPY, return the ns spent in send(2)
+static bool zerocopy_send(uint_fast16_t port, char* buffer, size_t size, uint_fast32_t frames, uint_fast64_t* send_ns) {
+	int server_fd = socket(AF_INET, SOCK_STREAM, 0);
+	int yes = 1;
+	setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_port = htons(port);
+	inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+	if(bind(server_fd, (sockaddr*) &address, sizeof(address)) != 0 || listen(server_fd, 1) != 0) {
+		close(server_fd);
+		return false;
+	}
+	pthread_t receiver_thread;
+	pthread_create(&receiver_thread, NULL, receiver_function, (void*) &server_fd);
+	int sock_fd = socket(AF_INET, SOCK_STREAM, 0);
+	bool done = connect(sock_fd, (sockaddr*) &address, sizeof(address)) == 0 &&
+		setsockopt(sock_fd, SOL_SOCKET, SO_ZEROCOPY, &yes, sizeof(yes)) == 0;
+	const size_t chunk = 1024*1024;
+	*send_ns = 0;
+	for(uint_fast32_t f=0; f<frames && done; f++) {
+		uint_fast32_t sends = 0;
+		for(size_t offset=0; offset<size && done; ) {
+			uint_fast64_t start = monotonic_ns();
+			ssize_t s = send(sock_fd, buffer + offset, min(chunk, size - offset), MSG_ZEROCOPY);
+			*send_ns += monotonic_ns() - start;
+			if(s < 0) {
+				done = false;
+				break;
+			}
+			offset += s;
+			sends++;
+		}
+		done = done && wait_completions(sock_fd, sends);
+	}
+	shutdown(sock_fd, SHUT_RDWR);
+	close(sock_fd);
+	pthread_join(receiver_thread, NULL);
+	close(server_fd);
+	return done;
+}
+
+static const char* kind_name(HugePageBlock::PAGE_KIND kind) {
+	switch(kind) {
+		case HugePageBlock::HUGETLB_PAGES:
+			return "hugetlb";
+		case HugePageBlock::TRANSPARENT_HUGE_PAGES:
+			return "transparent huge pages";
+		default:
+			return "normal pages";
+	}
+}
+
+int main(int argc, char** argv) {
+
+	if(argc != 1 && argc != 3) {
+		printf("Huge page benchmark\n");
+		printf("\n");
+		printf("Usage:\n");
+		printf("%s [frame_size_in_MB frames]\n", argv[0]);
+		exit(0);
+	}
+
+	size_t size = 32*1024*1024;
+	uint_fast32_t frames = 20;
+	if(argc == 3) {
+		size = size_t(atoi(argv[1])) * 1024*1024;
+		frames = atoi(argv[2]);
+	}
+
+	char* normal = (char*) malloc(size);
+	HugePageBlock block;
+	if(normal == NULL || !huge_page_memory::allocate(size, &block)) {
+		cout << "Failed to allocate the buffers." << endl;
+		return 1;
+	}
+	memset(normal, 1, size);
+	memset(block.memory, 1, size);
+	printf("Huge page block backed by %s\n", kind_name(block.kind));
+
+	volatile char sink = 0;
+	uint_fast64_t normal_ns = 0, huge_ns = 0;
+	if(!zerocopy_send(7577, normal, size, frames, &normal_ns) ||
+	   !zerocopy_send(7578, (char*) block.memory, size, frames, &huge_ns)) {
+		cout << "Failed to send with MSG_ZEROCOPY." << endl;
+		return 1;
+	}
+	long long normal_misses = random_sweep(normal, size, &sink);
+	long long huge_misses = random_sweep((char*) block.memory, size, &sink);
+
+	double mb = double(size) * frames / (1024*1024);
+	printf("%-8s %16s %16s\n", "memory", "send ns per MB", "dTLB misses");
+	printf("%-8s %16.0f %16lld\n", "malloc", normal_ns / mb, normal_misses);
+	printf("%-8s %16.0f %16lld\n", "huge", huge_ns / mb, huge_misses);
+	if(normal_misses < 0) {
+		printf("(dTLB misses not available, -1)\n");
+	}
+
+	huge_page_memory::deallocate(&block);
+	free(normal);
+	return 0;
+}
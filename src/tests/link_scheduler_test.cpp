@@ -0,0 +1,147 @@
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include <atomic>
+
+#include "../../includes/link_scheduler.h"
+#include "../../includes/timers.h"
+
+using namespace std;
+using namespace timers_utils;
+
+/**
+ * three flows share a simulated 1GB/s link, two big frames with weights 2
+ * and 1 which last longer than the test and a small metadata frame each 1ms,
+ * the big flows must get the link in the ratio of their weights and the small
+ * one must never wait for a whole frame.
+ */
+
+struct FlowData{
+	LinkScheduler* link;
+	int flow_id;
+	uint_fast32_t frame_bytes;
+	uint_fast32_t frames;
+	//results
+	uint_fast64_t written_bytes;
+	uint_fast64_t max_frame_ns;
+};
+
+static std::atomic<int> writers = {0};
+static std::atomic<bool> overlap = {false};
+static std::atomic<bool> stop = {false};
+
+//write the bytes on the simulated link, 1 byte per ns
+static void write_link(uint_fast32_t bytes) {
+	if(writers.fetch_add(1) != 0) {
+		overlap = true;
+	}
+	uint_fast64_t end = monotonic_ns() + bytes;
+	while(monotonic_ns() < end);
+	writers.fetch_sub(1);
+}
+
+static void* flow_function(void* data) {
+	FlowData* flow = (FlowData*) data;
+	for(uint_fast32_t f=0; f<flow->frames && !stop; f++) {
+		uint_fast64_t start = monotonic_ns();
+		flow->link->begin_frame(flow->flow_id);
+		uint_fast32_t remaining = flow->frame_bytes;
+		while(remaining != 0 && !stop) {
+			uint_fast32_t chunk = min(remaining, flow->link->get_chunk_size());
+			if(!flow->link->acquire(flow->flow_id, chunk)) {
+				return NULL;
+			}
+			write_link(chunk);
+			flow->link->release(flow->flow_id, chunk);
+			flow->written_bytes += chunk;
+			remaining -= chunk;
+		}
+		flow->link->end_frame(flow->flow_id);
+		flow->max_frame_ns = max(flow->max_frame_ns, monotonic_ns() - start);
+		//the metadata stream sends each 1ms
+		if(flow->frame_bytes < flow->link->get_chunk_size()) {
+			nanoseconds_sleep(MS_TO_NS(1));
+		}
+	}
+	return NULL;
+}
+
+int main(int argc, char** argv) {
+
+	if(argc != 1) {
+		printf("Link scheduler test\n");
+		printf("\n");
+		printf("Usage:\n");
+		printf("%s\n", argv[0]);
+		exit(0);
+	}
+
+	LinkScheduler link(64*1024);
+	FlowData flows[3] = {
+		{&link, link.add_flow(0, 2), 1u << 31, 1, 0, 0},
+		{&link, link.add_flow(0, 1), 1u << 31, 1, 0, 0},
+		{&link, link.add_flow(1024, 1), 1024, 1000000, 0, 0},
+	};
+	if(link.add_flow(0, 0) != -1) {
+		cout << "Zero weight accepted." << endl;
+		return 1;
+	}
+
+	pthread_t threads[3];
+	for(int i=0; i<3; i++) {
+		pthread_create(&threads[i], NULL, flow_function, (void*) &flows[i]);
+	}
+	milliseconds_sleep(1000);
+	stop = true;
+	//wake any flow still waiting for the link
+	for(int i=0; i<3; i++) {
+		link.remove_flow(flows[i].flow_id);
+	}
+	for(int i=0; i<3; i++) {
+		pthread_join(threads[i], NULL);
+	}
+
+	double ratio = double(flows[0].written_bytes) / double(flows[1].written_bytes);
+	cout << "Weight 2 flow: " << flows[0].written_bytes << " bytes." << endl;
+	cout << "Weight 1 flow: " << flows[1].written_bytes << " bytes." << endl;
+	cout << "Ratio: " << ratio << endl;
+	cout << "Metadata flow: " << flows[2].written_bytes << " bytes, worst frame time: "
+		 << NS_TO_US(flows[2].max_frame_ns) << " us." << endl;
+
+	bool failed = false;
+	if(overlap) {
+		cout << "Two flows wrote to the link at the same time." << endl;
+		failed = true;
+	}
+	if(ratio < 1.6 || ratio > 2.4) {
+		cout << "The link is not shared by the weights." << endl;
+		failed = true;
+	}
+	//the metadata waits for one round of the big flows (3 chunks, ~200us), the
+	//limit is loose since the flows may share a single core.
+	if(flows[2].max_frame_ns > MS_TO_NS(10)) {
+		cout << "The metadata flow waited for the big frames." << endl;
+		failed = true;
+	}
+	//the slots of the removed flows are reused, their ids stay invalid
+	int new_flow = link.add_flow(0, 1);
+	bool reused = new_flow != -1;
+	for(int i=0; i<3; i++) {
+		reused &= new_flow != flows[i].flow_id && !link.acquire(flows[i].flow_id, 1);
+	}
+	reused &= link.acquire(new_flow, 1);
+	link.remove_flow(new_flow);
+	//more flows than the slots of the ids over the life of the link
+	for(int i=0; i<100000 && reused; i++) {
+		int flow_id = link.add_flow(0, 1);
+		reused = flow_id != -1;
+		link.remove_flow(flow_id);
+	}
+	if(!reused) {
+		cout << "The removed flows are not replaced." << endl;
+		failed = true;
+	}
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,144 @@
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "../../includes/systems.h"
+#include "../../includes/timers.h"
+
+using namespace std;
+using namespace timers_utils;
+
+/**
+ * The user function costs a random time each tick, the time between the
+ * tick and the hand off to the sender is measured with and without the
+ * producer lookahead, with the lookahead it should not depend on that cost.
+ * the jitter is the spread of the 10th to the 90th percentile of the hand
+ * off delays, the first ticks while the producer fills the queue are not
+ * measured.
+ * the wall clock jitters depend on the load of the machine, so they are only
+ * reported, the test fails if a system can't run or doesn't hand off data.
+ */
+
+//a sender which only records when the data was handed to it
+class HandOffSender{
+
+public:
+
+	uint_fast64_t start_ns = 0;
+	uint_fast64_t period_ns = 0;
+	uint_fast64_t sends = 0;
+	//ticks not measured
+	uint_fast64_t warmup = 0;
+	//hand off time of each tick relative to the first measured one
+	std::vector<int_fast64_t> delays_ns;
+
+	bool initialize() {
+		return true;
+	}
+	bool send(DataPacketsList*) {
+		uint_fast64_t now = monotonic_ns();
+		if(sends++ < warmup) {
+			return true;
+		}
+		if(delays_ns.empty()) {
+			start_ns = now;
+		}
+		delays_ns.push_back(int_fast64_t(now - start_ns) - int_fast64_t(delays_ns.size() * period_ns));
+		return true;
+	}
+	bool is_send_done() {
+		return true;
+	}
+	bool get_link_state(SenderLinkState*) {
+		return false;
+	}
+	bool is_reconnecting() {
+		return false;
+	}
+	bool end_sender() {
+		return true;
+	}
+	std::string get_error() {
+		return "";
+	}
+};
+
+static bool run_test(uint_fast16_t frequency, uint_fast32_t max_cost_us, uint_fast16_t lookahead, uint_fast32_t seconds,
+					 int_fast64_t* jitter_us) {
+
+	uint_fast32_t ticks = frequency * seconds;
+	auto user_fn = [ticks, max_cost_us](RealTimeInfo* info) {
+		//simulate a capture with a variable cost
+		uint_fast64_t end = monotonic_ns() + US_TO_NS(rand() % (max_cost_us + 1));
+		while(monotonic_ns() < end);
+		if(info->get_sequence_number() + 1 == ticks) {
+			info->stop_system();
+		}
+		return DataPacketsList(0);
+	};
+
+	HandOffSender sender;
+	sender.period_ns = SEC_TO_NS(1) / frequency;
+	sender.warmup = lookahead + 1;
+	sender.delays_ns.reserve(ticks);
+	FreeWaitTimer timer;
+	RealTimeSystemT<FreeWaitTimer, HandOffSender, decltype(user_fn)> system(user_fn);
+	system.set_timer(&timer);
+	system.set_sender(&sender);
+	system.set_frequency(frequency);
+	system.skip_mode(true);
+	system.set_lookahead(lookahead);
+	//on a single core the producer runs in the time the timer sleeps
+	if(!system.initialize() || !system.run()) {
+		cout << "Failed to run the system." << endl;
+		cout << system.get_error() << endl;
+		return false;
+	}
+
+	//every tick sends, nothing is skipped since the sender is always done
+	std::vector<int_fast64_t>& delays = sender.delays_ns;
+	if(delays.empty()) {
+		cout << "No tick was measured." << endl;
+		return false;
+	}
+	std::sort(delays.begin(), delays.end());
+	*jitter_us = NS_TO_US(delays[delays.size() * 9 / 10] - delays[delays.size() / 10]);
+	printf("Lookahead %lu : %lu sends, hand off jitter %ld us (%ld us with the outliers)\n", lookahead,
+		sender.sends, long(*jitter_us), long(NS_TO_US(delays.back() - delays.front())));
+	return true;
+}
+
+int main(int argc, char** argv) {
+
+	if(argc != 1 && argc != 4) {
+		printf("Lookahead test\n");
+		printf("\n");
+		printf("Usage:\n");
+		printf("%s [frequency max_user_function_cost_in_us lookahead_depth]\n", argv[0]);
+		exit(0);
+	}
+
+	//a slow frequency leaves time for the stalls of a loaded machine, a tick
+	//ending after the next one fails the system
+	uint_fast16_t frequency = 20;
+	uint_fast32_t max_cost_us = 5000;
+	uint_fast16_t lookahead = 2;
+	if(argc == 4) {
+		frequency = atoi(argv[1]);
+		max_cost_us = atoi(argv[2]);
+		lookahead = atoi(argv[3]);
+	}
+
+	int_fast64_t jitter_us = 0, lookahead_jitter_us = 0;
+	if(!run_test(frequency, max_cost_us, 0, 3, &jitter_us) ||
+	   !run_test(frequency, max_cost_us, lookahead, 3, &lookahead_jitter_us)) {
+		return 1;
+	}
+	printf("Hand off jitter without the lookahead %ld us, with a lookahead of %lu %ld us\n", long(jitter_us),
+		lookahead, long(lookahead_jitter_us));
+	return 0;
+}
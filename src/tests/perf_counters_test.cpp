@@ -0,0 +1,119 @@
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "../../includes/senders.h"
+#include "../../includes/systems.h"
+#include "../../includes/timers.h"
+#include "../../includes/perf_counters.h"
+
+using namespace std;
+using namespace timers_utils;
+
+/**
+ * The counters of this thread count a loop of known work, an interval of
+ * another thread is ignored, then a system with the counters on must count
+ * each tick and the bytes handed to the sender.
+ * the counters the machine doesn't provide are printed as not opened, the
+ * test passes without any counter only if none can be opened at all.
+ */
+
+static PerfCounters counters;
+
+static void* other_thread_function(void*) {
+	counters.begin();
+	counters.end(1000);
+	return NULL;
+}
+
+static void print_stats(const char* name, const PerfCounterStats& stats) {
+	printf("%s: %lu intervals %lu bytes, kernel %s\n", name, (unsigned long) stats.intervals,
+		(unsigned long) stats.bytes, stats.kernel_included ? "included" : "excluded");
+	for(int id=0; id<PERF_COUNTERS; id++) {
+		if(stats.opened[id]) {
+			printf("    %-18s %12lu\n", perf_counters::name(PERF_COUNTER_ID(id)), (unsigned long) stats.values[id]);
+		} else {
+			printf("    %-18s %12s\n", perf_counters::name(PERF_COUNTER_ID(id)), "not opened");
+		}
+	}
+}
+
+int main(int argc, char** argv) {
+
+	if(argc != 1) {
+		printf("Perf counters test\n");
+		printf("\n");
+		printf("Usage:\n");
+		printf("%s\n", argv[0]);
+		exit(0);
+	}
+
+	if(!counters.open()) {
+		cout << counters.get_error() << ", nothing to test." << endl;
+		return 0;
+	}
+
+	bool failed = false;
+	volatile uint_fast64_t sum = 0;
+	counters.begin();
+	for(uint_fast64_t i=0; i<10000000; i++) {
+		sum += i;
+	}
+	counters.end(10000000);
+	pthread_t other_thread;
+	pthread_create(&other_thread, NULL, other_thread_function, NULL);
+	pthread_join(other_thread, NULL);
+
+	PerfCounterStats stats;
+	counters.get_stats(&stats);
+	print_stats("loop", stats);
+	if(stats.intervals != 1 || stats.bytes != 10000000) {
+		cout << "The interval of another thread was counted." << endl;
+		failed = true;
+	}
+	if(stats.opened[PERF_INSTRUCTIONS] && stats.values[PERF_INSTRUCTIONS] < 10000000) {
+		cout << "Less instructions than loop iterations." << endl;
+		failed = true;
+	}
+	if(stats.opened[PERF_TASK_CLOCK] && stats.values[PERF_TASK_CLOCK] == 0) {
+		cout << "The loop took no time." << endl;
+		failed = true;
+	}
+	counters.close();
+
+	const uint_fast32_t ticks = 30;
+	char frame[32*1024];
+	auto user_fn = [&](RealTimeInfo* info) {
+		if(info->get_sequence_number() + 1 >= ticks) {
+			info->stop_system();
+		}
+		DataPacketsList list(2);
+		for(int i=0; i<2; i++) {
+			list.packets[i].data_ptr = frame;
+			list.packets[i].data_size = sizeof(frame);
+		}
+		return list;
+	};
+	MockSender sender;
+	FreeWaitTimer timer;
+	RealTimeSystem system;
+	system.set_user_data_fn(user_fn);
+	system.set_timer(&timer);
+	system.set_sender(&sender);
+	system.set_frequency(100);
+	system.set_perf_counters(true);
+	if(!system.initialize() || !system.run()) {
+		cout << system.get_error() << endl;
+		failed = true;
+	}
+	system.get_perf_stats(&stats);
+	print_stats("system", stats);
+	//the last tick stops the system without sending
+	if(stats.intervals != ticks || stats.bytes != (ticks - 1) * 2 * sizeof(frame)) {
+		cout << "The ticks are not all counted." << endl;
+		failed = true;
+	}
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,116 @@
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../includes/raw12_packing.h"
+#include "../../includes/timers.h"
+
+using namespace std;
+using namespace timers_utils;
+
+//check every supported kernel against the scalar one for several sizes
+//including odd ones and sizes around the vector widths.
+bool check_kernels() {
+
+	const uint_fast64_t max_pixels = 1000;
+	uint16_t* src = (uint16_t*) malloc(max_pixels * sizeof(uint16_t));
+	uint16_t* dst = (uint16_t*) malloc(max_pixels * sizeof(uint16_t));
+	uint8_t* ref = (uint8_t*) malloc(RAW12_PACKED_SIZE(max_pixels));
+	uint8_t* packed = (uint8_t*) malloc(RAW12_PACKED_SIZE(max_pixels));
+
+	for(uint_fast64_t i=0; i<max_pixels; i++) {
+		src[i] = uint16_t(rand());
+	}
+
+	raw12::RAW12_KERNEL kernels[] = {raw12::RAW12_KERNEL_SCALAR, raw12::RAW12_KERNEL_SSSE3,
+		raw12::RAW12_KERNEL_AVX2, raw12::RAW12_KERNEL_NEON};
+
+	bool all_good = true;
+	for(uint_fast64_t num_pixels=0; num_pixels<=max_pixels; num_pixels += (num_pixels < 70 ? 1 : 97)) {
+		raw12::set_kernel(raw12::RAW12_KERNEL_SCALAR);
+		raw12::pack(src, ref, num_pixels);
+		for(int k=0; k<4; k++) {
+			if(!raw12::set_kernel(kernels[k])) {
+				continue;
+			}
+			memset(packed, 0xAA, RAW12_PACKED_SIZE(max_pixels));
+			memset(dst, 0xAA, max_pixels * sizeof(uint16_t));
+			raw12::pack(src, packed, num_pixels);
+			raw12::unpack(packed, dst, num_pixels);
+			bool good = memcmp(ref, packed, RAW12_PACKED_SIZE(num_pixels)) == 0;
+			for(uint_fast64_t i=0; i<num_pixels; i++) {
+				good = good && (dst[i] == (src[i] & 0xfff));
+			}
+			if(!good) {
+				cout << "Mismatch in " << raw12::get_kernel_name(kernels[k]) << " kernel with " << num_pixels << " pixels." << endl;
+				all_good = false;
+			}
+		}
+	}
+
+	free(src);
+	free(dst);
+	free(ref);
+	free(packed);
+	return all_good;
+}
+
+int main(int argc, char** argv) {
+
+	if(argc != 1 && argc != 3) {
+		printf("Raw12 packing test\n");
+		printf("\n");
+		printf("Usage:\n");
+		printf("%s [frame_width frame_height]\n", argv[0]);
+		exit(0);
+	}
+
+	uint_fast64_t width = 4096, height = 3072;
+	if(argc == 3) {
+		width = atoi(argv[1]);
+		height = atoi(argv[2]);
+	}
+
+	if(!check_kernels()) {
+		cout << "Failed the kernels check." << endl;
+		return 1;
+	}
+	cout << "All kernels match the scalar kernel." << endl;
+
+	//time each kernel on a full frame
+	uint_fast64_t num_pixels = width * height;
+	uint16_t* frame = (uint16_t*) malloc(num_pixels * sizeof(uint16_t));
+	uint8_t* packed = (uint8_t*) malloc(RAW12_PACKED_SIZE(num_pixels));
+	for(uint_fast64_t i=0; i<num_pixels; i++) {
+		frame[i] = uint16_t(i & 0xfff);
+	}
+
+	printf("Frame : %lux%lu, %lu bytes -> %lu bytes\n", width, height, num_pixels * 2, RAW12_PACKED_SIZE(num_pixels));
+
+	raw12::RAW12_KERNEL kernels[] = {raw12::RAW12_KERNEL_SCALAR, raw12::RAW12_KERNEL_SSSE3,
+		raw12::RAW12_KERNEL_AVX2, raw12::RAW12_KERNEL_NEON};
+	const int iterations = 50;
+	for(int k=0; k<4; k++) {
+		if(!raw12::set_kernel(kernels[k])) {
+			continue;
+		}
+		timespec start_time, mid_time, end_time;
+		clock_gettime(CLOCK_MONOTONIC, &start_time);
+		for(int i=0; i<iterations; i++) {
+			raw12::pack(frame, packed, num_pixels);
+		}
+		clock_gettime(CLOCK_MONOTONIC, &mid_time);
+		for(int i=0; i<iterations; i++) {
+			raw12::unpack(packed, frame, num_pixels);
+		}
+		clock_gettime(CLOCK_MONOTONIC, &end_time);
+		printf("%-8s pack : %6lu us/frame, unpack : %6lu us/frame\n", raw12::get_kernel_name(kernels[k]),
+			NS_TO_US(TIMESPEC_DIFF_NS(start_time, mid_time)) / iterations,
+			NS_TO_US(TIMESPEC_DIFF_NS(mid_time, end_time)) / iterations);
+	}
+
+	free(frame);
+	free(packed);
+	return 0;
+}
@@ -10,25 +10,6 @@
 
 using namespace std;
 
-void* data_to_be_sent;
-int message_size;
-
-DataPacketsList my_fn(RealTimeInfo* inf) {
-
-	if(inf->is_skipped_data()) {
-		cout << "Skipped Frame Detected." << endl;
-	}
-
-	DataPacket packet_1;
-	packet_1.data_ptr = data_to_be_sent;
-	packet_1.data_size = message_size;
-
-	DataPacketsList list(1);
-	(list.packets)[0] = packet_1;
-
-	return list;
-}
-
 int main(int argc, char** argv) {
 
 	if(argc != 3) {
@@ -41,14 +22,32 @@ int main(int argc, char** argv) {
 
 	int port_number = atoi(argv[1]);
 	int frequency = 30;
-	message_size = atoi(argv[2]);
+	int message_size = atoi(argv[2]);
 	cout << message_size << endl;
-	data_to_be_sent = malloc(message_size);
+	void* data_to_be_sent = malloc(message_size);
+
+	//the user function keeps its data, the timer, sender and function are
+	//called directly by the system.
+	auto my_fn = [data_to_be_sent, message_size](RealTimeInfo* inf) {
+
+		if(inf->is_skipped_data()) {
+			cout << "Skipped Frame Detected." << endl;
+		}
+
+		DataPacket packet_1;
+		packet_1.data_ptr = data_to_be_sent;
+		packet_1.data_size = message_size;
+
+		DataPacketsList list(1);
+		(list.packets)[0] = packet_1;
+
+		return list;
+	};
 
 	TCPSender sender(port_number);
 	FreeWaitTimer timer;
 
-	RealTimeSystem system;
+	RealTimeSystemT<FreeWaitTimer, TCPSender, decltype(my_fn)> system(my_fn);
 
 	if(!system.set_timer(&timer)) {
 		cout << "Failed to set the timer object." << endl;
@@ -62,12 +61,6 @@ int main(int argc, char** argv) {
 		return 2;
 	}
 
-	if(!system.set_user_data_fn(&my_fn)) {
-		cout << "Failed to set the user function." << endl;
-		cout << system.get_error() << endl;
-		return 3;
-	}
-
 	if(!system.set_frequency(frequency)) {
 		cout << "Failed to set the frequency." << endl;
 		cout << system.get_error() << endl;
@@ -0,0 +1,167 @@
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "../../includes/senders.h"
+#include "../../includes/systems.h"
+#include "../../includes/timers.h"
+
+using namespace std;
+using namespace timers_utils;
+
+/**
+ * A client reads the stream then leaves, a second one connects and must get
+ * the next frames without restarting the system, then a third one connects
+ * while the second is still there and must replace it at the next frame.
+ */
+
+static uint_fast16_t port = 7579;
+
+//results of the clients
+static uint_fast64_t second_wait_ns = 0, third_wait_ns = 0;
+static bool second_closed = false, third_received = false;
+
+static int connect_client() {
+	int sock_fd = socket(AF_INET, SOCK_STREAM, 0);
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_port = htons(port);
+	inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+	//the sender may not listen yet
+	while(connect(sock_fd, (sockaddr*) &address, sizeof(address)) != 0) {
+		milliseconds_sleep(10);
+	}
+	return sock_fd;
+}
+
+//read for the given time, return the bytes read or -1 if the sender closed
+static int_fast64_t read_for(int sock_fd, uint_fast32_t ms) {
+	char buffer[64*1024];
+	int_fast64_t received = 0;
+	uint_fast64_t end = monotonic_ns() + MS_TO_NS(ms);
+	while(monotonic_ns() < end) {
+		pollfd pfd = {sock_fd, POLLIN, 0};
+		if(poll(&pfd, 1, 10) != 1) {
+			continue;
+		}
+		ssize_t r = recv(sock_fd, buffer, sizeof(buffer), 0);
+		if(r <= 0) {
+			return -1;
+		}
+		received += r;
+	}
+	return received;
+}
+
+//time until the first byte arrives
+static uint_fast64_t wait_first_byte(int sock_fd) {
+	uint_fast64_t start = monotonic_ns();
+	char byte;
+	recv(sock_fd, &byte, 1, 0);
+	return monotonic_ns() - start;
+}
+
+static void* clients_function(void*) {
+	//the first client leaves
+	int first = connect_client();
+	read_for(first, 500);
+	close(first);
+	milliseconds_sleep(200);
+	//the second client takes over the stream
+	int second = connect_client();
+	second_wait_ns = wait_first_byte(second);
+	read_for(second, 500);
+	//the third client replaces the second one
+	int third = connect_client();
+	third_wait_ns = wait_first_byte(third);
+	second_closed = read_for(second, 200) == -1;
+	close(second);
+	third_received = read_for(third, 200) > 0;
+	//read until the system stops
+	while(read_for(third, 100) != -1);
+	close(third);
+	return NULL;
+}
+
+int main(int argc, char** argv) {
+
+	if(argc != 1 && argc != 2) {
+		printf("Reconnect test\n");
+		printf("\n");
+		printf("Usage:\n");
+		printf("%s [zerocopy|nozerocopy]\n", argv[0]);
+		exit(0);
+	}
+	bool zerocopy = argc == 2 && strcmp(argv[1], "zerocopy") == 0;
+
+	const uint_fast16_t frequency = 50;
+	const uint_fast32_t frame_size = 64*1024;
+	char* frame = (char*) malloc(frame_size);
+	memset(frame, 7, frame_size);
+	auto user_fn = [&](RealTimeInfo* info) {
+		if(info->get_sequence_number() == frequency * 3) {
+			info->stop_system();
+		}
+		DataPacketsList list(1);
+		list.packets[0].data_ptr = frame;
+		list.packets[0].data_size = frame_size;
+		return list;
+	};
+
+	pthread_t clients_thread;
+	pthread_create(&clients_thread, NULL, clients_function, NULL);
+
+	Sender* sender;
+	if(zerocopy) {
+		TCPSenderZC* zc_sender = new TCPSenderZC(port);
+		zc_sender->set_reconnect(true);
+		sender = zc_sender;
+	} else {
+		TCPSender* tcp_sender = new TCPSender(port);
+		tcp_sender->set_reconnect(true);
+		sender = tcp_sender;
+	}
+	FreeWaitTimer timer;
+	RealTimeSystem system;
+	system.set_user_data_fn(user_fn);
+	system.set_timer(&timer);
+	system.set_sender(sender);
+	system.set_frequency(frequency);
+	system.skip_mode(true);
+	bool done = system.initialize() && system.run();
+	if(!done) {
+		cout << "Failed to run the system." << endl;
+		cout << system.get_error() << endl;
+	}
+	pthread_join(clients_thread, NULL);
+	delete sender;
+	free(frame);
+
+	cout << "Second client waited " << NS_TO_MS(second_wait_ns) << " ms for the stream." << endl;
+	cout << "Third client waited " << NS_TO_MS(third_wait_ns) << " ms for the stream." << endl;
+
+	bool failed = !done;
+	//the lost client is detected on the next send and the new one is polled
+	//each 100ms, then it gets the next frame
+	if(second_wait_ns > MS_TO_NS(300)) {
+		cout << "The second client waited too long." << endl;
+		failed = true;
+	}
+	//the replacement is taken at the next frame
+	if(third_wait_ns > MS_TO_NS(100) || !third_received) {
+		cout << "The third client didn't get the stream." << endl;
+		failed = true;
+	}
+	if(!second_closed) {
+		cout << "The replaced client wasn't closed." << endl;
+		failed = true;
+	}
+	return failed ? 1 : 0;
+}
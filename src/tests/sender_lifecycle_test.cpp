@@ -0,0 +1,103 @@
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "../../includes/senders.h"
+#include "../../includes/timers.h"
+
+using namespace std;
+using namespace timers_utils;
+
+/**
+ * The senders are started and ended many times, with the accept in the
+ * background initialize(0) must not wait for a client and end_sender(0) must
+ * not wait more than the worker needs to wake up, with and without a client.
+ */
+
+static int connect_client(uint_fast16_t port) {
+	int sock_fd = socket(AF_INET, SOCK_STREAM, 0);
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_port = htons(port);
+	inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+	if(connect(sock_fd, (sockaddr*) &address, sizeof(address)) != 0) {
+		close(sock_fd);
+		return -1;
+	}
+	return sock_fd;
+}
+
+//start and end the sender cycles times, connect a client in each cycle if
+//with_client, return the mean time of a cycle or 0 on failure
+template <class SenderClass>
+static uint_fast64_t cycle(uint_fast16_t port, uint_fast32_t cycles, bool with_client) {
+	SenderClass sender(port);
+	sender.set_async_accept(true);
+	char message[] = "frame";
+	uint_fast64_t start = monotonic_ns();
+	for(uint_fast32_t c=0; c<cycles; c++) {
+		if(!sender.initialize()) {
+			cout << sender.get_error() << endl;
+			return 0;
+		}
+		int client_fd = -1;
+		if(with_client) {
+			client_fd = connect_client(port);
+			//the worker takes the client, then the sender is ready
+			while(sender.is_reconnecting());
+			DataPacketsList list(1);
+			list.packets[0].data_ptr = message;
+			list.packets[0].data_size = sizeof(message);
+			if(client_fd == -1 || !sender.send(&list)) {
+				cout << "Failed to send to the client." << endl;
+				return 0;
+			}
+			while(!sender.is_send_done());
+		}
+		sender.end_sender();
+		if(client_fd != -1) {
+			close(client_fd);
+		}
+	}
+	return (monotonic_ns() - start) / cycles;
+}
+
+int main(int argc, char** argv) {
+
+	if(argc != 1) {
+		printf("Sender lifecycle test\n");
+		printf("\n");
+		printf("Usage:\n");
+		printf("%s\n", argv[0]);
+		exit(0);
+	}
+
+	uint_fast64_t results[4] = {
+		cycle<TCPSender>(7580, 1000, false),
+		cycle<TCPSender>(7580, 200, true),
+		cycle<TCPSenderZC>(7580, 1000, false),
+		cycle<TCPSenderZC>(7580, 200, true),
+	};
+	const char* names[4] = {
+		"TCPSender", "TCPSender with a client", "TCPSenderZC", "TCPSenderZC with a client"
+	};
+
+	bool failed = false;
+	for(int i=0; i<4; i++) {
+		printf("%-26s %8lu us per start and end\n", names[i], (unsigned long) NS_TO_US(results[i]));
+		//a blocking wait (the old 5ms and 50ms sleeps, the 1s socket
+		//timeout) would show up as milliseconds
+		if(results[i] == 0 || results[i] > MS_TO_NS(2)) {
+			failed = true;
+		}
+	}
+	if(failed) {
+		cout << "A start or an end of the sender waited." << endl;
+	}
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,215 @@
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <string>
+#include <vector>
+
+#include "../../includes/senders.h"
+#include "../../includes/timers.h"
+
+using namespace std;
+using namespace timers_utils;
+
+/**
+ * A consumer process opens the ring of the sender and checks every frame it
+ * reads (the packet sizes and the bytes, one packet from a file descriptor),
+ * the frames it reads and the ones it lost must be all the published frames.
+ * then a consumer of this process which read nothing must find the last
+ * frames of the ring and count the older ones as lost.
+ */
+
+static const uint_fast32_t frames = 300;
+static const uint_fast32_t memory_packet_size = 1024*1024;
+static const uint_fast32_t file_packet_size = 4096;
+
+//the results of the consumer process
+struct ConsumerResults{
+	uint64_t frames;
+	uint64_t lost_frames;
+	uint64_t bad_frames;
+	uint64_t bytes;
+	uint64_t ns;
+};
+
+static char pattern(uint64_t n, uint_fast32_t i) {
+	return (char) (n * 31 + i * 7 + i / 4093);
+}
+
+//check the frame as published for the sequence (from 1)
+static bool check_frame(const ShmFrame& frame) {
+	if(frame.num_packets != 2 || frame.packet_sizes[0] != memory_packet_size ||
+	   frame.packet_sizes[1] != file_packet_size || frame.size != memory_packet_size + file_packet_size) {
+		return false;
+	}
+	for(uint_fast32_t i=0; i<memory_packet_size; i += 61) {
+		if(frame.data[i] != pattern(frame.sequence, i)) {
+			return false;
+		}
+	}
+	for(uint_fast32_t i=0; i<file_packet_size; i++) {
+		if(frame.data[memory_packet_size + i] != pattern(0, i)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+//read the ring until the sender ends
+static int consumer_process(int path_fd, int results_fd) {
+	char path[256] = {};
+	if(read(path_fd, path, sizeof(path) - 1) <= 0) {
+		return 1;
+	}
+	ShmConsumer consumer;
+	if(!consumer.open(path)) {
+		cout << consumer.get_error() << endl;
+		return 1;
+	}
+	ConsumerResults results = {};
+	ShmFrame frame;
+	uint64_t start = 0;
+	while(!consumer.is_closed()) {
+		if(!consumer.wait_frame(&frame, 100)) {
+			continue;
+		}
+		if(start == 0) {
+			start = monotonic_ns();
+		}
+		bool good = check_frame(frame);
+		if(consumer.done_frame(frame)) {
+			results.frames++;
+			results.bytes += frame.size;
+			results.bad_frames += !good;
+		}
+	}
+	results.ns = monotonic_ns() - start;
+	results.lost_frames = consumer.get_lost_frames();
+	return write(results_fd, &results, sizeof(results)) == sizeof(results) ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+
+	if(argc != 1) {
+		printf("Shared memory sender test\n");
+		printf("\n");
+		printf("Usage:\n");
+		printf("%s\n", argv[0]);
+		exit(0);
+	}
+
+	//the consumer is forked before the sender has threads
+	int path_pipe[2], results_pipe[2];
+	if(pipe(path_pipe) != 0 || pipe(results_pipe) != 0) {
+		cout << "Can't create the pipes." << endl;
+		return 1;
+	}
+	pid_t consumer_pid = fork();
+	if(consumer_pid == 0) {
+		exit(consumer_process(path_pipe[0], results_pipe[1]));
+	}
+
+	char* memory = (char*) malloc(memory_packet_size);
+	char file_path[] = "/tmp/shm_sender_test_XXXXXX";
+	int file_fd = mkstemp(file_path);
+	unlink(file_path);
+	vector<char> file_data(file_packet_size);
+	for(uint_fast32_t i=0; i<file_packet_size; i++) {
+		file_data[i] = pattern(0, i);
+	}
+	if(file_fd < 0 || write(file_fd, &file_data[0], file_packet_size) != (ssize_t) file_packet_size) {
+		cout << "Can't create the payload file." << endl;
+		return 1;
+	}
+
+	bool failed = false;
+	ShmSender sender(memory_packet_size + file_packet_size);
+	if(!sender.initialize()) {
+		cout << sender.get_error() << endl;
+		return 1;
+	}
+	string path = sender.get_consumer_path();
+	if(write(path_pipe[1], path.c_str(), path.size()) != (ssize_t) path.size()) {
+		failed = true;
+	}
+	while(sender.get_consumers() == 0) {
+		milliseconds_sleep(1);
+	}
+	//attached and never reading until the end
+	ShmConsumer idle_consumer;
+	if(!idle_consumer.open(path)) {
+		cout << idle_consumer.get_error() << endl;
+		failed = true;
+	}
+
+	for(uint64_t n=1; n<=frames && !failed; n++) {
+		for(uint_fast32_t i=0; i<memory_packet_size; i++) {
+			memory[i] = pattern(n, i);
+		}
+		DataPacketsList list(2);
+		list.packets[0].data_ptr = memory;
+		list.packets[0].data_size = memory_packet_size;
+		list.packets[1].data_ptr_type = DataPacket::DATA_PTR_FILE_DESCRIPTOR;
+		list.packets[1].data_ptr = &file_fd;
+		list.packets[1].data_size = file_packet_size;
+		if(!sender.send(&list)) {
+			cout << sender.get_error() << endl;
+			failed = true;
+		}
+		while(!sender.is_send_done()) {
+			microseconds_sleep(20);
+		}
+	}
+	SenderLinkState state;
+	if(!sender.get_link_state(&state) || state.queued_bytes != SHM_SENDER_SLOTS * (memory_packet_size + file_packet_size)) {
+		cout << "The frames not read by the idle consumer are not queued." << endl;
+		failed = true;
+	}
+	//a frame larger than the slots is refused
+	DataPacketsList large(1);
+	large.packets[0].data_ptr = memory;
+	large.packets[0].data_size = memory_packet_size + file_packet_size + 1;
+	if(sender.send(&large)) {
+		cout << "A frame larger than the slots was accepted." << endl;
+		failed = true;
+	}
+	sender.get_error();
+
+	//the idle consumer gets the frames kept by the ring
+	uint64_t idle_frames = 0;
+	ShmFrame frame;
+	while(idle_consumer.wait_frame(&frame, 0)) {
+		if(!check_frame(frame) || !idle_consumer.done_frame(frame)) {
+			failed = true;
+		}
+		idle_frames++;
+	}
+	printf("idle consumer: %lu frames, %lu lost\n", (unsigned long) idle_frames, (unsigned long) idle_consumer.get_lost_frames());
+	if(idle_frames != SHM_SENDER_SLOTS || idle_consumer.get_lost_frames() != frames - SHM_SENDER_SLOTS) {
+		cout << "The idle consumer didn't get the last frames of the ring." << endl;
+		failed = true;
+	}
+	idle_consumer.close();
+	sender.end_sender();
+
+	ConsumerResults results = {};
+	int status = 1;
+	if(read(results_pipe[0], &results, sizeof(results)) != sizeof(results)) {
+		failed = true;
+	}
+	waitpid(consumer_pid, &status, 0);
+	printf("consumer process: %lu frames, %lu lost, %lu bad, %.0f MB/s\n", (unsigned long) results.frames,
+		(unsigned long) results.lost_frames, (unsigned long) results.bad_frames,
+		results.ns ? double(results.bytes) * 1000 / results.ns : 0.0);
+	if(status != 0 || results.frames + results.lost_frames != frames || results.bad_frames != 0) {
+		cout << "The consumer process didn't get the published frames." << endl;
+		failed = true;
+	}
+
+	close(file_fd);
+	free(memory);
+	return failed ? 1 : 0;
+}
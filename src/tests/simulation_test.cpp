@@ -0,0 +1,129 @@
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../includes/senders.h"
+#include "../../includes/systems.h"
+#include "../../includes/timers.h"
+
+using namespace std;
+using namespace timers_utils;
+
+/**
+ * A system runs for hours of a simulated clock with a mock sender in a few
+ * seconds: one frame of each hundred takes 1.5 periods to be sent, without
+ * tolerance each one costs a skipped frame, with 20ms of tolerance none is
+ * skipped, then the client stops reading after 10 minutes and the system
+ * must report it disconnected after 3 seconds of skipped frames.
+ */
+
+static const uint_fast16_t frequency = 30;
+
+struct SimulationResult{
+	bool completed;
+	std::string error;
+	uint_fast32_t sent_frames;
+	uint_fast32_t skipped_frames;
+	//simulated time from the first tick to the end
+	uint_fast64_t simulated_ns;
+};
+
+static uint_fast64_t period_ns() {
+	return SEC_TO_NS(1) / frequency;
+}
+
+//run the system for the given ticks on a simulated clock
+static SimulationResult simulate(uint_fast32_t ticks, uint_fast16_t ms_tolerance, MockSender::CompletionFn completion_fn) {
+	SimulatedClock clock;
+	set_clock(&clock);
+
+	char frame[1024];
+	SimulationResult result = {false, "", 0, 0, 0};
+	auto user_fn = [&](RealTimeInfo* info) {
+		if(info->get_sequence_number() + 1 >= ticks) {
+			info->stop_system();
+		}
+		if(info->is_skipped_data()) {
+			result.skipped_frames++;
+		} else {
+			result.sent_frames++;
+		}
+		DataPacketsList list(1);
+		list.packets[0].data_ptr = frame;
+		list.packets[0].data_size = sizeof(frame);
+		return list;
+	};
+
+	MockSender sender;
+	sender.set_completion_fn(completion_fn);
+	FreeWaitTimer timer;
+	RealTimeSystem system;
+	system.set_user_data_fn(user_fn);
+	system.set_timer(&timer);
+	system.set_sender(&sender);
+	system.set_frequency(frequency);
+	system.skip_mode(true);
+	system.set_ms_tolerance(ms_tolerance);
+	uint_fast64_t start = clock.now();
+	result.completed = system.initialize() && system.run();
+	result.simulated_ns = clock.now() - start;
+	if(!result.completed) {
+		result.error = system.get_error();
+	}
+
+	set_clock(NULL);
+	return result;
+}
+
+int main(int argc, char** argv) {
+
+	if(argc != 1) {
+		printf("Simulation test\n");
+		printf("\n");
+		printf("Usage:\n");
+		printf("%s\n", argv[0]);
+		exit(0);
+	}
+
+	timespec start_time, end_time;
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+	bool failed = false;
+
+	//one hour, one slow frame of each hundred
+	const uint_fast32_t hour_ticks = 3600 * frequency;
+	auto slow_frames = [](uint_fast32_t frame_number, uint_fast64_t) {
+		return frame_number % 100 == 99 ? period_ns() * 3 / 2 : period_ns() / 2;
+	};
+	SimulationResult strict = simulate(hour_ticks, 0, slow_frames);
+	cout << "No tolerance: " << strict.sent_frames << " sent, " << strict.skipped_frames << " skipped." << endl;
+	//the slow frames are the sent ones numbered 99, 199...
+	if(!strict.completed || strict.skipped_frames != strict.sent_frames / 100 ||
+	   strict.sent_frames + strict.skipped_frames != hour_ticks) {
+		cout << "Each slow frame must skip one frame. " << strict.error << endl;
+		failed = true;
+	}
+
+	SimulationResult tolerant = simulate(hour_ticks, 20, slow_frames);
+	cout << "20ms tolerance: " << tolerant.sent_frames << " sent, " << tolerant.skipped_frames << " skipped." << endl;
+	if(!tolerant.completed || tolerant.skipped_frames != 0) {
+		cout << "The tolerance must absorb the slow frames. " << tolerant.error << endl;
+		failed = true;
+	}
+
+	//the client stops reading after 10 minutes
+	const uint_fast32_t cut_frame = 600 * frequency;
+	SimulationResult cut = simulate(hour_ticks, 0, [&](uint_fast32_t frame_number, uint_fast64_t) {
+		return frame_number >= cut_frame ? MOCK_SENDER_NEVER : period_ns() / 2;
+	});
+	uint_fast64_t detection_ns = cut.simulated_ns - cut_frame * period_ns();
+	cout << "Cut client: \"" << cut.error << "\" " << NS_TO_MS(detection_ns) << " ms after the cut." << endl;
+	if(cut.completed || cut.error != "The client disconnected." ||
+	   detection_ns < SEC_TO_NS(3) || detection_ns > SEC_TO_NS(3) + 2 * period_ns()) {
+		cout << "The client must be reported disconnected after 3 seconds." << endl;
+		failed = true;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &end_time);
+	cout << "Simulated in " << NS_TO_MS(TIMESPEC_DIFF_NS(start_time, end_time)) << " ms." << endl;
+	return failed ? 1 : 0;
+}
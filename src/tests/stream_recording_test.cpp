@@ -0,0 +1,200 @@
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "../../includes/senders.h"
+#include "../../includes/systems.h"
+#include "../../includes/timers.h"
+#include "../../includes/stream_recording.h"
+
+using namespace std;
+using namespace timers_utils;
+
+/**
+ * A user function of frames of a variable size and number of packets, one of
+ * them from a file descriptor, is recorded with and without the payloads on a
+ * simulated clock, then each recording is replayed through a system, the
+ * replayed frames must match the recorded ones (the sizes, and the bytes
+ * when kept), at the recorded frequency, and the system must stop after the
+ * last frame.
+ */
+
+static const uint_fast16_t frequency = 50;
+static const uint_fast32_t frames = 120;
+
+static char* memory_;
+static int file_fd_;
+
+//frame n of the user function
+static DataPacketsList make_frame(uint_fast32_t n) {
+	DataPacketsList list(1 + n % 4);
+	for(uint_fast32_t i=0; i<list.num_packets; i++) {
+		list.packets[i].data_ptr = memory_ + n * 97;
+		list.packets[i].data_offset = i * 13;
+		list.packets[i].data_size = 100 + (n * 7919 + i * 104729) % 4000;
+	}
+	if(n % 3 == 0) {
+		list.packets[0].data_ptr_type = DataPacket::DATA_PTR_FILE_DESCRIPTOR;
+		list.packets[0].data_ptr = &file_fd_;
+		list.packets[0].data_offset = n * 31;
+	}
+	return list;
+}
+
+//the bytes of the frame n as a receiver gets them
+static vector<char> frame_bytes(const DataPacketsList& list) {
+	vector<char> bytes;
+	for(uint_fast32_t i=0; i<list.num_packets; i++) {
+		const DataPacket& packet = list.packets[i];
+		size_t at = bytes.size();
+		bytes.resize(at + packet.data_size);
+		if(packet.data_ptr_type == DataPacket::DATA_PTR_FILE_DESCRIPTOR) {
+			if(pread(*((int*) packet.data_ptr), &bytes[at], packet.data_size, packet.data_offset) != (ssize_t) packet.data_size) {
+				bytes.clear();
+				return bytes;
+			}
+		} else {
+			memcpy(&bytes[at], (char*) packet.data_ptr + packet.data_offset, packet.data_size);
+		}
+	}
+	return bytes;
+}
+
+template <class UserFn>
+static bool run_system(UserFn user_fn, uint_fast16_t system_frequency, uint_fast64_t* simulated_ns) {
+	SimulatedClock clock;
+	set_clock(&clock);
+	MockSender sender;
+	FreeWaitTimer timer;
+	RealTimeSystem system;
+	system.set_user_data_fn(user_fn);
+	system.set_timer(&timer);
+	system.set_sender(&sender);
+	system.set_frequency(system_frequency);
+	system.skip_mode(true);
+	uint_fast64_t start = clock.now();
+	bool done = system.initialize() && system.run();
+	*simulated_ns = clock.now() - start;
+	set_clock(NULL);
+	if(!done) {
+		cout << system.get_error() << endl;
+	}
+	return done;
+}
+
+static bool record(const char* path, bool payloads) {
+	StreamRecorder recorder;
+	if(!recorder.open(path, frequency, payloads)) {
+		cout << recorder.get_error() << endl;
+		return false;
+	}
+	auto user_fn = [&](RealTimeInfo* info) {
+		if(info->get_sequence_number() + 1 >= frames) {
+			info->stop_system();
+		}
+		DataPacketsList list = make_frame(info->get_sequence_number());
+		recorder.record(info, list);
+		return list;
+	};
+	uint_fast64_t simulated_ns;
+	bool done = run_system(user_fn, frequency, &simulated_ns);
+	if(recorder.is_error() || !recorder.close()) {
+		cout << recorder.get_error() << endl;
+		return false;
+	}
+	return done && recorder.get_frames() == frames;
+}
+
+static bool replay(const char* path, bool payloads) {
+	StreamReplayer replayer;
+	if(!replayer.load(path)) {
+		cout << replayer.get_error() << endl;
+		return false;
+	}
+	if(replayer.get_frequency() != frequency || replayer.get_frames() != frames) {
+		cout << "The recording holds " << replayer.get_frames() << " frames at " << replayer.get_frequency() << "Hz" << endl;
+		return false;
+	}
+	uint_fast32_t calls = 0, mismatches = 0;
+	auto user_fn = [&](RealTimeInfo* info) {
+		calls++;
+		DataPacketsList list = replayer.next_frame(info);
+		DataPacketsList expected = make_frame(info->get_sequence_number());
+		bool same = list.num_packets == expected.num_packets;
+		for(uint_fast32_t i=0; same && i<list.num_packets; i++) {
+			same = list.packets[i].data_size == expected.packets[i].data_size;
+		}
+		if(same && payloads) {
+			same = frame_bytes(list) == frame_bytes(expected);
+		}
+		if(!same) {
+			mismatches++;
+		}
+		return list;
+	};
+	uint_fast64_t simulated_ns;
+	bool done = run_system(user_fn, replayer.get_frequency(), &simulated_ns);
+	//the last frame is sent at the tick frames - 1
+	uint_fast64_t expected_ns = (frames - 1) * (SEC_TO_NS(1) / frequency);
+	printf("%-12s %3lu frames %3lu mismatches %6.3fs simulated\n", payloads ? "payloads" : "sizes only",
+		(unsigned long) calls, (unsigned long) mismatches, double(simulated_ns) / SEC_TO_NS(1));
+	return done && calls == frames && mismatches == 0 &&
+		simulated_ns >= expected_ns && simulated_ns < expected_ns + 2 * (SEC_TO_NS(1) / frequency);
+}
+
+int main(int argc, char** argv) {
+
+	if(argc != 1) {
+		printf("Stream recording test\n");
+		printf("\n");
+		printf("Usage:\n");
+		printf("%s\n", argv[0]);
+		exit(0);
+	}
+
+	memory_ = (char*) malloc(64*1024);
+	for(int i=0; i<64*1024; i++) {
+		memory_[i] = (char) (i * 7 + i / 251);
+	}
+	char file_path[] = "/tmp/stream_recording_test_XXXXXX";
+	file_fd_ = mkstemp(file_path);
+	unlink(file_path);
+	if(file_fd_ < 0 || write(file_fd_, memory_ + 1000, 32*1024) != 32*1024) {
+		cout << "Can't create the payload file." << endl;
+		return 1;
+	}
+
+	bool failed = false;
+	const char* path = "stream_recording_test.rec";
+	for(bool payloads : {true, false}) {
+		if(!record(path, payloads) || !replay(path, payloads)) {
+			cout << "The replay doesn't match the recording " << (payloads ? "with" : "without") << " the payloads." << endl;
+			failed = true;
+		}
+	}
+	unlink(path);
+
+	//a truncated recording is refused
+	StreamRecorder recorder;
+	recorder.open(path, frequency, true);
+	RealTimeInfo info(0, false, 0, false);
+	recorder.record(&info, make_frame(1));
+	recorder.close();
+	if(truncate(path, 20) != 0) {
+		failed = true;
+	}
+	StreamReplayer replayer;
+	if(replayer.load(path)) {
+		cout << "A truncated recording was loaded." << endl;
+		failed = true;
+	}
+	unlink(path);
+
+	close(file_fd_);
+	free(memory_);
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,100 @@
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../includes/senders.h"
+#include "../../includes/systems.h"
+#include "../../includes/timers.h"
+
+using namespace std;
+
+//video, audio and telemetry like streams
+const int num_streams = 3;
+const int frequencies[num_streams] = {30, 50, 100};
+const int message_sizes[num_streams] = {300000, 4000, 200};
+
+void* data_to_be_sent;
+StreamScheduler scheduler;
+
+void print_stats() {
+	for(int i=0; i<num_streams; i++) {
+		StreamStats stats;
+		scheduler.get_stream_stats(i, &stats);
+		printf("Stream %d : ticks %lu sent %lu skipped %lu missed %lu max wake delay %lu us\n", i,
+			stats.ticks, stats.sent, stats.skipped, stats.missed, stats.max_wake_delay_ns / 1000);
+	}
+}
+
+template <int STREAM>
+DataPacketsList my_fn(RealTimeInfo* inf) {
+
+	//report once per second from the first stream
+	if(STREAM == 0 && inf->get_sequence_number() % frequencies[0] == 0) {
+		print_stats();
+	}
+
+	DataPacket packet_1;
+	packet_1.data_ptr = data_to_be_sent;
+	packet_1.data_size = message_sizes[STREAM];
+
+	DataPacketsList list(1);
+	(list.packets)[0] = packet_1;
+
+	return list;
+}
+
+int main(int argc, char** argv) {
+
+	if(argc != 3) {
+		printf("Stream scheduler test\n");
+		printf("\n");
+		printf("Usage:\n");
+		printf("%s first_port_number number_of_threads\n", argv[0]);
+		printf("Stream i listens on first_port_number + i, %d streams.\n", num_streams);
+		exit(0);
+	}
+
+	int port_number = atoi(argv[1]);
+	int num_threads = atoi(argv[2]);
+	data_to_be_sent = malloc(message_sizes[0]);
+
+	DataPacketsList (*functions[num_streams])(RealTimeInfo*) = {&my_fn<0>, &my_fn<1>, &my_fn<2>};
+	TCPSender* senders[num_streams];
+	RealTimeSystem systems[num_streams];
+
+	for(int i=0; i<num_streams; i++) {
+		senders[i] = new TCPSender(port_number + i);
+		systems[i].set_sender(senders[i]);
+		systems[i].set_user_data_fn(functions[i]);
+		systems[i].set_frequency(frequencies[i]);
+		systems[i].set_ms_tolerance(1000/frequencies[i]);
+		systems[i].skip_mode(true);
+		if(!scheduler.add_stream(&systems[i])) {
+			cout << "Failed to add the stream." << endl;
+			cout << scheduler.get_error() << endl;
+			return 1;
+		}
+	}
+
+	if(!scheduler.set_threads(num_threads)) {
+		cout << "Failed to set the number of threads." << endl;
+		cout << scheduler.get_error() << endl;
+		return 2;
+	}
+
+	if(!scheduler.initialize()) {
+		cout << "Failed to initialize the scheduler." << endl;
+		cout << scheduler.get_error() << endl;
+		return 3;
+	}
+
+	scheduler.run();
+	cout << "Failed to run the scheduler." << endl;
+	cout << scheduler.get_error() << endl;
+	print_stats();
+	for(int i=0; i<num_streams; i++) {
+		delete senders[i];
+	}
+	return 4;
+}
@@ -0,0 +1,186 @@
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include <atomic>
+#include <vector>
+
+#include "../../includes/senders.h"
+#include "../../includes/timers.h"
+
+using namespace std;
+using namespace timers_utils;
+
+/**
+ * Frames of page aligned buffers, each packet from another buffer with an
+ * offset, and a packet from a file descriptor, are spliced to a client which
+ * checks every byte, the release function of each buffer must be called once
+ * by the time the sender ends.
+ * on the loopback the client reads the spliced pages themselves, so each
+ * frame has its own buffer, none is written again while the client may read.
+ */
+
+static uint_fast16_t port = 7583;
+
+static const uint_fast32_t frames = 200;
+static const uint_fast32_t buffers = frames;
+static const uint_fast32_t buffer_size = 256*1024;
+static const uint_fast32_t packet_size = 200*1000;
+static const uint_fast32_t file_packet_size = 10*1000;
+
+static char* buffers_[buffers];
+static atomic<uint_fast32_t> releases_[buffers];
+static atomic<uint_fast32_t> released_(0);
+static int file_fd_;
+
+//the byte i of the packet of frame n
+static char pattern(uint_fast32_t n, uint_fast32_t i) {
+	return (char) (n * 31 + i * 7 + i / 4093);
+}
+
+static void release_buffer(void* ctx) {
+	releases_[(uintptr_t) ctx]++;
+	released_++;
+}
+
+struct ClientData{
+	uint_fast64_t received_bytes;
+	uint_fast64_t mismatches;
+};
+
+//read the frames and compare them with the pattern
+static void* client_function(void* data) {
+	ClientData* client = (ClientData*) data;
+	int sock_fd = socket(AF_INET, SOCK_STREAM, 0);
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_port = htons(port);
+	inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+	//the sender may not listen yet
+	while(connect(sock_fd, (sockaddr*) &address, sizeof(address)) != 0) {
+		milliseconds_sleep(10);
+	}
+	vector<char> frame(packet_size + file_packet_size);
+	for(uint_fast32_t n=0; n<frames; n++) {
+		size_t at = 0;
+		ssize_t r = 1;
+		while(at < frame.size() && (r = recv(sock_fd, &frame[at], frame.size() - at, 0)) > 0) {
+			at += r;
+		}
+		if(r <= 0) {
+			break;
+		}
+		client->received_bytes += at;
+		for(uint_fast32_t i=0; i<packet_size; i++) {
+			if(frame[i] != pattern(n, i)) {
+				client->mismatches++;
+				break;
+			}
+		}
+		for(uint_fast32_t i=0; i<file_packet_size; i++) {
+			if(frame[packet_size + i] != pattern(0, i)) {
+				client->mismatches++;
+				break;
+			}
+		}
+	}
+	close(sock_fd);
+	return NULL;
+}
+
+int main(int argc, char** argv) {
+
+	if(argc != 1) {
+		printf("TCP splice sender test\n");
+		printf("\n");
+		printf("Usage:\n");
+		printf("%s\n", argv[0]);
+		exit(0);
+	}
+
+	for(uint_fast32_t b=0; b<buffers; b++) {
+		buffers_[b] = (char*) aligned_alloc(4096, buffer_size);
+		releases_[b] = 0;
+	}
+	char file_path[] = "/tmp/tcp_sender_splice_test_XXXXXX";
+	file_fd_ = mkstemp(file_path);
+	unlink(file_path);
+	vector<char> file_data(file_packet_size);
+	for(uint_fast32_t i=0; i<file_packet_size; i++) {
+		file_data[i] = pattern(0, i);
+	}
+	if(file_fd_ < 0 || write(file_fd_, &file_data[0], file_packet_size) != (ssize_t) file_packet_size) {
+		cout << "Can't create the payload file." << endl;
+		return 1;
+	}
+
+	TCPSenderSplice sender(port);
+	sender.set_async_accept(true);
+	if(!sender.initialize()) {
+		cout << sender.get_error() << endl;
+		return 1;
+	}
+	ClientData client = {0, 0};
+	pthread_t client_thread;
+	pthread_create(&client_thread, NULL, client_function, (void*) &client);
+	while(sender.is_reconnecting()) {
+		milliseconds_sleep(1);
+	}
+
+	bool failed = false;
+	uint_fast32_t offset = 100;
+	for(uint_fast32_t n=0; n<frames && !failed; n++) {
+		uint_fast32_t b = n;
+		for(uint_fast32_t i=0; i<packet_size; i++) {
+			buffers_[b][offset + i] = pattern(n, i);
+		}
+		DataPacketsList list(2);
+		list.packets[0].data_ptr = buffers_[b];
+		list.packets[0].data_offset = offset;
+		list.packets[0].data_size = packet_size;
+		list.packets[0].release_fn = release_buffer;
+		list.packets[0].release_ctx = (void*) (uintptr_t) b;
+		list.packets[1].data_ptr_type = DataPacket::DATA_PTR_FILE_DESCRIPTOR;
+		list.packets[1].data_ptr = &file_fd_;
+		list.packets[1].data_size = file_packet_size;
+		while(!sender.is_send_done()) {
+			microseconds_sleep(50);
+		}
+		if(!sender.send(&list)) {
+			cout << sender.get_error() << endl;
+			failed = true;
+		}
+	}
+	while(!sender.is_send_done()) {
+		microseconds_sleep(50);
+	}
+	pthread_join(client_thread, NULL);
+	sender.end_sender();
+
+	printf("%lu bytes received, %lu mismatching frames, %lu buffers released\n",
+		(unsigned long) client.received_bytes, (unsigned long) client.mismatches, (unsigned long) released_.load());
+	if(client.received_bytes != uint_fast64_t(frames) * (packet_size + file_packet_size) || client.mismatches != 0) {
+		cout << "The client didn't get the frames sent." << endl;
+		failed = true;
+	}
+	bool released_once = released_ == frames;
+	for(uint_fast32_t b=0; b<buffers; b++) {
+		released_once &= releases_[b] == 1;
+	}
+	if(!released_once) {
+		cout << "The buffers were not all released once." << endl;
+		failed = true;
+	}
+
+	close(file_fd_);
+	for(uint_fast32_t b=0; b<buffers; b++) {
+		free(buffers_[b]);
+	}
+	return failed ? 1 : 0;
+}
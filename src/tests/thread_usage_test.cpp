@@ -0,0 +1,127 @@
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+
+#include "../../includes/senders.h"
+#include "../../includes/systems.h"
+#include "../../includes/timers.h"
+#include "../../includes/thread_usage.h"
+
+using namespace std;
+using namespace timers_utils;
+
+/**
+ * A system streams to a client with the usage accounting of the system and
+ * of the sender worker on, the user function maps and touches new memory at
+ * one tick, that tick must be flagged with page faults, and each tick and
+ * each sent frame must be accounted.
+ */
+
+static uint_fast16_t port = 7582;
+static const uint_fast32_t ticks = 60;
+static const uint_fast32_t faulting_tick = 20;
+
+static void* client_function(void*) {
+	int sock_fd = socket(AF_INET, SOCK_STREAM, 0);
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_port = htons(port);
+	inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+	//the sender may not listen yet
+	while(connect(sock_fd, (sockaddr*) &address, sizeof(address)) != 0) {
+		milliseconds_sleep(10);
+	}
+	char buffer[64*1024];
+	while(recv(sock_fd, buffer, sizeof(buffer), 0) > 0);
+	close(sock_fd);
+	return NULL;
+}
+
+static void print_stats(const char* name, const ThreadUsageStats& stats) {
+	printf("%-8s %4lu intervals %8lu cpu us (max %6lu) %4lu/%-4lu switches (invol.) %6lu/%-3lu faults (major) "
+		"%3lu preempted %3lu faulted, last flagged %ld\n", name,
+		(unsigned long) stats.intervals, (unsigned long) stats.cpu_ns / 1000, (unsigned long) stats.max_interval_cpu_ns / 1000,
+		(unsigned long) stats.voluntary_switches, (unsigned long) stats.involuntary_switches,
+		(unsigned long) stats.minor_faults, (unsigned long) stats.major_faults,
+		(unsigned long) stats.preempted_intervals, (unsigned long) stats.faulted_intervals, (long) stats.last_flagged);
+}
+
+int main(int argc, char** argv) {
+
+	if(argc != 1) {
+		printf("Thread usage test\n");
+		printf("\n");
+		printf("Usage:\n");
+		printf("%s\n", argv[0]);
+		exit(0);
+	}
+
+	char frame[16*1024];
+	uint_fast32_t sent = 0;
+	const size_t faulting_bytes = 4*1024*1024;
+	auto user_fn = [&](RealTimeInfo* info) {
+		if(info->get_sequence_number() + 1 >= ticks) {
+			info->stop_system();
+		}
+		if(info->get_sequence_number() == faulting_tick) {
+			char* memory = (char*) mmap(NULL, faulting_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if(memory != MAP_FAILED) {
+				memset(memory, 1, faulting_bytes);
+				munmap(memory, faulting_bytes);
+			}
+		}
+		if(!info->is_skipped_data() && !info->is_system_stopped()) {
+			sent++;
+		}
+		DataPacketsList list(1);
+		list.packets[0].data_ptr = frame;
+		list.packets[0].data_size = sizeof(frame);
+		return list;
+	};
+
+	pthread_t client_thread;
+	pthread_create(&client_thread, NULL, client_function, NULL);
+	TCPSender sender(port);
+	sender.set_usage_accounting(true);
+	FreeWaitTimer timer;
+	RealTimeSystem system;
+	system.set_user_data_fn(user_fn);
+	system.set_timer(&timer);
+	system.set_sender(&sender);
+	system.set_frequency(100);
+	system.skip_mode(true);
+	system.set_usage_accounting(true);
+	bool done = system.initialize() && system.run();
+	if(!done) {
+		cout << system.get_error() << endl;
+	}
+	pthread_join(client_thread, NULL);
+
+	ThreadUsageStats system_stats, worker_stats;
+	system.get_usage_stats(&system_stats);
+	sender.get_worker_usage_stats(&worker_stats);
+	print_stats("system", system_stats);
+	print_stats("worker", worker_stats);
+
+	bool failed = !done;
+	if(system_stats.intervals != ticks || system_stats.cpu_ns == 0) {
+		cout << "The ticks are not all accounted." << endl;
+		failed = true;
+	}
+	if(system_stats.faulted_intervals == 0 || system_stats.minor_faults + system_stats.major_faults < faulting_bytes / getpagesize()) {
+		cout << "The faulting tick is not flagged." << endl;
+		failed = true;
+	}
+	if(worker_stats.intervals != sent) {
+		cout << "The worker accounted " << worker_stats.intervals << " frames of " << sent << endl;
+		failed = true;
+	}
+	return failed ? 1 : 0;
+}
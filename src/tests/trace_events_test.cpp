@@ -0,0 +1,135 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "../../includes/senders.h"
+#include "../../includes/systems.h"
+#include "../../includes/timers.h"
+#include "../../includes/trace_events.h"
+
+using namespace std;
+using namespace timers_utils;
+
+/**
+ * A system streams to a client with the recording on, then another one skips
+ * the late frames of a mock sender, the Chrome trace dumped after both must
+ * hold the events of the system, of the sender worker and of the skipped
+ * frames.
+ */
+
+static uint_fast16_t port = 7581;
+
+static void* client_function(void*) {
+	int sock_fd = socket(AF_INET, SOCK_STREAM, 0);
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_port = htons(port);
+	inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+	//the sender may not listen yet
+	while(connect(sock_fd, (sockaddr*) &address, sizeof(address)) != 0) {
+		milliseconds_sleep(10);
+	}
+	char buffer[64*1024];
+	while(recv(sock_fd, buffer, sizeof(buffer), 0) > 0);
+	close(sock_fd);
+	return NULL;
+}
+
+static bool run_system(Sender* sender, uint_fast32_t ticks) {
+	char frame[16*1024];
+	auto user_fn = [&](RealTimeInfo* info) {
+		if(info->get_sequence_number() + 1 >= ticks) {
+			info->stop_system();
+		}
+		DataPacketsList list(2);
+		for(int i=0; i<2; i++) {
+			list.packets[i].data_ptr = frame;
+			list.packets[i].data_size = sizeof(frame);
+		}
+		return list;
+	};
+	FreeWaitTimer timer;
+	RealTimeSystem system;
+	system.set_user_data_fn(user_fn);
+	system.set_timer(&timer);
+	system.set_sender(sender);
+	system.set_frequency(50);
+	system.skip_mode(true);
+	bool done = system.initialize() && system.run();
+	if(!done) {
+		cout << system.get_error() << endl;
+	}
+	return done;
+}
+
+static int count(const string& trace, const string& name, char phase) {
+	string event = "\"name\": \"" + name + "\", \"ph\": \"" + phase + "\"";
+	int found = 0;
+	for(size_t at = trace.find(event); at != string::npos; at = trace.find(event, at + 1)) {
+		found++;
+	}
+	return found;
+}
+
+int main(int argc, char** argv) {
+
+	if(argc != 1) {
+		printf("Trace events test\n");
+		printf("\n");
+		printf("Usage:\n");
+		printf("%s\n", argv[0]);
+		exit(0);
+	}
+
+	trace_events::set_enabled(true);
+
+	pthread_t client_thread;
+	pthread_create(&client_thread, NULL, client_function, NULL);
+	TCPSender tcp_sender(port);
+	bool done = run_system(&tcp_sender, 20);
+	pthread_join(client_thread, NULL);
+
+	//each 5th frame takes 1.5 periods
+	MockSender mock_sender;
+	mock_sender.set_completion_fn([](uint_fast32_t frame_number, uint_fast64_t) {
+		return frame_number % 5 == 4 ? MS_TO_NS(30) : MS_TO_NS(1);
+	});
+	done = run_system(&mock_sender, 20) && done;
+
+	const char* path = "trace_events_test.json";
+	if(!trace_events::dump(path)) {
+		cout << "Can't write the trace." << endl;
+		return 1;
+	}
+	trace_events::set_enabled(false);
+	ifstream file(path);
+	stringstream content;
+	content << file.rdbuf();
+	string trace = content.str();
+
+	bool failed = !done;
+	const char* names[] = {"tick", "timer sleep", "user fn", "send handoff", "frame", "send"};
+	for(const char* name : names) {
+		int begins = count(trace, name, 'B'), ends = count(trace, name, 'E');
+		printf("%-14s %4d begin %4d end\n", name, begins, ends);
+		if(begins == 0 || begins != ends) {
+			failed = true;
+		}
+	}
+	int skipped = count(trace, "skipped frame (late send)", 'i');
+	printf("%-14s %4d\n", "skipped frames", skipped);
+	if(skipped == 0 || trace.find("\"args\": {\"name\": \"TCPSender worker\"}") == string::npos) {
+		failed = true;
+	}
+	if(failed) {
+		cout << "The trace misses events, see " << path << endl;
+	}
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,357 @@
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <dirent.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../../includes/senders.h"
+#include "../../includes/timers.h"
+
+using namespace std;
+using namespace timers_utils;
+
+/**
+ * A consumer process receives the frames of the sender and checks every
+ * one: the odd frames are copied from a memory packet and a file descriptor
+ * packet, the even ones are frame buffers passed without a copy. the frames
+ * received and the ones dropped for the consumer must be all the sent
+ * frames, and the frames must stay readable after the sender ended.
+ * a frame buffer sent with no consumer must be unmapped and closed, and a
+ * consumer must refuse a frame passed in a memfd without the seals or in a
+ * descriptor which is not a memfd.
+ */
+
+static const char* path = "/tmp/unix_sender_test.sock";
+static const char* fake_path = "/tmp/unix_sender_test_fake.sock";
+static const uint_fast32_t frames = 200;
+static const uint_fast32_t memory_packet_size = 512*1024;
+static const uint_fast32_t file_packet_size = 4096;
+static const uint_fast32_t buffer_offset = 64;
+
+//the results of the consumer process
+struct ConsumerResults{
+	uint64_t frames;
+	uint64_t lost_frames;
+	uint64_t bad_frames;
+};
+
+static char pattern(uint64_t n, uint_fast32_t i) {
+	return (char) (n * 31 + i * 7 + i / 4093);
+}
+
+//check the frame as sent for its sequence (from 1)
+static bool check_frame(const UnixFrame& frame) {
+	if(frame.sequence % 2 == 1) {
+		if(frame.num_packets != 2 || frame.packet_sizes[0] != memory_packet_size ||
+		   frame.packet_sizes[1] != file_packet_size || frame.size != memory_packet_size + file_packet_size) {
+			return false;
+		}
+		for(uint_fast32_t i=0; i<file_packet_size; i++) {
+			if(frame.data[memory_packet_size + i] != pattern(0, i)) {
+				return false;
+			}
+		}
+	} else if(frame.num_packets != 1 || frame.size != memory_packet_size) {
+		return false;
+	}
+	for(uint_fast32_t i=0; i<memory_packet_size; i += 61) {
+		if(frame.data[i] != pattern(frame.sequence, i)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+//receive the frames until the sender ends, the frames are checked once
+//again after it ended
+static int consumer_process(int results_fd) {
+	UnixConsumer consumer;
+	//the sender may not listen yet
+	while(!consumer.open(path)) {
+		consumer.get_error();
+		milliseconds_sleep(10);
+	}
+	char ready = 1;
+	if(write(results_fd, &ready, 1) != 1) {
+		return 1;
+	}
+	ConsumerResults results = {};
+	vector<UnixFrame> received;
+	received.reserve(frames);
+	UnixFrame frame;
+	while(!consumer.is_closed() && !consumer.is_error()) {
+		if(consumer.receive_frame(&frame, 100)) {
+			received.push_back(frame);
+		}
+	}
+	if(consumer.is_error()) {
+		cout << consumer.get_error() << endl;
+	}
+	for(UnixFrame& frame : received) {
+		results.frames++;
+		results.bad_frames += !check_frame(frame);
+		consumer.release_frame(&frame);
+	}
+	results.lost_frames = consumer.get_lost_frames();
+	return write(results_fd, &results, sizeof(results)) == sizeof(results) ? 0 : 1;
+}
+
+//the descriptors and the frame memfd mappings of this process
+static uint_fast32_t open_fds() {
+	uint_fast32_t fds = 0;
+	DIR* dir = opendir("/proc/self/fd");
+	while(dir != NULL && readdir(dir) != NULL) {
+		fds++;
+	}
+	closedir(dir);
+	return fds;
+}
+
+static uint_fast32_t frame_mappings() {
+	uint_fast32_t mappings = 0;
+	ifstream maps("/proc/self/maps");
+	string line;
+	while(getline(maps, line)) {
+		mappings += line.find("rtdt-frame") != string::npos;
+	}
+	return mappings;
+}
+
+//a frame buffer sent while no consumer is connected is given up at once
+static bool test_no_consumer() {
+	UnixSender sender(fake_path);
+	if(!sender.initialize()) {
+		cout << sender.get_error() << endl;
+		return false;
+	}
+	uint_fast32_t fds = open_fds(), mappings = frame_mappings();
+	for(int n=0; n<10; n++) {
+		void* buffer = sender.create_frame_buffer(memory_packet_size);
+		if(buffer == NULL) {
+			cout << sender.get_error() << endl;
+			return false;
+		}
+		DataPacketsList list(1);
+		list.packets[0].data_ptr = buffer;
+		list.packets[0].data_size = memory_packet_size;
+		if(!sender.send(&list)) {
+			cout << sender.get_error() << endl;
+			return false;
+		}
+		while(!sender.is_send_done()) {
+			microseconds_sleep(20);
+		}
+	}
+	printf("no consumer: %ld fds, %ld frame mappings left\n", long(open_fds() - fds), long(frame_mappings() - mappings));
+	bool given_up = open_fds() == fds && frame_mappings() == mappings;
+	sender.end_sender();
+	return given_up;
+}
+
+//pass the descriptor as a frame to the consumer, it must refuse it
+static bool test_refused_fd(int server_fd, int fd, const char* name) {
+	UnixConsumer consumer;
+	if(!consumer.open(fake_path)) {
+		cout << consumer.get_error() << endl;
+		return false;
+	}
+	int sock_fd = accept(server_fd, NULL, NULL);
+	UnixFrameMessage message = {};
+	message.magic = UNIX_FRAME_MAGIC;
+	message.version = UNIX_FRAME_VERSION;
+	message.sequence = 1;
+	char control[CMSG_SPACE(sizeof(int))] = {};
+	iovec iov = {&message, sizeof(message)};
+	msghdr header = {};
+	header.msg_iov = &iov;
+	header.msg_iovlen = 1;
+	header.msg_control = control;
+	header.msg_controllen = sizeof(control);
+	cmsghdr* cmsg = CMSG_FIRSTHDR(&header);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+	memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+	bool refused = sock_fd != -1 && sendmsg(sock_fd, &header, 0) == sizeof(message);
+	UnixFrame frame;
+	if(refused && (consumer.receive_frame(&frame, 1000) || !consumer.is_error())) {
+		consumer.release_frame(&frame);
+		refused = false;
+	}
+	printf("%s: %s\n", name, refused ? consumer.get_error().c_str() : "accepted");
+	close(sock_fd);
+	return refused;
+}
+
+static bool test_unsealed_frames() {
+	unlink(fake_path);
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, fake_path);
+	int server_fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+	if(server_fd == -1 || bind(server_fd, (sockaddr*) &address, sizeof(address)) != 0 || listen(server_fd, 1) != 0) {
+		cout << "Can't create the fake sender." << endl;
+		return false;
+	}
+	//a memfd with the bytes but no seal
+	int memfd = memfd_create("unsealed", MFD_ALLOW_SEALING);
+	bool refused = memfd != -1 && ftruncate(memfd, 4096) == 0 && test_refused_fd(server_fd, memfd, "unsealed memfd");
+	//an ordinary file
+	char file_path[] = "/tmp/unix_sender_test_XXXXXX";
+	int file_fd = mkstemp(file_path);
+	unlink(file_path);
+	refused &= file_fd != -1 && ftruncate(file_fd, 4096) == 0 && test_refused_fd(server_fd, file_fd, "ordinary file");
+	close(memfd);
+	close(file_fd);
+	close(server_fd);
+	unlink(fake_path);
+	return refused;
+}
+
+//a file which isn't a socket at the path is kept and the sender fails
+static bool test_path_not_socket() {
+	unlink(fake_path);
+	int file_fd = open(fake_path, O_CREAT | O_WRONLY, 0600);
+	if(file_fd == -1) {
+		cout << "Can't create the file." << endl;
+		return false;
+	}
+	close(file_fd);
+	UnixSender sender(fake_path);
+	bool refused = !sender.initialize();
+	printf("path not a socket: %s\n", refused ? sender.get_error().c_str() : "replaced");
+	struct stat path_stat;
+	bool kept = lstat(fake_path, &path_stat) == 0 && S_ISREG(path_stat.st_mode);
+	unlink(fake_path);
+	return refused && kept;
+}
+
+int main(int argc, char** argv) {
+
+	if(argc != 1) {
+		printf("Unix domain socket sender test\n");
+		printf("\n");
+		printf("Usage:\n");
+		printf("%s\n", argv[0]);
+		exit(0);
+	}
+
+	//the consumer is forked before the sender has threads
+	unlink(path);
+	int results_pipe[2];
+	if(pipe(results_pipe) != 0) {
+		cout << "Can't create the pipe." << endl;
+		return 1;
+	}
+	pid_t consumer_pid = fork();
+	if(consumer_pid == 0) {
+		exit(consumer_process(results_pipe[1]));
+	}
+
+	char* memory = (char*) malloc(memory_packet_size);
+	char file_path[] = "/tmp/unix_sender_test_XXXXXX";
+	int file_fd = mkstemp(file_path);
+	unlink(file_path);
+	vector<char> file_data(file_packet_size);
+	for(uint_fast32_t i=0; i<file_packet_size; i++) {
+		file_data[i] = pattern(0, i);
+	}
+	if(file_fd < 0 || write(file_fd, &file_data[0], file_packet_size) != (ssize_t) file_packet_size) {
+		cout << "Can't create the payload file." << endl;
+		return 1;
+	}
+
+	bool failed = false;
+	UnixSender sender(path);
+	if(!sender.initialize()) {
+		cout << sender.get_error() << endl;
+		return 1;
+	}
+	char ready = 0;
+	if(read(results_pipe[0], &ready, 1) != 1) {
+		failed = true;
+	}
+
+	for(uint64_t n=1; n<=frames && !failed; n++) {
+		DataPacketsList list(n % 2 == 1 ? 2 : 1);
+		if(n % 2 == 1) {
+			for(uint_fast32_t i=0; i<memory_packet_size; i++) {
+				memory[i] = pattern(n, i);
+			}
+			list.packets[0].data_ptr = memory;
+			list.packets[0].data_size = memory_packet_size;
+			list.packets[1].data_ptr_type = DataPacket::DATA_PTR_FILE_DESCRIPTOR;
+			list.packets[1].data_ptr = &file_fd;
+			list.packets[1].data_size = file_packet_size;
+		} else {
+			char* buffer = (char*) sender.create_frame_buffer(buffer_offset + memory_packet_size);
+			if(buffer == NULL) {
+				cout << sender.get_error() << endl;
+				failed = true;
+				break;
+			}
+			for(uint_fast32_t i=0; i<memory_packet_size; i++) {
+				buffer[buffer_offset + i] = pattern(n, i);
+			}
+			list.packets[0].data_ptr = buffer;
+			list.packets[0].data_offset = buffer_offset;
+			list.packets[0].data_size = memory_packet_size;
+		}
+		if(!sender.send(&list)) {
+			cout << sender.get_error() << endl;
+			failed = true;
+		}
+		while(!sender.is_send_done()) {
+			microseconds_sleep(20);
+		}
+	}
+	if(sender.get_consumers() != 1) {
+		cout << "The consumer was not connected." << endl;
+		failed = true;
+	}
+	uint64_t dropped_frames = sender.get_dropped_frames();
+	sender.end_sender();
+
+	ConsumerResults results = {};
+	int status = 1;
+	if(read(results_pipe[0], &results, sizeof(results)) != sizeof(results)) {
+		failed = true;
+	}
+	waitpid(consumer_pid, &status, 0);
+	printf("consumer process: %lu frames, %lu lost, %lu bad, %lu dropped by the sender\n",
+		(unsigned long) results.frames, (unsigned long) results.lost_frames,
+		(unsigned long) results.bad_frames, (unsigned long) dropped_frames);
+	if(status != 0 || results.frames + dropped_frames != frames || results.lost_frames > dropped_frames ||
+	   results.bad_frames != 0) {
+		cout << "The consumer process didn't get the sent frames." << endl;
+		failed = true;
+	}
+
+	if(!test_no_consumer()) {
+		cout << "A frame buffer sent with no consumer was kept." << endl;
+		failed = true;
+	}
+	if(!test_unsealed_frames()) {
+		cout << "A frame which is not sealed was accepted." << endl;
+		failed = true;
+	}
+	if(!test_path_not_socket()) {
+		cout << "A file which isn't a socket was replaced." << endl;
+		failed = true;
+	}
+
+	close(file_fd);
+	free(memory);
+	return failed ? 1 : 0;
+}
@@ -40,7 +40,7 @@ bool BusyWaitTimer::start_timer() {
 	}
 
 	//set the starting timer and the flag
-	clock_gettime(CLOCK_MONOTONIC, &start_time_);
+	monotonic_time(&start_time_);
 	timer_started_ = true;
 	
 	//set the time for the next tick
@@ -59,7 +59,7 @@ bool BusyWaitTimer::sleep_to_next_tick() {
 
 	//check if the tick already happened before calling this function
 	timespec current_time;
-	clock_gettime(CLOCK_MONOTONIC, &current_time);
+	monotonic_time(&current_time);
 	if(TIMESPEC_DIFF_NS(start_time_, current_time) > sleep_time_ns_) {
 		error_handler_.set_error("The tick already ticked before calling sleep_to_next_tick.");
 		return false;
@@ -67,7 +67,7 @@ bool BusyWaitTimer::sleep_to_next_tick() {
 
 	//else, let's busy wait for the sleep_time period
 	while(TIMESPEC_DIFF_NS(start_time_, current_time) < sleep_time_ns_) {
-		clock_gettime(CLOCK_MONOTONIC, &current_time);
+		monotonic_time(&current_time);
 	}
 
 	/**
@@ -0,0 +1,34 @@
+#include "../../includes/simulated_clock.h"
+
+using namespace timers_utils;
+
+SimulatedClock::SimulatedClock(uint_fast64_t start_ns) {
+	now_ns_ = start_ns;
+	read_cost_ns_ = US_TO_NS(1);
+}
+
+void SimulatedClock::set_read_cost(uint_fast64_t read_cost_ns) {
+	read_cost_ns_ = read_cost_ns;
+}
+
+void SimulatedClock::advance(uint_fast64_t time_ns) {
+	now_ns_ += time_ns;
+}
+
+uint_fast64_t SimulatedClock::now() {
+	return now_ns_;
+}
+
+void SimulatedClock::get_time(timespec* time) {
+	uint_fast64_t now_ns = now_ns_.fetch_add(read_cost_ns_);
+	time->tv_sec = NS_TO_SEC(now_ns);
+	time->tv_nsec = long(now_ns % SEC_TO_NS(1));
+}
+
+void SimulatedClock::sleep(uint_fast64_t sleep_time_ns) {
+	now_ns_ += sleep_time_ns;
+}
+
+SimulatedClock::~SimulatedClock() {
+
+}
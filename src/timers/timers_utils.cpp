@@ -2,6 +2,43 @@
 
 namespace timers_utils{
 
+	//the clock replacing CLOCK_MONOTONIC, NULL for none
+	static Clock* clock_ = NULL;
+
+	/**
+	 * functions : Clock selection
+	 * -------------------------------
+	 */
+
+	void set_clock(Clock* clock) {
+		clock_ = clock;
+	}
+
+	Clock* get_clock() {
+		return clock_;
+	}
+
+	void monotonic_time(timespec* time) {
+		if(clock_ == NULL) {
+			clock_gettime(CLOCK_MONOTONIC, time);
+		} else {
+			clock_->get_time(time);
+		}
+	}
+
+	uint_fast64_t monotonic_ns() {
+		timespec current_time;
+		monotonic_time(&current_time);
+		return SEC_TO_NS(current_time.tv_sec) + current_time.tv_nsec;
+	}
+
+	uint_fast64_t cpu_time_ns(int who) {
+		rusage usage;
+		getrusage(who, &usage);
+		return SEC_TO_NS(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+			US_TO_NS(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+	}
+
 	/**
 	 * functions : Linux based sleep functions
 	 * -------------------------------
@@ -9,6 +46,11 @@ namespace timers_utils{
 
 	void nanoseconds_sleep(uint_fast64_t sleep_time_ns) {
 
+		if(clock_ != NULL) {
+			clock_->sleep(sleep_time_ns);
+			return;
+		}
+
 		timespec start_time, current_time;
 		uint_fast64_t slept_time_ns;
 		struct timespec ns_sleep_time;
@@ -41,7 +41,7 @@ bool WorstCaseTimer::start_timer() {
 	}
 
 	//set the starting timer and the flag
-	clock_gettime(CLOCK_MONOTONIC, &start_time_);
+	monotonic_time(&start_time_);
 	timer_started_ = true;
 	
 	//set the time for the next tick
@@ -60,7 +60,7 @@ bool WorstCaseTimer::sleep_to_next_tick() {
 
 	//check if the tick already happened before calling this function
 	timespec current_time;
-	clock_gettime(CLOCK_MONOTONIC, &current_time);
+	monotonic_time(&current_time);
 
 	if(TIMESPEC_DIFF_NS(start_time_, current_time) > sleep_time_ns_) {
 		error_handler_.set_error("The tick already ticked before calling sleep_to_next_tick.");
@@ -71,14 +71,14 @@ bool WorstCaseTimer::sleep_to_next_tick() {
 	if(sleep_time_ns_ - TIMESPEC_DIFF_NS(start_time_, current_time) < worst_timer_delay_ns_) {
 		//then busy wait for the period
 		while(TIMESPEC_DIFF_NS(start_time_, current_time) < sleep_time_ns_) {
-			clock_gettime(CLOCK_MONOTONIC, &current_time);
+			monotonic_time(&current_time);
 		}
  	} else {
  		//block the process for the needed sleep time - worst_timer_delay_
 		nanoseconds_sleep(sleep_time_ns_ - TIMESPEC_DIFF_NS(start_time_, current_time) - worst_timer_delay_ns_);
  		//then busy wait for the rest of the time
 		while(TIMESPEC_DIFF_NS(start_time_, current_time) < sleep_time_ns_) {
-			clock_gettime(CLOCK_MONOTONIC, &current_time);
+			monotonic_time(&current_time);
 		}
  	}
 
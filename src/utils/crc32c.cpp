@@ -0,0 +1,153 @@
+#include "../../includes/crc32c.h"
+
+#if defined(__x86_64__)
+	#define CRC32C_X86
+	#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+	#define CRC32C_ARM
+	#include <arm_acle.h>
+#endif
+
+#include <string.h>
+
+namespace crc32c{
+
+	//reflected Castagnoli polynomial
+	#define CRC32C_POLY (0x82F63B78u)
+
+	/**
+	 * Slicing-by-8 tables : table_[k][b] is the crc of byte b followed by
+	 * k zero bytes.
+	 */
+	static uint32_t table_[8][256];
+
+	static struct TableBuilder{
+		TableBuilder() {
+			for(uint32_t b=0; b<256; b++) {
+				uint32_t crc = b;
+				for(int i=0; i<8; i++) {
+					crc = (crc >> 1) ^ (CRC32C_POLY & (0u - (crc & 1)));
+				}
+				table_[0][b] = crc;
+			}
+			for(uint32_t b=0; b<256; b++) {
+				for(int k=1; k<8; k++) {
+					table_[k][b] = (table_[k-1][b] >> 8) ^ table_[0][table_[k-1][b] & 0xff];
+				}
+			}
+		}
+	} table_builder;
+
+	uint32_t extend_portable(uint32_t crc, const void* data, size_t size) {
+		const uint8_t* p = (const uint8_t*) data;
+		uint32_t c = ~crc;
+		//align the input to 8 bytes
+		while(size && ((uintptr_t) p & 7)) {
+			c = table_[0][(c ^ *p++) & 0xff] ^ (c >> 8);
+			size--;
+		}
+		while(size >= 8) {
+			uint32_t lo, hi;
+			memcpy(&lo, p, 4);
+			memcpy(&hi, p + 4, 4);
+			lo ^= c;
+			c = table_[7][lo & 0xff] ^ table_[6][(lo >> 8) & 0xff] ^
+			    table_[5][(lo >> 16) & 0xff] ^ table_[4][lo >> 24] ^
+			    table_[3][hi & 0xff] ^ table_[2][(hi >> 8) & 0xff] ^
+			    table_[1][(hi >> 16) & 0xff] ^ table_[0][hi >> 24];
+			p += 8;
+			size -= 8;
+		}
+		while(size--) {
+			c = table_[0][(c ^ *p++) & 0xff] ^ (c >> 8);
+		}
+		return ~c;
+	}
+
+#ifdef CRC32C_X86
+
+	__attribute__((target("sse4.2")))
+	static uint32_t extend_hardware(uint32_t crc, const void* data, size_t size) {
+		const uint8_t* p = (const uint8_t*) data;
+		uint64_t c = ~crc;
+		while(size && ((uintptr_t) p & 7)) {
+			c = _mm_crc32_u8(uint32_t(c), *p++);
+			size--;
+		}
+		while(size >= 8) {
+			uint64_t v;
+			memcpy(&v, p, 8);
+			c = _mm_crc32_u64(c, v);
+			p += 8;
+			size -= 8;
+		}
+		while(size--) {
+			c = _mm_crc32_u8(uint32_t(c), *p++);
+		}
+		return ~uint32_t(c);
+	}
+
+	static bool hardware_supported() {
+		//needed since this may run before main()
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("sse4.2");
+	}
+
+#elif defined(CRC32C_ARM)
+
+	static uint32_t extend_hardware(uint32_t crc, const void* data, size_t size) {
+		const uint8_t* p = (const uint8_t*) data;
+		uint32_t c = ~crc;
+		while(size && ((uintptr_t) p & 7)) {
+			c = __crc32cb(c, *p++);
+			size--;
+		}
+		while(size >= 8) {
+			uint64_t v;
+			memcpy(&v, p, 8);
+			c = __crc32cd(c, v);
+			p += 8;
+			size -= 8;
+		}
+		while(size--) {
+			c = __crc32cb(c, *p++);
+		}
+		return ~c;
+	}
+
+	static bool hardware_supported() {
+		return true;
+	}
+
+#else
+
+	static uint32_t extend_hardware(uint32_t crc, const void* data, size_t size) {
+		return extend_portable(crc, data, size);
+	}
+
+	static bool hardware_supported() {
+		return false;
+	}
+
+#endif
+
+	static bool use_hardware_ = hardware_supported();
+
+	uint32_t extend(uint32_t crc, const void* data, size_t size) {
+		if(use_hardware_) {
+			return extend_hardware(crc, data, size);
+		}
+		return extend_portable(crc, data, size);
+	}
+
+	uint32_t compute(const void* data, size_t size) {
+		return extend(0, data, size);
+	}
+
+	bool is_hardware_accelerated() {
+		return use_hardware_;
+	}
+
+}
@@ -0,0 +1,126 @@
+#include "../../includes/frame_buffer_pool.h"
+
+#include <stdlib.h>
+
+void FrameBuffer::retain() {
+	refs.fetch_add(1);
+}
+
+void FrameBuffer::release() {
+	if(refs.fetch_sub(1) == 1) {
+		pool->give_back(this);
+	}
+}
+
+DataPacket FrameBuffer::make_packet(uint_fast32_t size, uint_fast32_t offset) {
+	DataPacket packet;
+	packet.data_ptr_type = DataPacket::DATA_PTR_MEMORY_LOCATION;
+	packet.data_ptr = data;
+	packet.data_size = size;
+	packet.data_offset = offset;
+	packet.release_fn = FrameBufferPool::release_packet;
+	packet.release_ctx = this;
+	return packet;
+}
+
+FrameBufferPool::FrameBufferPool() : error_handler_("FrameBufferPool") {
+	memory_ = NULL;
+	pthread_mutex_init(&pool_mutex_, NULL);
+	pthread_cond_init(&pool_cond_, NULL);
+}
+
+bool FrameBufferPool::initialize(uint_fast32_t buffer_size, uint_fast32_t num_buffers, bool huge_pages) {
+	if(buffer_size == 0 || num_buffers == 0) {
+		error_handler_.set_error("The pool needs at least one buffer of one byte");
+		return false;
+	}
+	MutexRAII prot_lock(pool_mutex_);
+	prot_lock.lock_block();
+	if(free_.size() != buffers_.size()) {
+		error_handler_.set_error("Some buffers are still in use");
+		return false;
+	}
+	free_memory();
+	//keep each buffer on its own pages
+	uint_fast64_t stride = (uint_fast64_t(buffer_size) + 4095) & ~uint_fast64_t(4095);
+	if(huge_pages) {
+		if(!huge_page_memory::allocate(stride * num_buffers, &huge_block_)) {
+			error_handler_.set_error("Can't allocate and lock the huge pages of the buffers");
+			return false;
+		}
+		memory_ = huge_block_.memory;
+	} else if(posix_memalign(&memory_, 4096, stride * num_buffers) != 0) {
+		memory_ = NULL;
+		error_handler_.set_error("Can't allocate the memory of the buffers");
+		return false;
+	}
+	buffers_ = std::vector<FrameBuffer>(num_buffers);
+	free_.reserve(num_buffers);
+	for(uint_fast32_t i=0; i<num_buffers; i++) {
+		buffers_[i].data = ((char*) memory_) + stride * i;
+		buffers_[i].capacity = buffer_size;
+		buffers_[i].refs = 0;
+		buffers_[i].pool = this;
+		free_.push_back(&buffers_[i]);
+	}
+	return true;
+}
+
+FrameBuffer* FrameBufferPool::acquire(bool block) {
+	MutexRAII prot_lock(pool_mutex_);
+	prot_lock.lock_block();
+	while(free_.empty()) {
+		if(!block || buffers_.empty()) {
+			return NULL;
+		}
+		pthread_cond_wait(&pool_cond_, &pool_mutex_);
+	}
+	FrameBuffer* buffer = free_.back();
+	free_.pop_back();
+	buffer->refs = 1;
+	return buffer;
+}
+
+uint_fast32_t FrameBufferPool::available() {
+	MutexRAII prot_lock(pool_mutex_);
+	prot_lock.lock_block();
+	return free_.size();
+}
+
+void FrameBufferPool::release_packet(void* buffer) {
+	((FrameBuffer*) buffer)->release();
+}
+
+void FrameBufferPool::give_back(FrameBuffer* buffer) {
+	MutexRAII prot_lock(pool_mutex_);
+	prot_lock.lock_block();
+	free_.push_back(buffer);
+	pthread_cond_signal(&pool_cond_);
+}
+
+void FrameBufferPool::free_memory() {
+	free_.clear();
+	buffers_.clear();
+	if(huge_block_.memory != NULL) {
+		huge_page_memory::deallocate(&huge_block_);
+	} else {
+		free(memory_);
+	}
+	memory_ = NULL;
+}
+
+std::string FrameBufferPool::get_error() {
+	std::string error = error_handler_.get_error();
+	error_handler_.clear_error();
+	return error;
+}
+
+bool FrameBufferPool::is_error() {
+	return error_handler_.is_error();
+}
+
+FrameBufferPool::~FrameBufferPool() {
+	free_memory();
+	pthread_cond_destroy(&pool_cond_);
+	pthread_mutex_destroy(&pool_mutex_);
+}
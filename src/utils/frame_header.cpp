@@ -0,0 +1,37 @@
+#include "../../includes/frame_header.h"
+
+namespace frame_header{
+
+	void build(const DataPacketsList& list, uint32_t sequence_number, FrameHeader* header) {
+		header->magic = FRAME_HEADER_MAGIC;
+		header->flags = FRAME_HEADER_FLAG_CRC;
+		header->sequence_number = sequence_number;
+		header->frame_size = 0;
+		header->crc = 0;
+		for(uint_fast32_t i=0; i<list.num_packets; i++) {
+			const DataPacket* packet = list.packets + i;
+			header->frame_size += packet->data_size;
+			if(packet->data_ptr_type != DataPacket::DATA_PTR_MEMORY_LOCATION) {
+				header->flags &= ~FRAME_HEADER_FLAG_CRC;
+				continue;
+			}
+			if(header->flags & FRAME_HEADER_FLAG_CRC) {
+				header->crc = crc32c::extend(header->crc, (const char*) packet->data_ptr + packet->data_offset, packet->data_size);
+			}
+		}
+		if(!(header->flags & FRAME_HEADER_FLAG_CRC)) {
+			header->crc = 0;
+		}
+	}
+
+	bool verify(const FrameHeader* header, const void* frame_data) {
+		if(header->magic != FRAME_HEADER_MAGIC) {
+			return false;
+		}
+		if(!(header->flags & FRAME_HEADER_FLAG_CRC)) {
+			return true;
+		}
+		return crc32c::compute(frame_data, header->frame_size) == header->crc;
+	}
+
+}
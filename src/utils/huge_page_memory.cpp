@@ -0,0 +1,67 @@
+#include "../../includes/huge_page_memory.h"
+
+#include <sys/mman.h>
+
+namespace huge_page_memory{
+
+	//map an anonymous block aligned to HUGE_PAGE_SIZE, NULL on failure
+	static void* map_aligned(size_t size) {
+		//map an extra huge page then trim both ends to the alignment
+		size_t mapped_size = size + HUGE_PAGE_SIZE;
+		void* mapped = mmap(NULL, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if(mapped == MAP_FAILED) {
+			return NULL;
+		}
+		uintptr_t start = uintptr_t(mapped);
+		uintptr_t aligned = (start + HUGE_PAGE_SIZE - 1) & ~uintptr_t(HUGE_PAGE_SIZE - 1);
+		if(aligned != start) {
+			munmap(mapped, aligned - start);
+		}
+		size_t tail = (start + mapped_size) - (aligned + size);
+		if(tail != 0) {
+			munmap((void*)(aligned + size), tail);
+		}
+		return (void*) aligned;
+	}
+
+	bool allocate(size_t size, HugePageBlock* block) {
+		if(size == 0) {
+			return false;
+		}
+		size = (size + HUGE_PAGE_SIZE - 1) & ~size_t(HUGE_PAGE_SIZE - 1);
+		//the reserved huge pages are faulted in by MAP_POPULATE
+		HugePageBlock::PAGE_KIND kind = HugePageBlock::HUGETLB_PAGES;
+		void* memory = mmap(NULL, size, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+		if(memory == MAP_FAILED) {
+			//no reserved huge pages, ask for transparent ones before the
+			//first fault, mlock(2) faults in the whole block
+			memory = map_aligned(size);
+			if(memory == NULL) {
+				return false;
+			}
+			kind = madvise(memory, size, MADV_HUGEPAGE) == 0 ?
+				HugePageBlock::TRANSPARENT_HUGE_PAGES : HugePageBlock::NORMAL_PAGES;
+		}
+		if(mlock(memory, size) != 0) {
+			munmap(memory, size);
+			return false;
+		}
+		block->memory = memory;
+		block->size = size;
+		block->kind = kind;
+		return true;
+	}
+
+	void deallocate(HugePageBlock* block) {
+		if(block->memory == NULL) {
+			return;
+		}
+		munlock(block->memory, block->size);
+		munmap(block->memory, block->size);
+		block->memory = NULL;
+		block->size = 0;
+		block->kind = HugePageBlock::NORMAL_PAGES;
+	}
+
+}
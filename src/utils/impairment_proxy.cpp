@@ -0,0 +1,303 @@
+#include "../../includes/impairment_proxy.h"
+#include "../../includes/socket_utils.h"
+#include "../../includes/timers_utils.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+using namespace timers_utils;
+
+//data read from the sender, forwarded from release_ns
+struct ProxyChunk{
+	uint_fast64_t release_ns;
+	std::vector<char> data;
+	size_t offset;
+};
+
+//true if end_proxy(0) wrote the eventfd, it's never read so it stays set
+static bool is_woken(int wake_fd) {
+	pollfd pfd = {wake_fd, POLLIN, 0};
+	return poll(&pfd, 1, 0) == 1;
+}
+
+ImpairmentProxy::ImpairmentProxy(uint_fast16_t listen_port, uint_fast16_t target_port) : error_handler_("ImpairmentProxy") {
+	listen_port_ = listen_port;
+	target_port_ = target_port;
+	server_sock_fd_ = -1;
+	wake_fd_ = -1;
+	running_ = false;
+	memset(&settings_, 0, sizeof(settings_));
+	pthread_mutex_init(&settings_mutex_, NULL);
+	queue_limit_ = 1024*1024;
+	forwarded_bytes_ = 0;
+	connections_ = 0;
+}
+
+void ImpairmentProxy::set_impairment(const ImpairmentSettings& settings) {
+	MutexRAII prot_lock(settings_mutex_);
+	prot_lock.lock_block();
+	settings_ = settings;
+}
+
+ImpairmentSettings ImpairmentProxy::get_impairment() {
+	MutexRAII prot_lock(settings_mutex_);
+	prot_lock.lock_block();
+	return settings_;
+}
+
+void ImpairmentProxy::set_queue_limit(uint_fast32_t queue_limit) {
+	queue_limit_ = std::max(queue_limit, uint_fast32_t(1));
+}
+
+bool ImpairmentProxy::initialize() {
+	if(running_) {
+		error_handler_.set_error("The proxy is already running");
+		return false;
+	}
+
+	//listen on the loopback only
+	server_sock_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+	int yes = 1;
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_port = htons(listen_port_);
+	inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+	if(server_sock_fd_ == -1 ||
+	   setsockopt(server_sock_fd_, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes)) == -1 ||
+	   bind(server_sock_fd_, (sockaddr*) &address, sizeof(address)) == -1 ||
+	   listen(server_sock_fd_, 1) == -1) {
+		error_handler_.set_error("Can't listen on port " + std::to_string(listen_port_) + ": " + strerror(errno));
+		close_sockets();
+		return false;
+	}
+	wake_fd_ = eventfd(0, EFD_NONBLOCK);
+	if(wake_fd_ == -1) {
+		error_handler_.set_error("Failed to create the wake eventfd");
+		close_sockets();
+		return false;
+	}
+
+	forwarded_bytes_ = 0;
+	connections_ = 0;
+	int th_st = pthread_create(&proxy_thread_, NULL, proxy_function, (void*) this);
+	if(th_st) {
+		error_handler_.set_error("pthread_create() return code: " + std::to_string(th_st));
+		close_sockets();
+		return false;
+	}
+	running_ = true;
+	return true;
+}
+
+void ImpairmentProxy::end_proxy() {
+	if(!running_) {
+		return;
+	}
+	uint64_t wake = 1;
+	if(write(wake_fd_, &wake, sizeof(wake)) != sizeof(wake)) {
+		//the eventfd is already set
+	}
+	pthread_join(proxy_thread_, NULL);
+	close_sockets();
+	running_ = false;
+}
+
+void ImpairmentProxy::close_sockets() {
+	if(server_sock_fd_ != -1) {
+		close(server_sock_fd_);
+		server_sock_fd_ = -1;
+	}
+	if(wake_fd_ != -1) {
+		close(wake_fd_);
+		wake_fd_ = -1;
+	}
+}
+
+void* ImpairmentProxy::proxy_function(void* proxy) {
+	ImpairmentProxy* self = (ImpairmentProxy*) proxy;
+	while(!is_woken(self->wake_fd_)) {
+		int client_fd = -1;
+		if(!socket_utils::accept_client(self->server_sock_fd_, self->wake_fd_, -1, &client_fd)) {
+			continue;
+		}
+		int target_fd = self->connect_target();
+		if(target_fd != -1) {
+			self->connections_++;
+			self->forward(client_fd, target_fd);
+			close(target_fd);
+		}
+		close(client_fd);
+	}
+	return NULL;
+}
+
+int ImpairmentProxy::connect_target() {
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_port = htons(target_port_);
+	inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+	//try for one second
+	for(int i=0; i<100 && !is_woken(wake_fd_); i++) {
+		int target_fd = socket(AF_INET, SOCK_STREAM, 0);
+		//a small receive buffer, so the sender is slowed by the proxy
+		//instead of filling the loopback buffers
+		int buff_size = 256*1024;
+		setsockopt(target_fd, SOL_SOCKET, SO_RCVBUF, &buff_size, sizeof(buff_size));
+		if(connect(target_fd, (sockaddr*) &address, sizeof(address)) == 0) {
+			return target_fd;
+		}
+		close(target_fd);
+		//wait 10ms, unless the proxy ends
+		pollfd pfd = {wake_fd_, POLLIN, 0};
+		poll(&pfd, 1, 10);
+	}
+	return -1;
+}
+
+void ImpairmentProxy::forward(int client_fd, int target_fd) {
+	std::deque<ProxyChunk> queue;
+	uint_fast64_t queued_bytes = 0;
+	std::vector<char> buffer(64*1024);
+	uint_fast64_t connected_ns = monotonic_ns();
+	uint_fast64_t last_refill_ns = connected_ns;
+	uint_fast64_t last_release_ns = 0;
+	unsigned int seed = (unsigned int) connected_ns;
+	double tokens = 0;
+	bool target_open = true;
+
+	while(1) {
+		ImpairmentSettings settings = get_impairment();
+		uint_fast64_t now = monotonic_ns();
+
+		//is the link stalled now
+		bool stalled = false;
+		if(settings.stall_ms != 0 && settings.stall_period_ms != 0) {
+			stalled = settings.stall_ms >= settings.stall_period_ms ||
+				(now - connected_ns) % MS_TO_NS(settings.stall_period_ms) >=
+				MS_TO_NS(settings.stall_period_ms - settings.stall_ms);
+		}
+
+		//refill the bandwidth tokens, at most 10ms of data is sent at once
+		if(settings.bandwidth_bytes != 0) {
+			double burst = std::max(double(settings.bandwidth_bytes) / 100, 16.0*1024);
+			tokens = std::min(tokens + double(now - last_refill_ns) * settings.bandwidth_bytes / SEC_TO_NS(1), burst);
+		}
+		last_refill_ns = now;
+
+		//forward the released data
+		bool client_full = false;
+		while(!stalled && !queue.empty() && queue.front().release_ns <= now) {
+			ProxyChunk& chunk = queue.front();
+			size_t size = chunk.data.size() - chunk.offset;
+			if(settings.bandwidth_bytes != 0) {
+				if(tokens < 1) {
+					break;
+				}
+				size = std::min(size, size_t(tokens));
+			}
+			ssize_t sent = send(client_fd, chunk.data.data() + chunk.offset, size, MSG_NOSIGNAL | MSG_DONTWAIT);
+			if(sent < 0) {
+				if(errno == EAGAIN || errno == EWOULDBLOCK) {
+					client_full = true;
+					break;
+				}
+				//the client left
+				return;
+			}
+			forwarded_bytes_ += sent;
+			queued_bytes -= sent;
+			tokens -= sent;
+			chunk.offset += sent;
+			if(chunk.offset == chunk.data.size()) {
+				queue.pop_front();
+			}
+		}
+		//the sender closed and everything is forwarded
+		if(!target_open && queue.empty()) {
+			return;
+		}
+
+		//read the sender while the bottleneck has room
+		bool can_read = target_open && !stalled && queued_bytes < queue_limit_;
+		if(can_read) {
+			size_t size = std::min(buffer.size(), size_t(queue_limit_ - queued_bytes));
+			ssize_t received = recv(target_fd, buffer.data(), size, MSG_DONTWAIT);
+			if(received > 0) {
+				uint_fast64_t release_ns = now + US_TO_NS(settings.delay_us);
+				if(settings.jitter_us != 0) {
+					release_ns += US_TO_NS(rand_r(&seed) % settings.jitter_us);
+				}
+				//keep the stream in order
+				release_ns = std::max(release_ns, last_release_ns);
+				last_release_ns = release_ns;
+				ProxyChunk chunk = {release_ns, std::vector<char>(buffer.data(), buffer.data() + received), 0};
+				queue.push_back(std::move(chunk));
+				queued_bytes += received;
+				continue;
+			}
+			if(received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+				target_open = false;
+				continue;
+			}
+		}
+
+		//wait for the sockets, or 1ms for the next release, tokens or the
+		//end of the stall
+		pollfd pfd[3];
+		pfd[0].fd = can_read ? target_fd : -1;
+		pfd[0].events = POLLIN;
+		pfd[1].fd = client_fd;
+		pfd[1].events = POLLIN | (client_full ? POLLOUT : 0);
+		pfd[2].fd = wake_fd_;
+		pfd[2].events = POLLIN;
+		for(int i=0; i<3; i++) {
+			pfd[i].revents = 0;
+		}
+		bool timed = stalled || (!queue.empty() && !client_full);
+		poll(pfd, 3, timed ? 1 : -1);
+		if(pfd[2].revents & POLLIN) {
+			return;
+		}
+		//the client doesn't send anything, it's read to see it leaving
+		if(pfd[1].revents & (POLLIN | POLLHUP | POLLERR)) {
+			ssize_t received = recv(client_fd, buffer.data(), buffer.size(), MSG_DONTWAIT);
+			if(received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+				return;
+			}
+		}
+	}
+}
+
+uint_fast64_t ImpairmentProxy::get_forwarded_bytes() {
+	return forwarded_bytes_;
+}
+
+uint_fast32_t ImpairmentProxy::get_connections() {
+	return connections_;
+}
+
+std::string ImpairmentProxy::get_error() {
+	std::string error = error_handler_.get_error();
+	error_handler_.clear_error();
+	return error;
+}
+
+bool ImpairmentProxy::is_error() {
+	return error_handler_.is_error();
+}
+
+ImpairmentProxy::~ImpairmentProxy() {
+	end_proxy();
+	pthread_mutex_destroy(&settings_mutex_);
+}
@@ -0,0 +1,211 @@
+#include "../../includes/perf_counters.h"
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+using namespace std;
+
+namespace perf_counters{
+
+	const char* name(PERF_COUNTER_ID id) {
+		static const char* names[PERF_COUNTERS] = {"cycles", "instructions", "cache_references", "cache_misses",
+			"branch_misses", "task_clock_ns", "page_faults", "context_switches"};
+		return id < PERF_COUNTERS ? names[id] : "";
+	}
+}
+
+//type and config of each counter
+static const struct {uint32_t type; uint64_t config;} counter_events[PERF_COUNTERS] = {
+	{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+	{PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+	{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES},
+	{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+	{PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+	{PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+	{PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+	{PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+};
+
+//open a counter of the calling thread in the group of leader_fd (-1 for a
+//new group)
+static int open_counter(PERF_COUNTER_ID id, int leader_fd, bool kernel) {
+	perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = counter_events[id].type;
+	attr.config = counter_events[id].config;
+	attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+	attr.exclude_kernel = !kernel;
+	attr.exclude_hv = 1;
+	return syscall(SYS_perf_event_open, &attr, 0, -1, leader_fd, 0);
+}
+
+PerfCounters::PerfCounters() : error_handler_("PerfCounters") {
+	for(int group=0; group<GROUPS; group++) {
+		group_fd_[group] = -1;
+		group_size_[group] = 0;
+	}
+	for(int id=0; id<PERF_COUNTERS; id++) {
+		fds_[id] = -1;
+		opened_[id] = false;
+	}
+	is_open_ = false;
+	kernel_included_ = false;
+	started_ = false;
+	reset();
+}
+
+bool PerfCounters::open() {
+	close();
+	for(int id=0; id<PERF_COUNTERS; id++) {
+		opened_[id] = false;
+	}
+	//count the kernel time if allowed, most of the sender time is there
+	int last_errno = 0;
+	for(bool kernel : {true, false}) {
+		for(int id=0; id<PERF_COUNTERS; id++) {
+			int group = counter_events[id].type == PERF_TYPE_HARDWARE ? HARDWARE_GROUP : SOFTWARE_GROUP;
+			int fd = open_counter(PERF_COUNTER_ID(id), group_fd_[group], kernel);
+			if(fd < 0) {
+				last_errno = errno;
+				continue;
+			}
+			if(group_fd_[group] == -1) {
+				group_fd_[group] = fd;
+			}
+			fds_[id] = fd;
+			opened_[id] = true;
+			group_counters_[group][group_size_[group]++] = PERF_COUNTER_ID(id);
+		}
+		kernel_included_ = kernel;
+		if(group_fd_[HARDWARE_GROUP] != -1 || group_fd_[SOFTWARE_GROUP] != -1 ||
+		   (last_errno != EACCES && last_errno != EPERM)) {
+			break;
+		}
+	}
+	if(group_fd_[HARDWARE_GROUP] == -1 && group_fd_[SOFTWARE_GROUP] == -1) {
+		error_handler_.set_error(string("Can't open any perf counter : ") + strerror(last_errno));
+		return false;
+	}
+	owner_ = pthread_self();
+	started_ = false;
+	is_open_ = true;
+	return true;
+}
+
+void PerfCounters::close() {
+	is_open_ = false;
+	started_ = false;
+	for(int id=0; id<PERF_COUNTERS; id++) {
+		if(fds_[id] != -1) {
+			::close(fds_[id]);
+			fds_[id] = -1;
+		}
+	}
+	for(int group=0; group<GROUPS; group++) {
+		group_fd_[group] = -1;
+		group_size_[group] = 0;
+	}
+}
+
+bool PerfCounters::is_open() {
+	return is_open_;
+}
+
+bool PerfCounters::read_groups(uint_fast64_t* values, uint_fast64_t* enabled, uint_fast64_t* running) {
+	//nr, time enabled, time running and the values
+	uint64_t buffer[3 + PERF_COUNTERS];
+	for(int group=0; group<GROUPS; group++) {
+		if(group_fd_[group] == -1) {
+			continue;
+		}
+		ssize_t size = sizeof(uint64_t) * (3 + group_size_[group]);
+		if(read(group_fd_[group], buffer, size) != size || buffer[0] != group_size_[group]) {
+			return false;
+		}
+		enabled[group] = buffer[1];
+		running[group] = buffer[2];
+		for(uint_fast32_t i=0; i<group_size_[group]; i++) {
+			values[group_counters_[group][i]] = buffer[3 + i];
+		}
+	}
+	return true;
+}
+
+void PerfCounters::begin() {
+	if(!is_open_.load(std::memory_order_relaxed) || !pthread_equal(owner_, pthread_self())) {
+		return;
+	}
+	started_ = read_groups(start_values_, start_enabled_, start_running_);
+}
+
+void PerfCounters::discard() {
+	if(!pthread_equal(owner_, pthread_self())) {
+		return;
+	}
+	started_ = false;
+}
+
+void PerfCounters::end(uint_fast64_t bytes) {
+	if(!started_ || !is_open_.load(std::memory_order_relaxed) || !pthread_equal(owner_, pthread_self())) {
+		return;
+	}
+	started_ = false;
+	uint_fast64_t end_values[PERF_COUNTERS], end_enabled[GROUPS], end_running[GROUPS];
+	if(!read_groups(end_values, end_enabled, end_running)) {
+		return;
+	}
+	for(int group=0; group<GROUPS; group++) {
+		if(group_fd_[group] == -1) {
+			continue;
+		}
+		uint_fast64_t enabled = end_enabled[group] - start_enabled_[group];
+		uint_fast64_t running = end_running[group] - start_running_[group];
+		for(uint_fast32_t i=0; i<group_size_[group]; i++) {
+			PERF_COUNTER_ID id = group_counters_[group][i];
+			uint_fast64_t value = end_values[id] - start_values_[id];
+			//the group was multiplexed with other events, scale it up
+			if(running != 0 && running < enabled) {
+				value = uint_fast64_t(double(value) * enabled / running);
+			}
+			values_[id].fetch_add(value, std::memory_order_relaxed);
+		}
+	}
+	bytes_.fetch_add(bytes, std::memory_order_relaxed);
+	intervals_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void PerfCounters::get_stats(PerfCounterStats* stats) {
+	for(int id=0; id<PERF_COUNTERS; id++) {
+		stats->opened[id] = opened_[id];
+		stats->values[id] = values_[id].load(std::memory_order_relaxed);
+	}
+	stats->kernel_included = kernel_included_;
+	stats->intervals = intervals_.load(std::memory_order_relaxed);
+	stats->bytes = bytes_.load(std::memory_order_relaxed);
+}
+
+void PerfCounters::reset() {
+	intervals_ = 0;
+	bytes_ = 0;
+	for(int id=0; id<PERF_COUNTERS; id++) {
+		values_[id] = 0;
+	}
+}
+
+string PerfCounters::get_error() {
+	string error = error_handler_.get_error();
+	error_handler_.clear_error();
+	return error;
+}
+
+bool PerfCounters::is_error() {
+	return error_handler_.is_error();
+}
+
+PerfCounters::~PerfCounters() {
+	close();
+}
@@ -0,0 +1,357 @@
+#include "../../includes/raw12_packing.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+	#define RAW12_X86
+	#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#define RAW12_NEON
+	#include <arm_neon.h>
+#endif
+
+namespace raw12{
+
+	/**
+	 * Scalar kernels : always available, also used for the tails of the
+	 * vectorized kernels.
+	 */
+	static void pack_scalar(const uint16_t* src, uint8_t* dst, uint_fast64_t num_pixels) {
+		uint_fast64_t i = 0;
+		for(; i + 1 < num_pixels; i += 2) {
+			uint_fast16_t p0 = src[i] & 0xfff, p1 = src[i+1] & 0xfff;
+			dst[0] = uint8_t(p0 >> 4);
+			dst[1] = uint8_t(((p0 & 0xf) << 4) | (p1 >> 8));
+			dst[2] = uint8_t(p1 & 0xff);
+			dst += 3;
+		}
+		//odd last pixel
+		if(i < num_pixels) {
+			uint_fast16_t p0 = src[i] & 0xfff;
+			dst[0] = uint8_t(p0 >> 4);
+			dst[1] = uint8_t((p0 & 0xf) << 4);
+		}
+	}
+
+	static void unpack_scalar(const uint8_t* src, uint16_t* dst, uint_fast64_t num_pixels) {
+		uint_fast64_t i = 0;
+		for(; i + 1 < num_pixels; i += 2) {
+			dst[i]   = uint16_t((src[0] << 4) | (src[1] >> 4));
+			dst[i+1] = uint16_t(((src[1] & 0xf) << 8) | src[2]);
+			src += 3;
+		}
+		//odd last pixel
+		if(i < num_pixels) {
+			dst[i] = uint16_t((src[0] << 4) | (src[1] >> 4));
+		}
+	}
+
+#ifdef RAW12_X86
+
+	/**
+	 * SSSE3/AVX2 kernels : each 32-bit lane holds a pixel pair (P0 | P1 << 16)
+	 * which is folded into the 24-bit value P0 << 12 | P1, then pshufb writes
+	 * its 3 bytes in big endian order.
+	 * the stores/loads touch 4 bytes past the current block, so the loops stop
+	 * while at least 3 pixels remain and the scalar kernel finishes the rest.
+	 */
+	__attribute__((target("ssse3")))
+	static void pack_ssse3(const uint16_t* src, uint8_t* dst, uint_fast64_t num_pixels) {
+		const __m128i mask_12 = _mm_set1_epi32(0xfff);
+		const __m128i shuffle = _mm_setr_epi8(2,1,0, 6,5,4, 10,9,8, 14,13,12, -1,-1,-1,-1);
+		uint_fast64_t i = 0;
+		for(; i + 8 + 3 <= num_pixels; i += 8) {
+			__m128i x = _mm_loadu_si128((const __m128i*)(src + i));
+			__m128i p0 = _mm_and_si128(x, mask_12);
+			__m128i p1 = _mm_and_si128(_mm_srli_epi32(x, 16), mask_12);
+			__m128i y = _mm_or_si128(_mm_slli_epi32(p0, 12), p1);
+			_mm_storeu_si128((__m128i*)dst, _mm_shuffle_epi8(y, shuffle));
+			dst += 12;
+		}
+		pack_scalar(src + i, dst, num_pixels - i);
+	}
+
+	__attribute__((target("ssse3")))
+	static void unpack_ssse3(const uint8_t* src, uint16_t* dst, uint_fast64_t num_pixels) {
+		const __m128i mask_12 = _mm_set1_epi32(0xfff);
+		const __m128i shuffle = _mm_setr_epi8(2,1,0,-1, 5,4,3,-1, 8,7,6,-1, 11,10,9,-1);
+		uint_fast64_t i = 0;
+		for(; i + 8 + 3 <= num_pixels; i += 8) {
+			__m128i y = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)src), shuffle);
+			__m128i x = _mm_or_si128(_mm_srli_epi32(y, 12), _mm_slli_epi32(_mm_and_si128(y, mask_12), 16));
+			_mm_storeu_si128((__m128i*)(dst + i), x);
+			src += 12;
+		}
+		unpack_scalar(src, dst + i, num_pixels - i);
+	}
+
+	__attribute__((target("avx2")))
+	static void pack_avx2(const uint16_t* src, uint8_t* dst, uint_fast64_t num_pixels) {
+		const __m256i mask_12 = _mm256_set1_epi32(0xfff);
+		const __m256i shuffle = _mm256_setr_epi8(2,1,0, 6,5,4, 10,9,8, 14,13,12, -1,-1,-1,-1,
+		                                         2,1,0, 6,5,4, 10,9,8, 14,13,12, -1,-1,-1,-1);
+		uint_fast64_t i = 0;
+		for(; i + 16 + 3 <= num_pixels; i += 16) {
+			__m256i x = _mm256_loadu_si256((const __m256i*)(src + i));
+			__m256i p0 = _mm256_and_si256(x, mask_12);
+			__m256i p1 = _mm256_and_si256(_mm256_srli_epi32(x, 16), mask_12);
+			__m256i y = _mm256_shuffle_epi8(_mm256_or_si256(_mm256_slli_epi32(p0, 12), p1), shuffle);
+			//each 128-bit lane holds 12 valid bytes
+			_mm_storeu_si128((__m128i*)dst, _mm256_castsi256_si128(y));
+			_mm_storeu_si128((__m128i*)(dst + 12), _mm256_extracti128_si256(y, 1));
+			dst += 24;
+		}
+		pack_ssse3(src + i, dst, num_pixels - i);
+	}
+
+	__attribute__((target("avx2")))
+	static void unpack_avx2(const uint8_t* src, uint16_t* dst, uint_fast64_t num_pixels) {
+		const __m256i mask_12 = _mm256_set1_epi32(0xfff);
+		const __m256i shuffle = _mm256_setr_epi8(2,1,0,-1, 5,4,3,-1, 8,7,6,-1, 11,10,9,-1,
+		                                         2,1,0,-1, 5,4,3,-1, 8,7,6,-1, 11,10,9,-1);
+		uint_fast64_t i = 0;
+		for(; i + 16 + 3 <= num_pixels; i += 16) {
+			__m256i packed = _mm256_inserti128_si256(
+				_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)src)),
+				_mm_loadu_si128((const __m128i*)(src + 12)), 1);
+			__m256i y = _mm256_shuffle_epi8(packed, shuffle);
+			__m256i x = _mm256_or_si256(_mm256_srli_epi32(y, 12), _mm256_slli_epi32(_mm256_and_si256(y, mask_12), 16));
+			_mm256_storeu_si256((__m256i*)(dst + i), x);
+			src += 24;
+		}
+		unpack_ssse3(src, dst + i, num_pixels - i);
+	}
+
+#endif
+
+#ifdef RAW12_NEON
+
+	/**
+	 * NEON kernels : vld2/vst3 do the (de)interleaving of the pixel pairs
+	 * and the packed bytes, so no tail slack is needed.
+	 */
+	static void pack_neon(const uint16_t* src, uint8_t* dst, uint_fast64_t num_pixels) {
+		const uint16x8_t mask_12 = vdupq_n_u16(0xfff);
+		uint_fast64_t i = 0;
+		for(; i + 16 <= num_pixels; i += 16) {
+			uint16x8x2_t x = vld2q_u16(src + i);
+			uint16x8_t p0 = vandq_u16(x.val[0], mask_12);
+			uint16x8_t p1 = vandq_u16(x.val[1], mask_12);
+			uint8x8x3_t y;
+			y.val[0] = vmovn_u16(vshrq_n_u16(p0, 4));
+			y.val[1] = vmovn_u16(vorrq_u16(vshlq_n_u16(p0, 4), vshrq_n_u16(p1, 8)));
+			y.val[2] = vmovn_u16(p1);
+			vst3_u8(dst, y);
+			dst += 24;
+		}
+		pack_scalar(src + i, dst, num_pixels - i);
+	}
+
+	static void unpack_neon(const uint8_t* src, uint16_t* dst, uint_fast64_t num_pixels) {
+		const uint16x8_t mask_4 = vdupq_n_u16(0xf);
+		uint_fast64_t i = 0;
+		for(; i + 16 <= num_pixels; i += 16) {
+			uint8x8x3_t y = vld3_u8(src);
+			uint16x8_t b0 = vmovl_u8(y.val[0]);
+			uint16x8_t b1 = vmovl_u8(y.val[1]);
+			uint16x8_t b2 = vmovl_u8(y.val[2]);
+			uint16x8x2_t x;
+			x.val[0] = vorrq_u16(vshlq_n_u16(b0, 4), vshrq_n_u16(b1, 4));
+			x.val[1] = vorrq_u16(vshlq_n_u16(vandq_u16(b1, mask_4), 8), b2);
+			vst2q_u16(dst + i, x);
+			src += 24;
+		}
+		unpack_scalar(src, dst + i, num_pixels - i);
+	}
+
+#endif
+
+	typedef void (*pack_fn)(const uint16_t*, uint8_t*, uint_fast64_t);
+	typedef void (*unpack_fn)(const uint8_t*, uint16_t*, uint_fast64_t);
+
+	static RAW12_KERNEL best_kernel() {
+#ifdef RAW12_NEON
+		return RAW12_KERNEL_NEON;
+#endif
+#ifdef RAW12_X86
+		//needed since this runs before main()
+		__builtin_cpu_init();
+		if(__builtin_cpu_supports("avx2")) {
+			return RAW12_KERNEL_AVX2;
+		}
+		if(__builtin_cpu_supports("ssse3")) {
+			return RAW12_KERNEL_SSSE3;
+		}
+#endif
+		return RAW12_KERNEL_SCALAR;
+	}
+
+	static RAW12_KERNEL current_kernel = RAW12_KERNEL_SCALAR;
+	static pack_fn current_pack = pack_scalar;
+	static unpack_fn current_unpack = unpack_scalar;
+
+	//select the best kernel once at load time
+	static struct KernelSelector{
+		KernelSelector() {
+			set_kernel(best_kernel());
+		}
+	} kernel_selector;
+
+	bool is_kernel_supported(RAW12_KERNEL kernel) {
+		switch(kernel) {
+			case RAW12_KERNEL_SCALAR:
+				return true;
+#ifdef RAW12_X86
+			case RAW12_KERNEL_SSSE3:
+				return __builtin_cpu_supports("ssse3");
+			case RAW12_KERNEL_AVX2:
+				return __builtin_cpu_supports("avx2");
+#endif
+#ifdef RAW12_NEON
+			case RAW12_KERNEL_NEON:
+				return true;
+#endif
+			default:
+				return false;
+		}
+	}
+
+	bool set_kernel(RAW12_KERNEL kernel) {
+		if(!is_kernel_supported(kernel)) {
+			return false;
+		}
+		switch(kernel) {
+#ifdef RAW12_X86
+			case RAW12_KERNEL_SSSE3:
+				current_pack = pack_ssse3;
+				current_unpack = unpack_ssse3;
+			break;
+			case RAW12_KERNEL_AVX2:
+				current_pack = pack_avx2;
+				current_unpack = unpack_avx2;
+			break;
+#endif
+#ifdef RAW12_NEON
+			case RAW12_KERNEL_NEON:
+				current_pack = pack_neon;
+				current_unpack = unpack_neon;
+			break;
+#endif
+			default:
+				current_pack = pack_scalar;
+				current_unpack = unpack_scalar;
+			break;
+		}
+		current_kernel = kernel;
+		return true;
+	}
+
+	RAW12_KERNEL get_kernel() {
+		return current_kernel;
+	}
+
+	const char* get_kernel_name(RAW12_KERNEL kernel) {
+		switch(kernel) {
+			case RAW12_KERNEL_SCALAR:
+				return "scalar";
+			case RAW12_KERNEL_SSSE3:
+				return "ssse3";
+			case RAW12_KERNEL_AVX2:
+				return "avx2";
+			case RAW12_KERNEL_NEON:
+				return "neon";
+		}
+		return "unknown";
+	}
+
+	void pack(const uint16_t* src, uint8_t* dst, uint_fast64_t num_pixels) {
+		current_pack(src, dst, num_pixels);
+	}
+
+	void unpack(const uint8_t* src, uint16_t* dst, uint_fast64_t num_pixels) {
+		current_unpack(src, dst, num_pixels);
+	}
+
+}
+
+
+/**
+ * Class : Raw12Packer
+ * --------------------------------------------------------------
+ */
+Raw12Packer::Raw12Packer() : error_handler_("Raw12Packer") {
+	buffer_ = NULL;
+	buffer_size_ = 0;
+}
+
+bool Raw12Packer::initialize(uint_fast64_t max_pixels) {
+	if(NULL != buffer_) {
+		free(buffer_);
+		buffer_ = NULL;
+		buffer_size_ = 0;
+	}
+	//the slack absorbs the rounding of odd sized packets.
+	uint_fast64_t size = RAW12_PACKED_SIZE(max_pixels) + 64;
+	if(posix_memalign((void**) &buffer_, 64, size) != 0) {
+		buffer_ = NULL;
+		error_handler_.set_error("Memory error while allocating the raw12 buffer.");
+		return false;
+	}
+	buffer_size_ = size;
+	return true;
+}
+
+bool Raw12Packer::pack(const DataPacketsList& in, DataPacketsList& out) {
+
+	if(NULL == buffer_) {
+		error_handler_.set_error("You must initialize the packer first");
+		return false;
+	}
+
+	if(out.num_packets != in.num_packets) {
+		error_handler_.set_error("The output list must have the same number of packets as the input.");
+		return false;
+	}
+	uint_fast64_t used = 0;
+	for(uint_fast32_t i=0; i<in.num_packets; i++) {
+		const DataPacket* packet = in.packets + i;
+		if(packet->data_ptr_type != DataPacket::DATA_PTR_MEMORY_LOCATION) {
+			error_handler_.set_error("Only memory location packets can be packed.");
+			return false;
+		}
+		if((packet->data_size & 1) || (packet->data_offset & 1)) {
+			error_handler_.set_error("Packet size and offset must be multiple of the 16-bit container.");
+			return false;
+		}
+		uint_fast64_t num_pixels = packet->data_size / 2;
+		uint_fast64_t packed_size = RAW12_PACKED_SIZE(num_pixels);
+		if(used + packed_size > buffer_size_) {
+			error_handler_.set_error("The frame is bigger than the raw12 buffer.");
+			return false;
+		}
+		raw12::pack((const uint16_t*)((const char*)packet->data_ptr + packet->data_offset), buffer_ + used, num_pixels);
+		//point the packet to the packed data
+		out.packets[i].data_ptr = buffer_ + used;
+		out.packets[i].data_size = packed_size;
+		out.packets[i].data_offset = 0;
+		used += packed_size;
+	}
+	return true;
+}
+
+std::string Raw12Packer::get_error() {
+	std::string error = error_handler_.get_error();
+	error_handler_.clear_error();
+	return error;
+}
+
+bool Raw12Packer::is_error() {
+	return error_handler_.is_error();
+}
+
+Raw12Packer::~Raw12Packer() {
+	if(NULL != buffer_) {
+		free(buffer_);
+		buffer_ = NULL;
+	}
+}
@@ -0,0 +1,161 @@
+#include "../../includes/shm_consumer.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+ShmConsumer::ShmConsumer() : error_handler_("ShmConsumer") {
+	fd_ = -1;
+	header_ = NULL;
+	cursor_ = NULL;
+}
+
+bool ShmConsumer::open(const string& path) {
+	close();
+	fd_ = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+	if(fd_ == -1) {
+		error_handler_.set_error("Can't open the ring " + path + " : " + strerror(errno));
+		return false;
+	}
+	struct stat file_stat;
+	if(fstat(fd_, &file_stat) == -1 || uint64_t(file_stat.st_size) < sizeof(ShmRingHeader)) {
+		error_handler_.set_error("The file " + path + " is not a ring.");
+		close();
+		return false;
+	}
+	layout_.size = file_stat.st_size;
+	void* memory = mmap(NULL, layout_.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+	if(memory == MAP_FAILED) {
+		error_handler_.set_error(string("Can't map the ring : ") + strerror(errno));
+		close();
+		return false;
+	}
+	header_ = (ShmRingHeader*) memory;
+	//the size of the ring must match its header
+	ShmRingLayout layout;
+	if(header_->magic == SHM_RING_MAGIC && header_->version == SHM_RING_VERSION && header_->slots != 0) {
+		layout = shm_ring::layout(header_->slots, header_->slot_capacity);
+	}
+	if(layout.slots == 0 || layout.size != layout_.size ||
+	   layout.slot_stride != header_->slot_stride || layout.slots_offset != header_->slots_offset) {
+		error_handler_.set_error("The file " + path + " is not a ring of this version.");
+		close();
+		return false;
+	}
+	//take a free cursor, starting at the next frame
+	for(int i=0; i<SHM_RING_MAX_CONSUMERS && cursor_ == NULL; i++) {
+		uint32_t free_pid = 0;
+		if(header_->cursors[i].pid.compare_exchange_strong(free_pid, getpid())) {
+			cursor_ = header_->cursors + i;
+		}
+	}
+	if(cursor_ == NULL) {
+		error_handler_.set_error("The ring has no free cursor.");
+		close();
+		return false;
+	}
+	layout_ = layout;
+	cursor_->lost_frames.store(0);
+	cursor_->waiting.store(0);
+	cursor_->next_frame.store(header_->last_frame.load(std::memory_order_acquire) + 1);
+	return true;
+}
+
+void ShmConsumer::close() {
+	if(cursor_ != NULL) {
+		cursor_->pid.store(0);
+		cursor_ = NULL;
+	}
+	if(header_ != NULL) {
+		munmap(header_, layout_.size);
+		header_ = NULL;
+	}
+	if(fd_ != -1) {
+		::close(fd_);
+		fd_ = -1;
+	}
+}
+
+bool ShmConsumer::wait_frame(ShmFrame* frame, int timeout_ms) {
+	if(cursor_ == NULL) {
+		error_handler_.set_error("You must open the consumer first");
+		return false;
+	}
+	bool waited = false;
+	while(true) {
+		uint64_t last_frame = header_->last_frame.load(std::memory_order_acquire);
+		uint64_t next_frame = cursor_->next_frame.load(std::memory_order_relaxed);
+		if(next_frame > last_frame) {
+			if(header_->closed.load() != 0 || waited) {
+				return false;
+			}
+			shm_ring::wait(header_, cursor_, last_frame, timeout_ms);
+			//a single wait, the timeout is not restarted by a spurious wake
+			waited = timeout_ms >= 0;
+			continue;
+		}
+		//skip to the oldest frame kept
+		if(last_frame - next_frame >= layout_.slots) {
+			cursor_->lost_frames.fetch_add(last_frame - layout_.slots + 1 - next_frame, std::memory_order_relaxed);
+			next_frame = last_frame - layout_.slots + 1;
+			cursor_->next_frame.store(next_frame, std::memory_order_relaxed);
+		}
+		ShmSlotHeader* slot = shm_ring::slot(header_, layout_, next_frame);
+		if(slot->sequence.load(std::memory_order_acquire) != next_frame) {
+			//overwritten since last_frame was read
+			cursor_->lost_frames.fetch_add(1, std::memory_order_relaxed);
+			cursor_->next_frame.store(next_frame + 1, std::memory_order_relaxed);
+			continue;
+		}
+		frame->sequence = next_frame;
+		frame->timestamp_ns = slot->timestamp_ns;
+		frame->data = shm_ring::slot_data(slot);
+		frame->size = slot->frame_size;
+		frame->num_packets = slot->num_packets;
+		frame->packet_sizes = slot->packet_sizes;
+		return true;
+	}
+}
+
+bool ShmConsumer::done_frame(const ShmFrame& frame) {
+	if(cursor_ == NULL) {
+		error_handler_.set_error("You must open the consumer first");
+		return false;
+	}
+	//the reads of the frame happen before the check of its sequence
+	std::atomic_thread_fence(std::memory_order_acquire);
+	bool intact = shm_ring::slot(header_, layout_, frame.sequence)->sequence.load(std::memory_order_relaxed) == frame.sequence;
+	if(!intact) {
+		cursor_->lost_frames.fetch_add(1, std::memory_order_relaxed);
+	}
+	cursor_->next_frame.store(frame.sequence + 1, std::memory_order_release);
+	return intact;
+}
+
+bool ShmConsumer::is_closed() {
+	return header_ != NULL && header_->closed.load() != 0 &&
+		cursor_->next_frame.load(std::memory_order_relaxed) > header_->last_frame.load(std::memory_order_acquire);
+}
+
+uint64_t ShmConsumer::get_lost_frames() {
+	return cursor_ != NULL ? cursor_->lost_frames.load(std::memory_order_relaxed) : 0;
+}
+
+string ShmConsumer::get_error() {
+	string error = error_handler_.get_error();
+	error_handler_.clear_error();
+	return error;
+}
+
+bool ShmConsumer::is_error() {
+	return error_handler_.is_error();
+}
+
+ShmConsumer::~ShmConsumer() {
+	close();
+}
@@ -0,0 +1,73 @@
+#include "../../includes/shm_ring.h"
+
+#include <time.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+//the first bytes of a slot, the frame starts on a cache line
+static const uint64_t slot_header_size = (sizeof(ShmSlotHeader) + 63) / 64 * 64;
+
+//not FUTEX_PRIVATE_FLAG, the futex is shared with the other processes
+static void futex_wake(std::atomic<uint32_t>* futex) {
+	syscall(SYS_futex, (uint32_t*) futex, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+static void futex_wait(std::atomic<uint32_t>* futex, uint32_t value, const timespec* timeout) {
+	syscall(SYS_futex, (uint32_t*) futex, FUTEX_WAIT, value, timeout, NULL, 0);
+}
+
+namespace shm_ring{
+
+	ShmRingLayout layout(uint32_t slots, uint32_t slot_capacity) {
+		uint64_t page_size = sysconf(_SC_PAGESIZE);
+		ShmRingLayout layout;
+		layout.slots = slots;
+		layout.slot_capacity = slot_capacity;
+		//page aligned slots, a consumer may map a frame on its own
+		layout.slot_stride = (slot_header_size + slot_capacity + page_size - 1) / page_size * page_size;
+		layout.slots_offset = (sizeof(ShmRingHeader) + page_size - 1) / page_size * page_size;
+		layout.size = layout.slots_offset + layout.slot_stride * slots;
+		return layout;
+	}
+
+	ShmSlotHeader* slot(ShmRingHeader* header, const ShmRingLayout& layout, uint64_t sequence) {
+		return (ShmSlotHeader*) ((char*) header + layout.slots_offset + layout.slot_stride * ((sequence - 1) % layout.slots));
+	}
+
+	char* slot_data(ShmSlotHeader* slot) {
+		return (char*) slot + slot_header_size;
+	}
+
+	void publish(ShmRingHeader* header, uint64_t sequence) {
+		header->last_frame.store(sequence, std::memory_order_release);
+		header->futex.fetch_add(1);
+		for(int i=0; i<SHM_RING_MAX_CONSUMERS; i++) {
+			if(header->cursors[i].waiting.load() != 0) {
+				futex_wake(&header->futex);
+				return;
+			}
+		}
+	}
+
+	void close(ShmRingHeader* header) {
+		header->closed.store(1);
+		header->futex.fetch_add(1);
+		futex_wake(&header->futex);
+	}
+
+	void wait(ShmRingHeader* header, ShmConsumerCursor* cursor, uint64_t last_frame, int timeout_ms) {
+		timespec timeout;
+		timeout.tv_sec = timeout_ms / 1000;
+		timeout.tv_nsec = (timeout_ms % 1000) * 1000000L;
+		//marked before reading the futex, so the sender sees the waiter if
+		//it publishes after the check
+		cursor->waiting.store(1);
+		uint32_t value = header->futex.load();
+		if(header->last_frame.load(std::memory_order_acquire) == last_frame && header->closed.load() == 0) {
+			futex_wait(&header->futex, value, timeout_ms < 0 ? NULL : &timeout);
+		}
+		cursor->waiting.store(0);
+	}
+}
@@ -0,0 +1,72 @@
+#include "../../includes/socket_utils.h"
+
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <linux/sockios.h>
+#include <linux/tcp.h>
+
+namespace socket_utils{
+
+	bool get_tcp_link_state(int sock_fd, SenderLinkState* state) {
+
+		if(sock_fd == -1) {
+			return false;
+		}
+
+		int queued = 0, unsent = 0;
+		if(ioctl(sock_fd, SIOCOUTQ, &queued) == -1 || ioctl(sock_fd, SIOCOUTQNSD, &unsent) == -1) {
+			return false;
+		}
+
+		//the kernel fills as much as it knows of tcp_info, the rest stays 0
+		struct tcp_info info = {};
+		socklen_t info_size = sizeof(info);
+		if(getsockopt(sock_fd, IPPROTO_TCP, TCP_INFO, &info, &info_size) == -1) {
+			return false;
+		}
+
+		state->queued_bytes = queued;
+		state->unsent_bytes = unsent;
+		state->rtt_us = info.tcpi_rtt;
+		state->cwnd_bytes = uint_fast32_t(info.tcpi_snd_cwnd) * info.tcpi_snd_mss;
+		state->delivery_rate = info.tcpi_delivery_rate;
+		state->delivery_rate_app_limited = info.tcpi_delivery_rate_app_limited;
+		return true;
+	}
+
+	int tcp_send_buffer_size(uint_fast32_t frame_bytes, uint_fast16_t frequency, uint_fast32_t rtt_us) {
+		uint_fast64_t bdp = uint_fast64_t(frame_bytes) * frequency * rtt_us / 1000000;
+		uint_fast64_t size = bdp + 2 * uint_fast64_t(frame_bytes);
+		if(size < TCP_SENDER_MIN_SEND_BUFFER) {
+			size = TCP_SENDER_MIN_SEND_BUFFER;
+		}
+		if(size > TCP_SENDER_MAX_SEND_BUFFER) {
+			size = TCP_SENDER_MAX_SEND_BUFFER;
+		}
+		return int(size);
+	}
+
+	bool accept_client(int server_sock_fd, int wake_fd, int timeout_ms, int* client_fd) {
+		struct pollfd pfd[2];
+		pfd[0].fd = server_sock_fd;
+		pfd[0].events = POLLIN;
+		pfd[0].revents = 0;
+		//a negative fd is ignored by poll(3)
+		pfd[1].fd = wake_fd;
+		pfd[1].events = POLLIN;
+		pfd[1].revents = 0;
+		if(poll(pfd, 2, timeout_ms) < 1 || (pfd[1].revents & POLLIN) || (pfd[0].revents & POLLIN) == 0) {
+			return false;
+		}
+		//the client may have left since the poll
+		int fd = accept(server_sock_fd, NULL, NULL);
+		if(fd == -1) {
+			return false;
+		}
+		*client_fd = fd;
+		return true;
+	}
+
+}
@@ -0,0 +1,79 @@
+#include "../../includes/thread_placement.h"
+
+#include <unistd.h>
+#include <sys/sysinfo.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+
+namespace thread_placement{
+
+	bool is_valid(const ThreadPlacement& placement) {
+		if(CPU_COUNT(&placement.cpus) == 0) {
+			return false;
+		}
+		return placement.priority >= sched_get_priority_min(SCHED_FIFO) &&
+		       placement.priority <= sched_get_priority_max(SCHED_FIFO);
+	}
+
+	bool set_affinity(const ThreadPlacement& placement) {
+		return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &placement.cpus) == 0;
+	}
+
+	bool set_memory_node(const ThreadPlacement& placement) {
+		if(placement.numa_node < 0) {
+			return true;
+		}
+		const unsigned long bits = 8 * sizeof(unsigned long);
+		if(placement.numa_node >= int(bits)) {
+			return false;
+		}
+		//the mask is a single word, the kernel reads maxnode - 1 bits of it
+		unsigned long node_mask = 1UL << placement.numa_node;
+		return syscall(SYS_set_mempolicy, MPOL_PREFERRED, &node_mask, bits + 1) == 0;
+	}
+
+	ThreadPlacement other_cores(const ThreadPlacement& placement, int priority) {
+		ThreadPlacement other(CPU_CORE_AFFINITY, priority);
+		other.clear_cpus();
+		int cpus = get_nprocs();
+		for(int cpu=0; cpu<cpus && cpu<CPU_SETSIZE; cpu++) {
+			if(!CPU_ISSET(cpu, &placement.cpus)) {
+				other.add_cpu(cpu);
+			}
+		}
+		if(CPU_COUNT(&other.cpus) == 0) {
+			other.cpus = placement.cpus;
+		}
+		return other;
+	}
+
+	bool make_real_time(const ThreadPlacement& placement, Error* error_handler) {
+		// Lock memory
+		if(mlockall(MCL_CURRENT|MCL_FUTURE) == -1) {
+			error_handler->set_error("mlockall failed");
+			return false;
+		}
+		//set scheduler to FIFO and with the placement priority
+		struct sched_param param;
+		param.sched_priority = placement.priority;
+		if (sched_setscheduler(0, SCHED_FIFO, &param) != 0) {
+			//report error
+			error_handler->set_error("Can't set the process scheduler to FIFO / set priority to " + std::to_string(placement.priority));
+			return false;
+		}
+		//set process affinity to the placement cores
+		if(!set_affinity(placement)) {
+			//report error
+			error_handler->set_error("Can't stick the process to the placement cores");
+			return false;
+		}
+		//prefer the placement memory node
+		if(!set_memory_node(placement)) {
+			//report error
+			error_handler->set_error("Can't set the preferred memory node to " + std::to_string(placement.numa_node));
+			return false;
+		}
+		return true;
+	}
+
+}
@@ -0,0 +1,114 @@
+#include "../../includes/thread_usage.h"
+#include "../../includes/trace_events.h"
+
+#include <time.h>
+#include <sys/resource.h>
+
+ThreadUsage::ThreadUsage() {
+	enabled_ = false;
+	started_ = false;
+	start_cpu_ns_ = 0;
+	start_voluntary_ = 0;
+	start_involuntary_ = 0;
+	start_minor_ = 0;
+	start_major_ = 0;
+	reset();
+}
+
+void ThreadUsage::set_enabled(bool enabled) {
+	enabled_ = enabled;
+	started_ = false;
+}
+
+bool ThreadUsage::is_enabled() {
+	return enabled_;
+}
+
+static uint_fast64_t thread_cpu_ns() {
+	timespec cpu_time;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_time);
+	return uint_fast64_t(cpu_time.tv_sec) * 1000000000 + cpu_time.tv_nsec;
+}
+
+void ThreadUsage::begin() {
+	if(!enabled_.load(std::memory_order_relaxed)) {
+		return;
+	}
+	rusage usage;
+	if(getrusage(RUSAGE_THREAD, &usage) != 0) {
+		started_ = false;
+		return;
+	}
+	start_voluntary_ = usage.ru_nvcsw;
+	start_involuntary_ = usage.ru_nivcsw;
+	start_minor_ = usage.ru_minflt;
+	start_major_ = usage.ru_majflt;
+	start_cpu_ns_ = thread_cpu_ns();
+	started_ = true;
+}
+
+uint_fast8_t ThreadUsage::end(int_fast64_t value) {
+	if(!started_ || !enabled_.load(std::memory_order_relaxed)) {
+		return 0;
+	}
+	started_ = false;
+	uint_fast64_t cpu_ns = thread_cpu_ns() - start_cpu_ns_;
+	rusage usage;
+	if(getrusage(RUSAGE_THREAD, &usage) != 0) {
+		return 0;
+	}
+	uint_fast64_t involuntary = usage.ru_nivcsw - start_involuntary_;
+	uint_fast64_t faults = (usage.ru_minflt - start_minor_) + (usage.ru_majflt - start_major_);
+
+	intervals_.fetch_add(1, std::memory_order_relaxed);
+	cpu_ns_.fetch_add(cpu_ns, std::memory_order_relaxed);
+	if(cpu_ns > max_interval_cpu_ns_.load(std::memory_order_relaxed)) {
+		max_interval_cpu_ns_.store(cpu_ns, std::memory_order_relaxed);
+	}
+	voluntary_switches_.fetch_add(usage.ru_nvcsw - start_voluntary_, std::memory_order_relaxed);
+	involuntary_switches_.fetch_add(involuntary, std::memory_order_relaxed);
+	minor_faults_.fetch_add(usage.ru_minflt - start_minor_, std::memory_order_relaxed);
+	major_faults_.fetch_add(usage.ru_majflt - start_major_, std::memory_order_relaxed);
+
+	uint_fast8_t flags = 0;
+	if(involuntary != 0) {
+		flags |= THREAD_USAGE_PREEMPTED;
+		preempted_intervals_.fetch_add(1, std::memory_order_relaxed);
+		trace_events::instant("preempted", involuntary);
+	}
+	if(faults != 0) {
+		flags |= THREAD_USAGE_FAULTED;
+		faulted_intervals_.fetch_add(1, std::memory_order_relaxed);
+		trace_events::instant("page faults", faults);
+	}
+	if(flags != 0) {
+		last_flagged_.store(value, std::memory_order_relaxed);
+	}
+	return flags;
+}
+
+void ThreadUsage::get_stats(ThreadUsageStats* stats) {
+	stats->intervals = intervals_.load(std::memory_order_relaxed);
+	stats->cpu_ns = cpu_ns_.load(std::memory_order_relaxed);
+	stats->max_interval_cpu_ns = max_interval_cpu_ns_.load(std::memory_order_relaxed);
+	stats->voluntary_switches = voluntary_switches_.load(std::memory_order_relaxed);
+	stats->involuntary_switches = involuntary_switches_.load(std::memory_order_relaxed);
+	stats->minor_faults = minor_faults_.load(std::memory_order_relaxed);
+	stats->major_faults = major_faults_.load(std::memory_order_relaxed);
+	stats->preempted_intervals = preempted_intervals_.load(std::memory_order_relaxed);
+	stats->faulted_intervals = faulted_intervals_.load(std::memory_order_relaxed);
+	stats->last_flagged = last_flagged_.load(std::memory_order_relaxed);
+}
+
+void ThreadUsage::reset() {
+	intervals_ = 0;
+	cpu_ns_ = 0;
+	max_interval_cpu_ns_ = 0;
+	voluntary_switches_ = 0;
+	involuntary_switches_ = 0;
+	minor_faults_ = 0;
+	major_faults_ = 0;
+	preempted_intervals_ = 0;
+	faulted_intervals_ = 0;
+	last_flagged_ = -1;
+}
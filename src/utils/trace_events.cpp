@@ -0,0 +1,186 @@
+#include "../../includes/trace_events.h"
+#include "../../includes/mutex_raii.h"
+
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <string>
+#include <vector>
+
+//the events of one thread, head counts all the events written
+struct TraceRing{
+	TraceEvent* events;
+	std::atomic<uint_fast64_t> head;
+	//a ring of an ended thread is taken by the next new thread
+	std::atomic<bool> in_use;
+};
+
+//the ring of the calling thread, given back when the thread ends
+struct ThreadRing{
+	TraceRing* ring = NULL;
+	uint32_t tid = 0;
+	~ThreadRing() {
+		if(ring != NULL) {
+			ring->in_use = false;
+		}
+	}
+};
+
+static std::atomic<bool> enabled_(false);
+static pthread_mutex_t rings_mutex_ = PTHREAD_MUTEX_INITIALIZER;
+static std::vector<TraceRing*> rings_;
+static std::map<uint32_t, std::string> thread_names_;
+static thread_local ThreadRing thread_ring_;
+
+namespace trace_events{
+
+	static TraceRing* get_ring() {
+		if(thread_ring_.ring != NULL) {
+			return thread_ring_.ring;
+		}
+		MutexRAII prot_lock(rings_mutex_);
+		prot_lock.lock_block();
+		TraceRing* ring = NULL;
+		for(TraceRing* free_ring : rings_) {
+			if(!free_ring->in_use) {
+				ring = free_ring;
+				break;
+			}
+		}
+		if(ring == NULL) {
+			ring = new TraceRing();
+			ring->events = new TraceEvent[TRACE_EVENTS_PER_THREAD];
+			ring->head = 0;
+			rings_.push_back(ring);
+		}
+		ring->in_use = true;
+		thread_ring_.ring = ring;
+		thread_ring_.tid = syscall(SYS_gettid);
+		return ring;
+	}
+
+	static void record(char phase, const char* name, int_fast64_t value) {
+		if(!enabled_.load(std::memory_order_relaxed)) {
+			return;
+		}
+		TraceRing* ring = get_ring();
+		timespec current_time;
+		clock_gettime(CLOCK_MONOTONIC, &current_time);
+		uint_fast64_t head = ring->head.load(std::memory_order_relaxed);
+		TraceEvent& event = ring->events[head % TRACE_EVENTS_PER_THREAD];
+		event.phase = phase;
+		event.tid = thread_ring_.tid;
+		event.time_ns = uint_fast64_t(current_time.tv_sec) * 1000000000 + current_time.tv_nsec;
+		event.name = name;
+		event.value = value;
+		ring->head.store(head + 1, std::memory_order_release);
+	}
+
+	void set_enabled(bool enabled) {
+		enabled_ = enabled;
+	}
+
+	bool is_enabled() {
+		return enabled_;
+	}
+
+	void set_thread_name(const char* name) {
+		if(enabled_) {
+			get_ring();
+		}
+		MutexRAII prot_lock(rings_mutex_);
+		prot_lock.lock_block();
+		thread_names_[syscall(SYS_gettid)] = name;
+	}
+
+	void begin(const char* name, int_fast64_t value) {
+		record('B', name, value);
+	}
+
+	void end(const char* name) {
+		record('E', name, 0);
+	}
+
+	void instant(const char* name, int_fast64_t value) {
+		record('i', name, value);
+	}
+
+	bool dump(const char* path, uint_fast64_t last_ns) {
+		//copy the events, the threads keep recording
+		std::vector<TraceEvent> events;
+		std::map<uint32_t, std::string> thread_names;
+		{
+			MutexRAII prot_lock(rings_mutex_);
+			prot_lock.lock_block();
+			for(TraceRing* ring : rings_) {
+				uint_fast64_t head = ring->head.load(std::memory_order_acquire);
+				uint_fast64_t first = head > TRACE_EVENTS_PER_THREAD ? head - TRACE_EVENTS_PER_THREAD : 0;
+				size_t start = events.size();
+				for(uint_fast64_t i=first; i<head; i++) {
+					events.push_back(ring->events[i % TRACE_EVENTS_PER_THREAD]);
+				}
+				//drop the events overwritten while copying
+				uint_fast64_t new_head = ring->head.load(std::memory_order_acquire);
+				if(new_head > TRACE_EVENTS_PER_THREAD && new_head - TRACE_EVENTS_PER_THREAD > first) {
+					uint_fast64_t overwritten = std::min(new_head - TRACE_EVENTS_PER_THREAD - first, head - first);
+					events.erase(events.begin() + start, events.begin() + start + overwritten);
+				}
+			}
+			thread_names = thread_names_;
+		}
+
+		uint_fast64_t first_ns = 0;
+		if(last_ns != 0 && !events.empty()) {
+			uint_fast64_t newest_ns = 0;
+			for(const TraceEvent& event : events) {
+				newest_ns = std::max(newest_ns, event.time_ns);
+			}
+			first_ns = newest_ns > last_ns ? newest_ns - last_ns : 0;
+		}
+
+		FILE* out = fopen(path, "w");
+		if(out == NULL) {
+			return false;
+		}
+		int pid = getpid();
+		fprintf(out, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+		bool first_event = true;
+		for(const auto& thread_name : thread_names) {
+			fprintf(out, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": %d, \"tid\": %u, \"args\": {\"name\": \"%s\"}}",
+				first_event ? "" : ",\n", pid, (unsigned) thread_name.first, thread_name.second.c_str());
+			first_event = false;
+		}
+		for(const TraceEvent& event : events) {
+			if(event.time_ns < first_ns) {
+				continue;
+			}
+			fprintf(out, "%s{\"name\": \"%s\", \"ph\": \"%c\", \"ts\": %lu.%03lu, \"pid\": %d, \"tid\": %u",
+				first_event ? "" : ",\n", event.name, event.phase, (unsigned long) (event.time_ns / 1000),
+				(unsigned long) (event.time_ns % 1000), pid, (unsigned) event.tid);
+			if(event.phase == 'i') {
+				fprintf(out, ", \"s\": \"t\"");
+			}
+			if(event.phase != 'E') {
+				fprintf(out, ", \"args\": {\"value\": %ld}", (long) event.value);
+			}
+			fprintf(out, "}");
+			first_event = false;
+		}
+		fprintf(out, "\n]}\n");
+		return fclose(out) == 0;
+	}
+
+	void clear() {
+		MutexRAII prot_lock(rings_mutex_);
+		prot_lock.lock_block();
+		for(TraceRing* ring : rings_) {
+			ring->head = 0;
+		}
+	}
+
+}
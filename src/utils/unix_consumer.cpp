@@ -0,0 +1,161 @@
+#include "../../includes/unix_consumer.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+using namespace std;
+
+UnixConsumer::UnixConsumer() : error_handler_("UnixConsumer") {
+	sock_fd_ = -1;
+	last_sequence_ = 0;
+	lost_frames_ = 0;
+	closed_ = false;
+}
+
+bool UnixConsumer::open(const string& path) {
+	close();
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	if(path.size() >= sizeof(address.sun_path)) {
+		error_handler_.set_error("The socket path " + path + " is too long.");
+		return false;
+	}
+	strcpy(address.sun_path, path.c_str());
+	sock_fd_ = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if(sock_fd_ == -1 || connect(sock_fd_, (sockaddr*) &address, sizeof(address)) == -1) {
+		error_handler_.set_error("Can't connect to " + path + " : " + strerror(errno));
+		close();
+		return false;
+	}
+	last_sequence_ = 0;
+	lost_frames_ = 0;
+	closed_ = false;
+	return true;
+}
+
+void UnixConsumer::close() {
+	if(sock_fd_ != -1) {
+		::close(sock_fd_);
+		sock_fd_ = -1;
+	}
+}
+
+bool UnixConsumer::receive_frame(UnixFrame* frame, int timeout_ms) {
+	if(sock_fd_ == -1) {
+		error_handler_.set_error("You must open the consumer first");
+		return false;
+	}
+	if(closed_) {
+		return false;
+	}
+	pollfd pfd = {sock_fd_, POLLIN, 0};
+	int ready = poll(&pfd, 1, timeout_ms);
+	if(ready == 0 || (ready == -1 && errno == EINTR)) {
+		return false;
+	}
+	//the message and the memfd passed with it
+	UnixFrameMessage message;
+	iovec iov = {&message, sizeof(message)};
+	char control[CMSG_SPACE(sizeof(int))];
+	msghdr header = {};
+	header.msg_iov = &iov;
+	header.msg_iovlen = 1;
+	header.msg_control = control;
+	header.msg_controllen = sizeof(control);
+	ssize_t r = recvmsg(sock_fd_, &header, MSG_CMSG_CLOEXEC);
+	if(r == 0) {
+		closed_ = true;
+		return false;
+	}
+	if(r < 0) {
+		error_handler_.set_error(string("Can't receive the frame : ") + strerror(errno));
+		return false;
+	}
+	int fd = -1;
+	cmsghdr* cmsg = CMSG_FIRSTHDR(&header);
+	if(cmsg != NULL && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+		memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+	}
+	if(fd == -1 || r != sizeof(message) || (header.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) ||
+	   message.magic != UNIX_FRAME_MAGIC || message.version != UNIX_FRAME_VERSION ||
+	   message.num_packets > UNIX_FRAME_MAX_PACKETS) {
+		if(fd != -1) {
+			::close(fd);
+		}
+		error_handler_.set_error("The sender passed a frame of another version.");
+		return false;
+	}
+	//the frame must be sealed and hold the bytes given in the message, a
+	//descriptor which is not a memfd has no seals (-1)
+	struct stat file_stat;
+	int seals = fcntl(fd, F_GET_SEALS);
+	if(seals == -1 || (seals & UNIX_FRAME_SEALS) != UNIX_FRAME_SEALS || fstat(fd, &file_stat) == -1 ||
+	   uint64_t(file_stat.st_size) < uint64_t(message.data_offset) + message.frame_size) {
+		::close(fd);
+		error_handler_.set_error("The memfd of the frame is not sealed or too small.");
+		return false;
+	}
+	void* mapping = NULL;
+	if(file_stat.st_size != 0) {
+		mapping = mmap(NULL, file_stat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		if(mapping == MAP_FAILED) {
+			::close(fd);
+			error_handler_.set_error(string("Can't map the frame : ") + strerror(errno));
+			return false;
+		}
+	}
+	if(last_sequence_ != 0 && message.sequence > last_sequence_ + 1) {
+		lost_frames_ += message.sequence - last_sequence_ - 1;
+	}
+	last_sequence_ = message.sequence;
+	frame->sequence = message.sequence;
+	frame->timestamp_ns = message.timestamp_ns;
+	frame->data = (const char*) mapping + message.data_offset;
+	frame->size = message.frame_size;
+	frame->num_packets = message.num_packets;
+	memcpy(frame->packet_sizes, message.packet_sizes, sizeof(uint32_t) * message.num_packets);
+	frame->fd = fd;
+	frame->mapping = mapping;
+	frame->mapping_size = file_stat.st_size;
+	return true;
+}
+
+void UnixConsumer::release_frame(UnixFrame* frame) {
+	if(frame->mapping != NULL) {
+		munmap(frame->mapping, frame->mapping_size);
+		frame->mapping = NULL;
+	}
+	if(frame->fd != -1) {
+		::close(frame->fd);
+		frame->fd = -1;
+	}
+	frame->data = NULL;
+}
+
+bool UnixConsumer::is_closed() {
+	return closed_;
+}
+
+uint64_t UnixConsumer::get_lost_frames() {
+	return lost_frames_;
+}
+
+string UnixConsumer::get_error() {
+	string error = error_handler_.get_error();
+	error_handler_.clear_error();
+	return error;
+}
+
+bool UnixConsumer::is_error() {
+	return error_handler_.is_error();
+}
+
+UnixConsumer::~UnixConsumer() {
+	close();
+}